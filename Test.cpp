@@ -1,232 +1,554 @@
-#include "zip/LFHeader.hpp"
-#include "zip/EOCDRec.hpp"
-#include "zip/CDFHeader.hpp"
+#include "zip/Archive.hpp"
 #include "zip/Inflate.hpp"
-#include "utils/ForEach.hpp"
-#include "utils/ForEachFindEnd.hpp"
-#include "utils/MemoryMappedFile.hpp"
-
+#include "zip/Stored.hpp"
+#include "zip/Extract.hpp"
+#include "zip/EntryReader.hpp"
+#include "zip/Codec.hpp"
+#include "zip/GlobalIndex.hpp"
+#include "zip/SortedNames.hpp"
+#include "zip/Salvage.hpp"
+#include "zip/StreamReader.hpp"
+#include "utils/AsPlainStringView.hpp"
+
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
+#include <iomanip>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 
-namespace zip
-{
-
-bool
-Validate(const EOCDRec& r, size_t zipFileSize)
+int
+main(int argc, const char* argv[])
 {
-    return AsBytes<uint32_t, unsigned char>(r.sig) == EOCDRec::SIG
-        && r.thisDiskNum == 0u
-        && r.startDiskNum == 0u
-        && r.totalEntries == r.totalEntriesThisDisk
-        && r.commentLen == r.comment.size()
-        && r.offsetOfCentralDir < zipFileSize
-        && r.sizeOfCentralDir <= zipFileSize - r.offsetOfCentralDir
-        && r.sizeOfCentralDir <= r.totalEntries * CDFHeader::MaxBytes()
-        && r.sizeOfCentralDir >= r.totalEntries * CDFHeader::MinBytes();
-}
+    zip::CodecRegistry& codecs = zip::CodecRegistry::Default();
+
+    bool calibrate = false;
+    bool testOnly  = false;
+    bool pull      = false;
+    bool salvage   = false;
+    bool list      = false;
+    size_t head    = 0u;
+    const char* glob       = nullptr;
+    const char* writeIndex = nullptr;
+    const char* findName   = nullptr;
+
+    int argi = 1;
+    for (; argi < argc && argv[argi][0] == '-' && argv[argi][1] != '\0'; ++argi)
+    {
+        std::string_view opt = argv[argi];
+        if (opt == "-b" && argi + 1 < argc)
+        {
+            std::string_view name = argv[++argi];
+            if (name == "auto")
+            {
+                calibrate = true;
+            }
+            else if (!codecs.Prefer(name))
+            {
+                argi = argc;
+                break;
+            }
+        }
+        else if (opt == "-t")
+        {
+            testOnly = true;
+        }
+        else if (opt == "-p")
+        {
+            pull = true;
+        }
+        else if (opt == "-s")
+        {
+            salvage = true;
+        }
+        else if (opt == "-l")
+        {
+            list = true;
+        }
+        else if (opt == "-H" && argi + 1 < argc)
+        {
+            head = std::strtoull(argv[++argi], nullptr, 10);
+        }
+        else if (opt == "-g" && argi + 1 < argc)
+        {
+            glob = argv[++argi];
+        }
+        else if (opt == "-W" && argi + 1 < argc)
+        {
+            writeIndex = argv[++argi];
+        }
+        else if (opt == "-F" && argi + 1 < argc)
+        {
+            findName = argv[++argi];
+        }
+        else
+        {
+            argi = argc;
+            break;
+        }
+    }
 
-bool
-Validate(const CDFHeader& r, const EOCDRec& eocd, size_t zipFileSize)
-{
-    return AsBytes<uint32_t, unsigned char>(r.sig) == CDFHeader::SIG
-        && r.diskNum == 0u
-        && r.nameLen == r.name.size()
-        && r.exFieldLen == r.exField.size()
-        && r.commentLen == r.comment.size()
-        && r.offsetOfLFHeader < zipFileSize
-        && r.offsetOfLFHeader < eocd.offsetOfCentralDir
-        && eocd.offsetOfCentralDir - r.offsetOfLFHeader >= LFHeader::MinBytes();
-}
+    if (argc - argi != 1 && !(writeIndex && argc - argi >= 1))
+    {
+        std::cerr << "Usage: " << argv[0] << " [-l] [-t] [-p] [-s] [-H bytes] [-g glob] [-b zlib|native|parallel|auto] <zip-file | ->\n";
+        std::cerr << "       " << argv[0] << " -W <index-file> <zip-file>...\n";
+        std::cerr << "       " << argv[0] << " -F <name> <index-file>\n";
+        return -1;
+    }
 
-bool
-Validate(const LFHeader& r, const CDFHeader&, const EOCDRec& eocd, size_t zipFileSize)
-{
-    return AsBytes<uint32_t, unsigned char>(r.sig) == LFHeader::SIG
-        && r.nameLen == r.name.size()
-        && r.exFieldLen == r.exField.size()
-        && r.compressedSz < zipFileSize
-        && r.compressedSz < eocd.offsetOfCentralDir;
-}
+    const char* fname = argv[argi];
 
-struct CDir
-{
-    EOCDRec eocd;
-};
-
-}
+    //
+    // -W INDEX: one index over all the zip files given, to ask which of
+    // them have an entry with -F
+    //
+    if (writeIndex != nullptr)
+    {
+        const std::vector<std::string> paths(argv + argi, argv + argc);
 
-std::vector<zip::CDir>
-GetPotentialCDir(utils::RdBuf_t zipBuf)
-{
-    std::vector<zip::CDir> results;
+        zip::Err err = zip::GlobalIndex::Write(paths, writeIndex);
+        if (err != zip::Err::None)
+        {
+            std::cerr << writeIndex << ": " << err << "\n";
+            return -1;
+        }
 
-    utils::RdBuf_t eocdScanBuf = zipBuf.last(
-        std::min(zip::EOCDRec::MaxBytes(), zipBuf.size())
-    );
+        return 0;
+    }
 
-    utils::ForEachFindEnd(
-        eocdScanBuf,
-        zip::EOCDRec::SIG,
-        [&results, zipBuf](utils::RdBuf_t match)
+    //
+    // -F NAME: the archives in the index that have an entry called NAME,
+    // in the order they were given to -W
+    //
+    if (findName != nullptr)
+    {
+        auto index = zip::GlobalIndex::Open(fname);
+        if (index.HasError())
         {
-            auto eocd = zip::EOCDRec::read(match);
-            if (eocd && Validate(*eocd, zipBuf.size()))
+            std::cerr << fname << ": " << index.Error() << "\n";
+            return -1;
+        }
+
+        size_t found = 0u;
+        index.Value().ForEach(
+            findName,
+            [&](const zip::GlobalIndex::Hit& Hit)
             {
-                results.push_back({ *eocd });
+                std::cout << index.Value().Path(Hit.Archive) << "\n";
+                found += 1u;
+                return true;
             }
+        );
 
-            return true;
-        }
-    );
-
-    return results;
-}
+        return found > 0u ? 0 : -1;
+    }
 
-template<class FuncT>
-bool
-ForEachEntry(const zip::CDir& cdir, utils::RdBuf_t zipBuf, FuncT Func)
-{
-    const zip::EOCDRec& eocd = cdir.eocd;
+    auto toStdout = [](utils::RdBuf_t Chunk)
+    {
+        std::cout.write(reinterpret_cast<const char*>(Chunk.data()), Chunk.size());
+    };
 
     //
-    // std::cerr << "eocd: " << eocd << "\n";
+    // Decodes an entry to stdout with codec. The crc and size are taken as
+    // the output goes by, and checked against the ones in Hdr - a central
+    // directory header, or a salvaged local one.
     //
-
-    utils::RdBuf_t cdBuf = zipBuf.subspan(
-        eocd.offsetOfCentralDir,
-        std::min<size_t>(
-            zip::CDFHeader::MaxBytes() * eocd.totalEntries,
-            eocd.sizeOfCentralDir
-        )
-    );
-
-    for (size_t fn = 0; fn < eocd.totalEntries; ++fn)
+    auto decodeToStdout = [&toStdout](const zip::Codec* codec, const auto& Hdr, utils::RdBuf_t fileBuf)
     {
-        auto [cdfh, remCdBuf] = zip::CDFHeader::read(cdBuf);
-        if (!cdfh || !Validate(*cdfh, eocd, zipBuf.size()))
+        size_t produced = 0u;
+        auto counted    = [&toStdout, &produced](utils::RdBuf_t Chunk)
         {
-            if (cdfh)
-                std::cerr << "cdfh[" << fn << "] is bogus (1):" << *cdfh << "\n";
-            else
-                std::cerr << "cdfh[" << fn << "] is bogus (1)" << "\n";
-
-            return true;
+            produced += Chunk.size();
+            toStdout(Chunk);
+        };
+        zip::CrcSink toStdoutCrc{ counted };
+        zip::Err err = zip::Err::None;
+        bool viaSink = false;
+
+        if (codec && Has(codec->Caps, zip::CodecCaps::Streaming))
+        {
+            err     = codec->Stream(fileBuf, toStdoutCrc);
+            viaSink = true;
         }
+        else if (codec)
+        {
+            //
+            // the whole output at once: not for a size from the headers that
+            // cannot be right, or that is too large to hold
+            //
+            err = zip::CheckOriginalSz(codec->Method, fileBuf, Hdr.originalSz);
+            if (err == zip::Err::None && Hdr.originalSz > zip::VERIFY_SCRATCH_MAX)
+            {
+                err = zip::Err::Unsupported;
+            }
 
-        //
-        // std::cerr << "cdfh[" << fn << "]: " << *cdfh << "\n";
-        //
+            std::vector<unsigned char> data(err == zip::Err::None ? size_t(Hdr.originalSz) : 0u);
+            uint32_t crc = 0u;
 
-        utils::RdBuf_t lfBuf = zipBuf.subspan(
-            cdfh->offsetOfLFHeader,
-            std::min<size_t>(
-                zip::LFHeader::MaxBytes(),
-                eocd.offsetOfCentralDir
-            )
-        );
+            if (err == zip::Err::None)
+            {
+                err = codec->Decode(fileBuf, { data.data(), data.size() }, &crc);
+            }
+            if (err == zip::Err::None && crc != Hdr.crc32)
+            {
+                err = zip::Err::BadCrc;
+            }
 
-        auto [lfh, dataBuf] = zip::LFHeader::read(lfBuf);
-        if (!lfh || !Validate(*lfh, *cdfh, eocd, zipBuf.size()))
+            if (err == zip::Err::None)
+            {
+                toStdout(data);
+            }
+        }
+        else
         {
-            if (lfh)
-                std::cerr << "lfh[" << fn << "] is bogus (1):" << *lfh << "\n";
-            else
-                std::cerr << "lfh[" << fn << "] is bogus (1)" << "\n";
-
-            return true;
+            std::cerr << "compression:" << Hdr.compression << " is unimplemented" << std::endl;
         }
 
-        if (!Func(*lfh, dataBuf))
+        if (viaSink && err == zip::Err::None && produced != Hdr.originalSz)
         {
-            return false;
+            err = zip::Err::SizeMismatch;
         }
 
-        cdBuf = remCdBuf;
-    }
+        if (viaSink && err == zip::Err::None && toStdoutCrc.Crc() != Hdr.crc32)
+        {
+            err = zip::Err::BadCrc;
+        }
 
-    return true;
-}
+        return err;
+    };
 
-int
-main(int argc, const char* argv[])
-{
-    if (argc != 2)
+    //
+    // "-": the zip comes in on stdin, read front to back as it arrives,
+    // and its central directory is checked once the entries are done
+    //
+    if (std::string_view{ fname } == "-")
     {
-        std::cerr << "Usage: " << argv[0] << " <zip-file>\n";
-        return -1;
-    }
+        size_t badEntries = 0u;
+
+        zip::StreamReader reader{ zip::FdSource(0) };
+        while (reader.Next())
+        {
+            const zip::StreamedEntry& e = reader.Entry();
+            if (testOnly)
+            {
+                zip::Err err = reader.Data([](utils::RdBuf_t) {});
+                std::cout << e.name << ": " << (err == zip::Err::None ? "OK" : zip::ToString(err)) << "\n";
+                badEntries += err == zip::Err::None ? 0u : 1u;
+                continue;
+            }
+
+            std::cout << e.name << ":\n";
+            std::cout << "-------------------------------------\n";
+
+            zip::Err err = reader.Data(toStdout);
+            if (err != zip::Err::None)
+            {
+                std::cerr << e.name << ": " << err << "\n";
+                badEntries += 1u;
+            }
+            std::cout << "-------------------------------------\n";
+        }
+
+        zip::Err err = reader.Finish();
+        if (err != zip::Err::None)
+        {
+            std::cerr << "stdin: " << err << "\n";
+            return -1;
+        }
 
-    const char* fname = argv[1];
+        return badEntries > 0u ? -1 : 0;
+    }
 
     {
-        utils::MemoryMappedFile zipFile{ fname };
-        if (!zipFile.IsValid())
+        zip::Archive archive{ fname };
+        if (!archive.IsMapped())
         {
             std::cerr << "file: " << fname << " could not be mmapped\n";
             return -1;
         }
 
-        utils::RdBuf_t zipBuf = zipFile.Buffer();
+        //
+        // -s: the central directory is not trusted, or not there - the
+        // entries are rebuilt from the local headers in the file
+        //
+        if (salvage)
+        {
+            size_t badEntries = 0u;
+
+            const auto entries = zip::Salvage(archive.Buffer());
+            std::cerr << "salvaged " << entries.size() << " entries\n";
+
+            for (const auto& e : entries)
+            {
+                const zip::Codec* codec = codecs.Find(e.lfh.compression);
+                zip::Err err            = zip::Err::BadData;
+
+                if (testOnly)
+                {
+                    if (!e.truncated)
+                    {
+                        err = codec ? zip::Verify(*codec, e.lfh, e.fileBuf) : zip::Err::Unsupported;
+                    }
+
+                    std::cout << utils::AsPlainStringView(e.lfh.name) << ": " << (err == zip::Err::None ? "OK" : zip::ToString(err)) << "\n";
+                    badEntries += err == zip::Err::None ? 0u : 1u;
+                    continue;
+                }
+
+                std::cout << utils::AsPlainStringView(e.lfh.name) << ":\n";
+                std::cout << "-------------------------------------\n";
+
+                if (!e.truncated)
+                {
+                    err = decodeToStdout(codec, e.lfh, e.fileBuf);
+                }
+
+                if (err != zip::Err::None)
+                {
+                    std::cerr << utils::AsPlainStringView(e.lfh.name) << ": " << (e.truncated ? "truncated" : zip::ToString(err)) << "\n";
+                    badEntries += 1u;
+                }
+                std::cout << "-------------------------------------\n";
+            }
+
+            return badEntries > 0u ? -1 : 0;
+        }
 
-        std::vector<zip::CDir> potentialCDirs = GetPotentialCDir(zipBuf);
-        if (potentialCDirs.size() <= 0)
+        if (!archive.IsValid())
         {
             std::cout << "no valid eocd records found\n";
             return -1;
         }
 
-        bool xxxx = utils::ForEach(
-            potentialCDirs,
-            [zipBuf](const zip::CDir& cdir)
+        //
+        // -l: names and sizes, like `unzip -l` - from the central directory
+        // alone, so that only the tail of the file is read
+        //
+        if (list)
+        {
+            uint64_t totalSz = 0u;
+            size_t count     = 0u;
+
+            std::cout << "    Length  Compressed  Method  Name\n";
+            std::cout << "----------  ----------  ------  ----\n";
+            archive.List(
+                [&](const zip::CDFHeader& cdfh, const zip::NameIndex::Hit&)
+                {
+                    std::cout << std::setw(10) << cdfh.originalSz << "  "
+                              << std::setw(10) << cdfh.compressedSz << "  "
+                              << std::setw(6) << cdfh.compression << "  "
+                              << utils::AsPlainStringView(cdfh.name) << "\n";
+
+                    totalSz += cdfh.originalSz;
+                    count += 1u;
+                    return true;
+                }
+            );
+            std::cout << "----------                      ----\n";
+            std::cout << std::setw(10) << totalSz << "                      " << count << " files\n";
+
+            return 0;
+        }
+
+        //
+        // -b auto: the backends race on the largest entry of each method
+        //
+        if (calibrate)
+        {
+            struct Sample
             {
-                return ForEachEntry(
-                    cdir,
-                    zipBuf,
-                    [&](const zip::LFHeader& lfh, utils::RdBuf_t dataBuf)
+                utils::RdBuf_t fileBuf;
+                size_t originalSz = 0u;
+                uint32_t crc32    = 0u;
+            };
+
+            std::unordered_map<uint16_t, Sample> samples;
+            archive.ForEachEntry(
+                [&samples](const zip::CDFHeader& cdfh, const zip::LFHeader&, utils::RdBuf_t dataBuf)
+                {
+                    Sample& s = samples[cdfh.compression];
+                    if (cdfh.originalSz >= s.originalSz)
                     {
-                        //
-                        // std::cerr << "lfh[" << fn << "]: " << *lfh << "\n";
-                        //
+                        s = { dataBuf, cdfh.originalSz, cdfh.crc32 };
+                    }
+                    return true;
+                }
+            );
+
+            for (const auto& [method, s] : samples)
+            {
+                const zip::Codec* c = codecs.Calibrate(method, s.fileBuf, s.originalSz, s.crc32);
+                if (c)
+                {
+                    std::cerr << "method " << method << ": " << c->Name << "\n";
+                }
+            }
+        }
 
-                        utils::RdBuf_t fileBuf = dataBuf.first(lfh.compressedSz);
+        size_t badEntries = 0u;
 
-                        //
-                        // Get to the contents of the file:
-                        //
-                        for (auto c : lfh.name)
-                            std::cout << c;
+        //
+        // -H N: just the first N bytes of every entry, visited in the order
+        // of their data in the file so the mapping is walked front to back
+        //
+        if (head > 0u)
+        {
+            std::vector<zip::Entry> entries;
+            archive.ForEachEntry(
+                [&entries](const zip::CDFHeader& cdfh, const zip::LFHeader& lfh, utils::RdBuf_t dataBuf)
+                {
+                    entries.push_back({ cdfh, lfh, dataBuf });
+                    return true;
+                }
+            );
+
+            std::stable_sort(
+                entries.begin(),
+                entries.end(),
+                [](const zip::Entry& L, const zip::Entry& R)
+                {
+                    return L.cdfh.offsetOfLFHeader < R.cdfh.offsetOfLFHeader;
+                }
+            );
+
+            std::vector<unsigned char> buf(head);
+            for (const auto& e : entries)
+            {
+                std::cout << utils::AsPlainStringView(e.cdfh.name) << ":\n";
+                std::cout << "-------------------------------------\n";
+
+                auto n = zip::ExtractHead(e.cdfh, e.fileBuf, { buf.data(), buf.size() });
+                if (n.HasValue())
+                {
+                    std::cout.write(reinterpret_cast<const char*>(buf.data()), n.Value());
+                }
+                else if (n.Error() == zip::Err::Unsupported)
+                {
+                    std::cerr << "compression:" << e.cdfh.compression << " is unimplemented" << std::endl;
+                }
+                else
+                {
+                    std::cerr << utils::AsPlainStringView(e.cdfh.name) << ": " << n.Error() << "\n";
+                    badEntries += 1u;
+                }
+
+                std::cout << "-------------------------------------\n";
+            }
 
-                        std::cout << ":\n";
-                        std::cout << "-------------------------------------\n";
-                        if (lfh.compression == 8u)
-                        {
-                            zip::Inflate(
-                                fileBuf,
-                                [](char x)
-                                {
-                                    std::cout << x << std::flush;
-                                }
-                            );
-                        }
-                        else if (lfh.compression == 0u)
+            return badEntries > 0u ? -1 : 0;
+        }
+
+        //
+        // -g GLOB: only the matching entries, in name order, found through
+        // the sorted names rather than by testing every entry
+        //
+        if (glob != nullptr)
+        {
+            zip::SortedNames sorted{ archive };
+            sorted.ForEachMatch(
+                glob,
+                [&](std::string_view Name, const zip::NameIndex::Hit& Hit)
+                {
+                    std::cout << Name << ":\n";
+                    std::cout << "-------------------------------------\n";
+
+                    auto e       = archive.At(Hit);
+                    zip::Err err = e ? decodeToStdout(codecs.Find(e->cdfh.compression), e->cdfh, e->fileBuf) : zip::Err::BadData;
+                    if (err != zip::Err::None)
+                    {
+                        std::cerr << Name << ": " << err << "\n";
+                        badEntries += 1u;
+                    }
+
+                    std::cout << "-------------------------------------\n";
+                    return true;
+                }
+            );
+
+            return badEntries > 0u ? -1 : 0;
+        }
+
+        bool xxxx = archive.ForEachEntry(
+            [&](const zip::CDFHeader& cdfh, const zip::LFHeader& lfh, utils::RdBuf_t fileBuf)
+            {
+                //
+                // std::cerr << "lfh[" << fn << "]: " << *lfh << "\n";
+                //
+
+                const zip::Codec* codec = codecs.Find(lfh.compression);
+
+                //
+                // like `unzip -t`: only check the entries, large
+                // stored ones are checksummed in parallel
+                //
+                if (testOnly)
+                {
+                    zip::Err err = codec ? zip::Verify(*codec, cdfh, fileBuf) : zip::Err::Unsupported;
+                    std::cout << utils::AsPlainStringView(cdfh.name) << ": " << (err == zip::Err::None ? "OK" : zip::ToString(err)) << "\n";
+                    badEntries += err == zip::Err::None ? 0u : 1u;
+                    return true;
+                }
+
+                //
+                // Get to the contents of the file:
+                //
+                for (auto c : lfh.name)
+                    std::cout << c;
+
+                std::cout << ":\n";
+                std::cout << "-------------------------------------\n";
+
+                zip::Err err = zip::Err::None;
+
+                if (pull && (lfh.compression == 0u || lfh.compression == 8u))
+                {
+                    //
+                    // pulled in small pieces, as a streaming consumer would
+                    //
+                    zip::EntryReader reader{ cdfh, fileBuf, { 4096u } };
+                    while (true)
+                    {
+                        auto chunk = reader.Next();
+                        if (chunk.HasError())
                         {
-                            for (char x : fileBuf)
-                                std::cout << x << std::flush;
+                            err = chunk.Error();
+                            break;
                         }
-                        else
+
+                        if (chunk.Value().empty())
                         {
-                            std::cerr << "compression:" << lfh.compression << " is unimplemented" << std::endl;
+                            break;
                         }
-                        std::cout << "-------------------------------------\n";
-                        return true;
+
+                        toStdout(chunk.Value());
                     }
-                );
+                }
+                else
+                {
+                    err = decodeToStdout(codec, cdfh, fileBuf);
+                }
+
+                if (err != zip::Err::None)
+                {
+                    std::cerr << utils::AsPlainStringView(cdfh.name) << ": " << err << "\n";
+                    badEntries += 1u;
+                }
+                std::cout << "-------------------------------------\n";
+                return true;
             }
         );
 
         if (!xxxx)
             return -1;
+
+        if (badEntries > 0u)
+        {
+            std::cerr << badEntries << " entries failed the check\n";
+            return -1;
+        }
     }
 
     return 0;
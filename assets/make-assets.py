@@ -67,3 +67,35 @@ try:
     shutil.rmtree("zz")
 except:
     pass
+
+#
+# zipfile only learns method 93 (zstd) with Python 3.14, so this one is
+# written by hand, compressing with the zstd command line tool
+#
+import struct
+import zlib
+
+def zstd_zip(name, entries):
+    with open(name, "wb") as z:
+        cdir = b""
+        for fname, data in entries:
+            comp = subprocess.run(["zstd", "-19", "-q", "-c"], input=data, stdout=subprocess.PIPE, check=True).stdout
+            crc = zlib.crc32(data)
+            fields = struct.pack("<HHHHHIII", 63, 0, 93, 0, 0x21, crc, len(comp), len(data))
+            cdir += b"PK\x01\x02" + struct.pack("<H", 63) + fields \
+                + struct.pack("<HHHHHII", len(fname), 0, 0, 0, 0, 0, z.tell()) + fname
+            z.write(b"PK\x03\x04" + fields + struct.pack("<HH", len(fname), 0) + fname + comp)
+        offset = z.tell()
+        z.write(cdir)
+        z.write(b"PK\x05\x06" + struct.pack("<HHHHIIH", 0, 0, len(entries), len(entries), len(cdir), offset, 0))
+
+try:
+    os.remove("test5-zstd.zip")
+except:
+    pass
+
+zstd_zip("test5-zstd.zip", [
+    (b"one.txt", b"this is test content1 - 1\n"),
+    (b"two.txt", b"this is another test content2 - 1\n"),
+    (b"sub/three.txt", b"".join(b"this is zstd test line %d of content3 - %d\n" % (i, i * 7919 % 100) for i in range(40))),
+])
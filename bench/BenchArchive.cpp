@@ -0,0 +1,342 @@
+#include "zip/Archive.hpp"
+#include "zip/CDIndex.hpp"
+#include "zip/SidecarIndex.hpp"
+#include "zip/SortedNames.hpp"
+#include "tests/ZipBuilder.hpp"
+
+#include <zlib.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+template<class FuncT>
+double
+Seconds(FuncT Func)
+{
+    auto t0 = std::chrono::steady_clock::now();
+    Func();
+    auto t1 = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+}
+
+int
+main()
+{
+    //
+    // 65535 entries, the most a plain (not zip64) end of central directory
+    // record can count
+    //
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 65535u; ++i)
+    {
+        names.push_back("service/assets/v" + std::to_string(i % 13u) + "/bundle-" + std::to_string(i * 7919u % 1000003u) + ".json");
+    }
+
+    const auto buf = MakeZip(names);
+    std::printf("archive: %zu entries, %zu bytes\n", names.size(), buf.size());
+
+    unsigned acc = 0u;
+
+    std::unique_ptr<zip::Archive> archive;
+    double open = Seconds(
+        [&]()
+        {
+            archive = std::make_unique<zip::Archive>(utils::RdBuf_t{ buf });
+        }
+    );
+    std::printf("%-24s %10.1f ms, %.1f bytes/entry\n", "open + name index", open * 1e3, double(archive->Names().Bytes()) / names.size());
+
+    constexpr size_t LINEAR = 200u;
+    double linear = Seconds(
+        [&]()
+        {
+            for (size_t i = 0; i < LINEAR; ++i)
+            {
+                const std::string& name = names[i * 7919u % names.size()];
+                archive->ForEachEntry(
+                    [&](const zip::CDFHeader& cdfh, const zip::LFHeader&, utils::RdBuf_t)
+                    {
+                        if (utils::AsPlainStringView(cdfh.name) != name)
+                        {
+                            return true;
+                        }
+
+                        acc += cdfh.crc32;
+                        return false;
+                    }
+                );
+            }
+        }
+    );
+    std::printf("%-24s %10.1f us/lookup\n", "find, linear walk", linear / LINEAR * 1e6);
+
+    constexpr size_t HASHED = 1000000u;
+    double hashed = Seconds(
+        [&]()
+        {
+            for (size_t i = 0; i < HASHED; ++i)
+            {
+                auto e = archive->Find(names[i * 7919u % names.size()]);
+                acc += e->cdfh.crc32;
+            }
+        }
+    );
+    std::printf("%-24s %10.1f us/lookup\n", "find, name index", hashed / HASHED * 1e6);
+
+    //
+    // the whole central directory in memory: parsed headers vs the columns
+    //
+    std::vector<zip::CDFHeader> parsed;
+    double parse = Seconds(
+        [&]()
+        {
+            archive->ForEachEntry(
+                [&parsed](const zip::CDFHeader& cdfh, const zip::LFHeader&, utils::RdBuf_t)
+                {
+                    parsed.push_back(cdfh);
+                    return true;
+                }
+            );
+        }
+    );
+    std::printf("%-24s %10.1f ms, %.1f bytes/entry (+ the mapping, for names)\n", "CDFHeader vector", parse * 1e3, double(sizeof(zip::CDFHeader)));
+
+    zip::CDIndex index;
+    double build = Seconds(
+        [&]()
+        {
+            index = zip::CDIndex{ *archive };
+        }
+    );
+    std::printf("%-24s %10.1f ms, %.1f bytes/entry\n", "CDIndex", build * 1e3, index.BytesPerEntry());
+
+    //
+    // locating the headers by a walk vs a signature scan in chunks, and the
+    // index built from that - with 4 threads whatever the host has, so the
+    // split and stitch costs show even on one core
+    //
+    const zip::CDScanConfig SCAN{ 0u, 4u, 1u };
+
+    std::vector<uint64_t> walked;
+    double walk = Seconds(
+        [&]()
+        {
+            zip::ForEachCDFHeader(
+                archive->CDirs()[0],
+                archive->Buffer(),
+                [&walked](const zip::CDFHeader&, uint64_t CdOffset)
+                {
+                    walked.push_back(CdOffset);
+                    return true;
+                }
+            );
+        }
+    );
+    std::printf("%-24s %10.1f ms\n", "locate, serial walk", walk * 1e3);
+
+    std::vector<uint64_t> scanned;
+    double scan = Seconds(
+        [&]()
+        {
+            scanned = zip::ScanCDFHeaders(archive->CDirs()[0], archive->Buffer(), SCAN);
+        }
+    );
+    std::printf("%-24s %10.1f ms, %s\n", "locate, 4-way scan", scan * 1e3, scanned == walked ? "same" : "DIFFERENT");
+
+    double buildScanned = Seconds(
+        [&]()
+        {
+            acc += zip::CDIndex{ *archive, SCAN }.Size();
+        }
+    );
+    std::printf("%-24s %10.1f ms\n", "CDIndex, 4-way", buildScanned * 1e3);
+
+    constexpr size_t SCANS = 1000u;
+    double scanParsed = Seconds(
+        [&]()
+        {
+            for (size_t i = 0; i < SCANS; ++i)
+            {
+                uint64_t sum = 0u;
+                for (const auto& cdfh : parsed)
+                {
+                    sum += cdfh.originalSz;
+                }
+                acc += sum;
+            }
+        }
+    );
+    std::printf("%-24s %10.1f us/scan\n", "sum sizes, CDFHeader", scanParsed / SCANS * 1e6);
+
+    double scanIndex = Seconds(
+        [&]()
+        {
+            for (size_t i = 0; i < SCANS; ++i)
+            {
+                acc += index.TotalOriginalSz() + index.CountMethod(8u);
+            }
+        }
+    );
+    std::printf("%-24s %10.1f us/scan\n", "sum + count, CDIndex", scanIndex / SCANS * 1e6);
+
+    //
+    // names and sizes of every entry: with the local headers, which on a
+    // cold file is a random read per entry, vs from the central directory
+    //
+    uint64_t listed = 0u;
+    double listEntries = Seconds(
+        [&]()
+        {
+            archive->ForEachEntry(
+                [&listed](const zip::CDFHeader& cdfh, const zip::LFHeader&, utils::RdBuf_t)
+                {
+                    listed += cdfh.originalSz + cdfh.nameLen;
+                    return true;
+                }
+            );
+        }
+    );
+    std::printf("%-24s %10.1f ms\n", "list, ForEachEntry", listEntries * 1e3);
+
+    double listCd = Seconds(
+        [&]()
+        {
+            archive->List(
+                [&listed](const zip::CDFHeader& cdfh, const zip::NameIndex::Hit&)
+                {
+                    listed += cdfh.originalSz + cdfh.nameLen;
+                    return true;
+                }
+            );
+        }
+    );
+    std::printf("%-24s %10.1f ms (central directory only)\n", "list, List", listCd * 1e3);
+    acc += unsigned(listed);
+
+    //
+    // a glob with a literal start: testing every name vs the run of sorted
+    // names that share it
+    //
+    const char* GLOB = "service/assets/v7/bundle-1*.json";
+
+    zip::SortedNames sorted;
+    double sort = Seconds(
+        [&]()
+        {
+            sorted = zip::SortedNames{ *archive };
+        }
+    );
+    std::printf("%-24s %10.1f ms, %.1f bytes/entry\n", "SortedNames", sort * 1e3, double(sorted.Bytes()) / names.size());
+
+    constexpr size_t GLOBS = 100u;
+    size_t matches = 0u;
+    double globLinear = Seconds(
+        [&]()
+        {
+            for (size_t i = 0; i < GLOBS; ++i)
+            {
+                archive->ForEachEntry(
+                    [&](const zip::CDFHeader& cdfh, const zip::LFHeader&, utils::RdBuf_t)
+                    {
+                        matches += zip::SortedNames::Match(GLOB, utils::AsPlainStringView(cdfh.name));
+                        return true;
+                    }
+                );
+            }
+        }
+    );
+    std::printf("%-24s %10.1f us/query, %zu matches\n", "glob, every entry", globLinear / GLOBS * 1e6, matches / GLOBS);
+
+    matches = 0u;
+    double globSorted = Seconds(
+        [&]()
+        {
+            for (size_t i = 0; i < GLOBS; ++i)
+            {
+                sorted.ForEachMatch(
+                    GLOB,
+                    [&matches](std::string_view, const zip::NameIndex::Hit&)
+                    {
+                        ++matches;
+                        return true;
+                    }
+                );
+            }
+        }
+    );
+    std::printf("%-24s %10.1f us/query, %zu matches\n", "glob, sorted names", globSorted / GLOBS * 1e6, matches / GLOBS);
+
+    //
+    // opening from a file, with the index built in memory vs mapped from a
+    // sidecar written by an earlier open
+    //
+    const char* ZIP           = "tmp_bench.zip";
+    const std::string SIDECAR = zip::SidecarIndex::PathFor(ZIP);
+    {
+        FILE* f = std::fopen(ZIP, "wb");
+        std::fwrite(buf.data(), 1u, buf.size(), f);
+        std::fclose(f);
+        std::remove(SIDECAR.c_str());
+    }
+
+    constexpr size_t OPENS = 20u;
+    double openIndexed = Seconds(
+        [&]()
+        {
+            for (size_t i = 0; i < OPENS; ++i)
+            {
+                zip::Archive a{ ZIP };
+                acc += a.Find(names[i])->cdfh.crc32;
+            }
+        }
+    );
+    std::printf("%-24s %10.1f ms/open\n", "open file + name index", openIndexed / OPENS * 1e3);
+
+    double openWrite = Seconds(
+        [&]()
+        {
+            zip::Archive a{ ZIP, SIDECAR.c_str() };
+            acc += a.Find(names[0])->cdfh.crc32;
+        }
+    );
+    std::printf("%-24s %10.1f ms\n", "first open, sidecar", openWrite * 1e3);
+
+    double openSidecar = Seconds(
+        [&]()
+        {
+            for (size_t i = 0; i < OPENS; ++i)
+            {
+                zip::Archive a{ ZIP, SIDECAR.c_str() };
+                acc += a.Find(names[i])->cdfh.crc32;
+            }
+        }
+    );
+    std::printf("%-24s %10.1f ms/open (fingerprint checked)\n", "open file + sidecar", openSidecar / OPENS * 1e3);
+
+    double mapSidecar = Seconds(
+        [&]()
+        {
+            for (size_t i = 0; i < OPENS; ++i)
+            {
+                auto s = zip::SidecarIndex::Open(SIDECAR.c_str());
+                acc += s.Value().Find(names[i])->CdOffset;
+            }
+        }
+    );
+    std::printf("%-24s %10.1f us/open (unchecked)\n", "SidecarIndex::Open", mapSidecar / OPENS * 1e6);
+
+    std::remove(ZIP);
+    std::remove(SIDECAR.c_str());
+
+    std::printf("(checksum: %u)\n", acc);
+}
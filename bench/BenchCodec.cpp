@@ -0,0 +1,137 @@
+#include "zip/Codec.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::vector<unsigned char>
+Deflate(const std::string& Src)
+{
+    z_stream strm{};
+    deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+
+    std::vector<unsigned char> dst(deflateBound(&strm, Src.size()));
+    strm.next_in   = (Bytef*)Src.data();
+    strm.avail_in  = Src.size();
+    strm.next_out  = dst.data();
+    strm.avail_out = dst.size();
+    deflate(&strm, Z_FINISH);
+
+    dst.resize(strm.total_out);
+    deflateEnd(&strm);
+    return dst;
+}
+
+std::string
+MakeContent(size_t Sz)
+{
+    std::string s;
+    uint32_t x = 12345u;
+    while (s.size() < Sz)
+    {
+        x = x * 1103515245u + 12345u;
+        s += "record " + std::to_string(x % 100000u) + ", value " + std::to_string((x >> 8) % 977u) + "\n";
+    }
+    s.resize(Sz);
+    return s;
+}
+
+template<class FuncT>
+void
+Measure(const char* Name, size_t Bytes, FuncT Func)
+{
+    constexpr int ROUNDS = 5;
+
+    double best = 0.0;
+    for (int i = 0; i < ROUNDS; ++i)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        Func();
+        auto t1 = std::chrono::steady_clock::now();
+
+        double secs = std::chrono::duration<double>(t1 - t0).count();
+        double mbps = Bytes / secs / (1024.0 * 1024.0);
+        best        = std::max(best, mbps);
+    }
+
+    std::printf("%-28s %10.1f MB/s\n", Name, best);
+}
+
+}
+
+int
+main()
+{
+    const std::string content = MakeContent(32u << 20);
+    const auto compressed     = Deflate(content);
+    const uint32_t crc        = crc32(0u, (const Bytef*)content.data(), content.size());
+
+    const utils::RdBuf_t stored{ reinterpret_cast<const unsigned char*>(content.data()), content.size() };
+
+    zip::CodecRegistry& codecs = zip::CodecRegistry::Default();
+
+    std::vector<unsigned char> out(content.size());
+    unsigned acc = 0u;
+
+    for (uint16_t method : { 0u, 8u })
+    {
+        const utils::RdBuf_t src = method == 0u ? stored : utils::RdBuf_t{ compressed };
+        std::printf("method %u: %zu -> %zu bytes\n", method, src.size(), content.size());
+
+        for (const zip::Codec* c : codecs.ForMethod(method))
+        {
+            if (Has(c->Caps, zip::CodecCaps::OneShot))
+            {
+                const std::string name = std::string(c->Name) + ", one-shot";
+                Measure(
+                    name.c_str(),
+                    content.size(),
+                    [&]()
+                    {
+                        uint32_t outCrc = 0u;
+                        c->Decode(src, { out.data(), out.size() }, &outCrc);
+                        acc ^= outCrc;
+                    }
+                );
+            }
+
+            if (Has(c->Caps, zip::CodecCaps::Streaming))
+            {
+                const std::string name = std::string(c->Name) + ", streaming";
+                Measure(
+                    name.c_str(),
+                    content.size(),
+                    [&]()
+                    {
+                        //
+                        // a sink that does as much as the one-shot decode:
+                        // the bytes end up in out
+                        //
+                        size_t pos = 0u;
+                        c->Stream(
+                            src,
+                            [&out, &pos](utils::RdBuf_t Chunk)
+                            {
+                                std::copy_n(Chunk.data(), Chunk.size(), out.data() + pos);
+                                pos += Chunk.size();
+                            }
+                        );
+                        acc ^= out[pos / 2u];
+                    }
+                );
+            }
+        }
+
+        const zip::Codec* fastest = codecs.Calibrate(method, src, content.size(), crc);
+        std::printf("fastest one-shot backend: %s\n", fastest ? fastest->Name : "(none)");
+    }
+
+    std::printf("(checksum: %u)\n", acc);
+}
@@ -0,0 +1,184 @@
+#include "zip/Inflate.hpp"
+#include "utils/Crc32.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+std::vector<unsigned char>
+Deflate(const std::string& Src)
+{
+    z_stream strm{};
+    deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+
+    std::vector<unsigned char> dst(deflateBound(&strm, Src.size()));
+    strm.next_in   = (Bytef*)Src.data();
+    strm.avail_in  = Src.size();
+    strm.next_out  = dst.data();
+    strm.avail_out = dst.size();
+    deflate(&strm, Z_FINISH);
+
+    dst.resize(strm.total_out);
+    deflateEnd(&strm);
+    return dst;
+}
+
+std::string
+MakeContent(size_t Sz)
+{
+    std::string s;
+    uint32_t x = 12345u;
+    while (s.size() < Sz)
+    {
+        x = x * 1103515245u + 12345u;
+        s += "record " + std::to_string(x % 100000u) + ", value " + std::to_string((x >> 8) % 977u) + "\n";
+    }
+    s.resize(Sz);
+    return s;
+}
+
+template<class FuncT>
+void
+Measure(const char* Name, size_t Bytes, FuncT Func)
+{
+    constexpr int ROUNDS = 5;
+
+    double best = 0.0;
+    for (int i = 0; i < ROUNDS; ++i)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        Func();
+        auto t1 = std::chrono::steady_clock::now();
+
+        double secs = std::chrono::duration<double>(t1 - t0).count();
+        double mbps = Bytes / secs / (1024.0 * 1024.0);
+        best        = std::max(best, mbps);
+    }
+
+    std::printf("%-28s %10.1f MB/s\n", Name, best);
+}
+
+}
+
+int
+main()
+{
+    const std::string content = MakeContent(64u << 20);
+    const auto compressed     = Deflate(content);
+
+    const utils::RdBuf_t contentBuf{ reinterpret_cast<const unsigned char*>(content.data()), content.size() };
+
+    std::printf(
+        "crc32: %zu bytes, active kernel: %s\n",
+        content.size(),
+        utils::Crc32ActiveKernel() == utils::Crc32Kernel::Clmul ? "clmul" : "slice-by-16"
+    );
+
+    uint32_t acc = 0u;
+
+    Measure(
+        "zlib crc32()",
+        content.size(),
+        [&]()
+        {
+            acc ^= crc32(0u, contentBuf.data(), contentBuf.size());
+        }
+    );
+
+    Measure(
+        "slice-by-16",
+        content.size(),
+        [&]()
+        {
+            acc ^= utils::Crc32SliceBy16(0u, contentBuf);
+        }
+    );
+
+    Measure(
+        "clmul",
+        content.size(),
+        [&]()
+        {
+            acc ^= utils::Crc32Clmul(0u, contentBuf);
+        }
+    );
+
+    //
+    // large stored member: thread scaling of the segmented crc
+    //
+    {
+        std::vector<unsigned char> big(256u << 20);
+        for (size_t i = 0; i < big.size(); i += content.size())
+        {
+            std::copy_n(content.data(), std::min(content.size(), big.size() - i), big.begin() + i);
+        }
+
+        const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        std::printf("parallel crc32: %zu bytes, %u hardware threads\n", big.size(), hw);
+
+        for (unsigned threads = 1u; threads <= std::max(8u, hw); threads *= 2u)
+        {
+            const std::string name = std::to_string(threads) + " thread(s)";
+            Measure(
+                name.c_str(),
+                big.size(),
+                [&]()
+                {
+                    acc ^= utils::Crc32Parallel(0u, big, { 0u, threads });
+                }
+            );
+        }
+    }
+
+    //
+    // verifying an entry: crc as a second pass over the output vs fused into
+    // the decoder
+    //
+    std::vector<unsigned char> out(content.size());
+
+    for (auto backend : { zip::InflateBackend::Zlib, zip::InflateBackend::Native })
+    {
+        const bool native = backend == zip::InflateBackend::Native;
+
+        Measure(
+            native ? "native, no crc" : "zlib, no crc",
+            content.size(),
+            [&]()
+            {
+                zip::InflateInto(compressed, { out.data(), out.size() }, backend);
+                acc ^= out.back();
+            }
+        );
+
+        Measure(
+            native ? "native, crc second pass" : "zlib, crc second pass",
+            content.size(),
+            [&]()
+            {
+                zip::InflateInto(compressed, { out.data(), out.size() }, backend);
+                acc ^= utils::Crc32(0u, { out.data(), out.size() });
+            }
+        );
+
+        Measure(
+            native ? "native, fused crc" : "zlib, fused crc",
+            content.size(),
+            [&]()
+            {
+                uint32_t crc = 0u;
+                zip::InflateInto(compressed, { out.data(), out.size() }, backend, &crc);
+                acc ^= crc;
+            }
+        );
+    }
+
+    std::printf("(checksum: %u)\n", acc);
+}
@@ -0,0 +1,282 @@
+#include "zip/Inflate.hpp"
+#include "zip/InflateContext.hpp"
+#include "zip/ParallelInflate.hpp"
+#include "zip/AccessIndex.hpp"
+#include "zip/Extract.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+std::vector<unsigned char>
+Deflate(const std::string& Src)
+{
+    z_stream strm{};
+    deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+
+    std::vector<unsigned char> dst(deflateBound(&strm, Src.size()));
+    strm.next_in   = (Bytef*)Src.data();
+    strm.avail_in  = Src.size();
+    strm.next_out  = dst.data();
+    strm.avail_out = dst.size();
+    deflate(&strm, Z_FINISH);
+
+    dst.resize(strm.total_out);
+    deflateEnd(&strm);
+    return dst;
+}
+
+std::string
+MakeContent(size_t Sz)
+{
+    std::string s;
+    uint32_t x = 12345u;
+    while (s.size() < Sz)
+    {
+        x = x * 1103515245u + 12345u;
+        s += "record " + std::to_string(x % 100000u) + ", value " + std::to_string((x >> 8) % 977u) + "\n";
+    }
+    s.resize(Sz);
+    return s;
+}
+
+template<class FuncT>
+void
+Measure(const char* Name, size_t Bytes, FuncT Func)
+{
+    constexpr int ROUNDS = 5;
+
+    double best = 0.0;
+    for (int i = 0; i < ROUNDS; ++i)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        Func();
+        auto t1 = std::chrono::steady_clock::now();
+
+        double secs = std::chrono::duration<double>(t1 - t0).count();
+        double mbps = Bytes / secs / (1024.0 * 1024.0);
+        best        = std::max(best, mbps);
+    }
+
+    std::printf("%-24s %10.1f MB/s\n", Name, best);
+}
+
+}
+
+int
+main()
+{
+    const std::string content = MakeContent(64u << 20);
+    const auto compressed     = Deflate(content);
+
+    std::printf("inflate: %zu -> %zu bytes\n", compressed.size(), content.size());
+
+    unsigned char acc = 0;
+
+    Measure(
+        "per-byte callback",
+        content.size(),
+        [&]()
+        {
+            zip::Inflate(
+                compressed,
+                std::function<void(unsigned char)>{ [&acc](unsigned char c)
+                                                    { acc ^= c; } }
+            );
+        }
+    );
+
+    Measure(
+        "chunk sink",
+        content.size(),
+        [&]()
+        {
+            zip::Inflate(
+                compressed,
+                [&acc](utils::RdBuf_t Chunk)
+                {
+                    acc ^= Chunk.front();
+                    acc ^= Chunk.back();
+                }
+            );
+        }
+    );
+
+    std::vector<unsigned char> out(content.size());
+
+    Measure(
+        "one-shot zlib",
+        content.size(),
+        [&]()
+        {
+            zip::InflateInto(compressed, { out.data(), out.size() }, zip::InflateBackend::Zlib);
+            acc ^= out.back();
+        }
+    );
+
+    Measure(
+        "one-shot native",
+        content.size(),
+        [&]()
+        {
+            zip::InflateInto(compressed, { out.data(), out.size() }, zip::InflateBackend::Native);
+            acc ^= out.back();
+        }
+    );
+
+    //
+    // a single large member split across threads - on a single core this only
+    // shows the overhead of the speculation
+    //
+    for (unsigned threads : { 2u, std::max(4u, std::thread::hardware_concurrency()) })
+    {
+        zip::ParallelInflateConfig config;
+        config.Threads  = threads;
+        config.MinChunk = 1u << 20;
+
+        const std::string name = "one-shot parallel, " + std::to_string(threads) + "t";
+        Measure(
+            name.c_str(),
+            content.size(),
+            [&]()
+            {
+                zip::ParallelInflateInto(compressed, { out.data(), out.size() }, nullptr, config);
+                acc ^= out.back();
+            }
+        );
+    }
+
+    //
+    // the last 4 KB of the member: inflating everything in front of them vs
+    // starting at the closest access point (rated by the member size)
+    //
+    {
+        const auto index = zip::AccessIndex::Build(compressed);
+        std::printf("access index: %zu points, %zu bytes\n", index.Value().Points().size(), index.Value().Serialize().size());
+
+        unsigned char tail[4096];
+
+        Measure(
+            "tail read, full inflate",
+            content.size(),
+            [&]()
+            {
+                zip::InflateInto(compressed, { out.data(), out.size() }, zip::InflateBackend::Zlib);
+                std::copy_n(out.end() - sizeof tail, sizeof tail, tail);
+                acc ^= tail[0];
+            }
+        );
+
+        Measure(
+            "tail read, access index",
+            content.size(),
+            [&]()
+            {
+                index.Value().ReadRange(compressed, content.size() - sizeof tail, { tail, sizeof tail });
+                acc ^= tail[0];
+            }
+        );
+    }
+
+    //
+    // sniffing: the first 256 bytes of 1000 members of 64 KB each, decoding
+    // them whole vs stopping early (rated by the members' size)
+    //
+    {
+        std::vector<std::vector<unsigned char>> sniffed;
+        for (size_t i = 0; i < 1000u; ++i)
+        {
+            sniffed.push_back(Deflate(content.substr(i << 16, 1u << 16)));
+        }
+
+        unsigned char head[256];
+
+        Measure(
+            "head read, full inflate",
+            sniffed.size() << 16,
+            [&]()
+            {
+                for (const auto& m : sniffed)
+                {
+                    zip::InflateInto(m, { out.data(), 1u << 16 }, zip::InflateBackend::Zlib);
+                    acc ^= out[0];
+                }
+            }
+        );
+
+        Measure(
+            "head read, ExtractHead",
+            sniffed.size() << 16,
+            [&]()
+            {
+                for (const auto& m : sniffed)
+                {
+                    zip::ExtractHead(8u, m, 1u << 16, { head, sizeof head });
+                    acc ^= head[0];
+                }
+            }
+        );
+    }
+
+    //
+    // jar-like archives: many tiny members, where stream setup dominates
+    //
+    std::vector<std::vector<unsigned char>> members;
+    size_t membersBytes = 0u;
+    for (size_t i = 0; i < 100000u; ++i)
+    {
+        members.push_back(Deflate(content.substr(i * 61u % (content.size() - 1024u), 200u + i % 400u)));
+        membersBytes += 200u + i % 400u;
+    }
+
+    std::printf("tiny members: %zu, %zu bytes\n", members.size(), membersBytes);
+
+    Measure(
+        "init/end per member",
+        membersBytes,
+        [&]()
+        {
+            unsigned char out[16384];
+            for (const auto& m : members)
+            {
+                z_stream strm{};
+                inflateInit2(&strm, -MAX_WBITS);
+                strm.next_in   = (Bytef*)m.data();
+                strm.avail_in  = m.size();
+                strm.next_out  = out;
+                strm.avail_out = sizeof(out);
+                inflate(&strm, Z_NO_FLUSH);
+                acc ^= out[0];
+                inflateEnd(&strm);
+            }
+        }
+    );
+
+    Measure(
+        "pooled context",
+        membersBytes,
+        [&]()
+        {
+            for (const auto& m : members)
+            {
+                zip::Inflate(
+                    m,
+                    [&acc](utils::RdBuf_t Chunk)
+                    {
+                        acc ^= Chunk.front();
+                    }
+                );
+            }
+        }
+    );
+
+    std::printf("(checksum: %u)\n", acc);
+}
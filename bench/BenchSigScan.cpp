@@ -0,0 +1,225 @@
+#include "zip/Salvage.hpp"
+#include "utils/ForEachFindEnd.hpp"
+#include "utils/SigScan.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+template<class FuncT>
+void
+Measure(const char* Name, size_t Bytes, FuncT Func)
+{
+    constexpr int ROUNDS = 5;
+
+    double best = 0.0;
+    for (int i = 0; i < ROUNDS; ++i)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        Func();
+        auto t1 = std::chrono::steady_clock::now();
+
+        double secs = std::chrono::duration<double>(t1 - t0).count();
+        double mbps = Bytes / secs / (1024.0 * 1024.0);
+        best        = std::max(best, mbps);
+    }
+
+    std::printf("%-28s %10.1f MB/s\n", Name, best);
+}
+
+const char*
+KernelName(utils::SigScanKernel Kernel)
+{
+    switch (Kernel)
+    {
+    case utils::SigScanKernel::Avx2:
+        return "avx2";
+    case utils::SigScanKernel::Sse2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
+
+}
+
+int
+main()
+{
+    const utils::Sig_t SIG{ 0x50u, 0x4bu, 0x05u, 0x06u };
+
+    //
+    // compressed data looks random: a 'P' every 256 bytes on average, and
+    // hardly ever a whole signature - here one per MiB
+    //
+    std::vector<unsigned char> buf(64u << 20);
+
+    uint32_t x = 2463534242u;
+    for (auto& c : buf)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        c = uint8_t(x);
+    }
+    for (size_t i = 1000u; i + SIG.size() <= buf.size(); i += 1u << 20)
+    {
+        std::copy(SIG.begin(), SIG.end(), buf.begin() + i);
+    }
+
+    std::printf("signature scan: %zu bytes, active kernel: %s\n", buf.size(), KernelName(utils::SigScanActiveKernel()));
+
+    size_t acc = 0u;
+
+    //
+    // the end record search: backwards over the last 64 KiB, every match
+    //
+    {
+        constexpr size_t TAIL = 64u * 1024u;
+        constexpr size_t REPS = 256u;
+
+        const utils::RdBuf_t tail = utils::RdBuf_t{ buf }.last(TAIL);
+
+        Measure(
+            "64 KiB tail, std::find_end",
+            TAIL * REPS,
+            [&]()
+            {
+                for (size_t r = 0; r < REPS; ++r)
+                {
+                    utils::ForEachFindEnd(
+                        tail,
+                        SIG,
+                        [&acc](utils::RdBuf_t Match)
+                        {
+                            acc += Match.size();
+                            return true;
+                        }
+                    );
+                }
+            }
+        );
+
+        Measure(
+            "64 KiB tail, ForEachSig",
+            TAIL * REPS,
+            [&]()
+            {
+                for (size_t r = 0; r < REPS; ++r)
+                {
+                    utils::ForEachSig(
+                        tail,
+                        SIG,
+                        utils::SigScanDir::Backward,
+                        [&acc](size_t At)
+                        {
+                            acc += At;
+                            return true;
+                        }
+                    );
+                }
+            }
+        );
+    }
+
+    //
+    // each kernel over the whole buffer, both ways
+    //
+    for (auto kernel : { utils::SigScanKernel::Scalar, utils::SigScanKernel::Sse2, utils::SigScanKernel::Avx2 })
+    {
+        const std::string forward  = std::string("forward, ") + KernelName(kernel);
+        const std::string backward = std::string("backward, ") + KernelName(kernel);
+
+        Measure(
+            forward.c_str(),
+            buf.size(),
+            [&]()
+            {
+                for (size_t at = utils::FindSig(buf, SIG, 0u, kernel); at < buf.size(); at = utils::FindSig(buf, SIG, at + 1u, kernel))
+                {
+                    acc += at;
+                }
+            }
+        );
+
+        Measure(
+            backward.c_str(),
+            buf.size(),
+            [&]()
+            {
+                for (size_t at = utils::RFindSig(buf, SIG, buf.size(), kernel); at < buf.size(); at = utils::RFindSig(buf, SIG, at, kernel))
+                {
+                    acc += at;
+                }
+            }
+        );
+    }
+
+    Measure(
+        "backward, std::find_end",
+        buf.size(),
+        [&]()
+        {
+            utils::ForEachFindEnd(
+                utils::RdBuf_t{ buf },
+                SIG,
+                [&acc](utils::RdBuf_t Match)
+                {
+                    acc += Match.size();
+                    return true;
+                }
+            );
+        }
+    );
+
+    //
+    // salvaging the same bytes as 1 MiB stored entries, with no central
+    // directory: the local header scan, and a header to decode per entry
+    //
+    {
+        constexpr size_t ENTRY = 1u << 20;
+
+        for (size_t at = 0; at + ENTRY <= buf.size(); at += ENTRY)
+        {
+            const unsigned char lfh[30] = { 0x50u, 0x4bu, 0x03u, 0x04u, 10u, 0u, 0u, 0u, 0u, 0u };
+            std::copy(std::begin(lfh), std::end(lfh), buf.begin() + at);
+
+            const uint32_t sz = ENTRY - sizeof lfh;
+            for (size_t i = 0; i < 4u; ++i)
+            {
+                buf[at + 18u + i] = uint8_t(sz >> (8u * i));
+                buf[at + 22u + i] = uint8_t(sz >> (8u * i));
+            }
+        }
+
+        size_t entries = 0u;
+        Measure(
+            "salvage, 1 thread",
+            buf.size(),
+            [&]()
+            {
+                entries = zip::Salvage(buf, { 0u, 1u, 1u }).size();
+            }
+        );
+
+        Measure(
+            "salvage, 4 threads",
+            buf.size(),
+            [&]()
+            {
+                entries = zip::Salvage(buf, { 0u, 4u, 1u }).size();
+            }
+        );
+
+        std::printf("(salvaged %zu entries)\n", entries);
+    }
+
+    std::printf("(checksum: %zu)\n", acc);
+}
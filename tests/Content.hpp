@@ -0,0 +1,50 @@
+#pragma once
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//
+// Sz bytes of text lines, different ones for each Seed, that compress about
+// as well as logs do.
+//
+inline std::string
+MakeContent(size_t Sz, uint32_t Seed = 12345u)
+{
+    std::string s;
+    uint32_t x = Seed;
+    while (s.size() < Sz)
+    {
+        x = x * 1103515245u + 12345u;
+        s += "line " + std::to_string(x % 100000u) + ", value " + std::to_string((x >> 8) % 977u) + "\n";
+    }
+    s.resize(Sz);
+    return s;
+}
+
+//
+// Src as a raw deflate stream, the way a zip stores it.
+//
+inline std::vector<unsigned char>
+Deflate(const std::string& Src, int Level = Z_DEFAULT_COMPRESSION, int Strategy = Z_DEFAULT_STRATEGY)
+{
+    z_stream strm{};
+    [[maybe_unused]] int ret = deflateInit2(&strm, Level, Z_DEFLATED, -MAX_WBITS, 8, Strategy);
+    assert(ret == Z_OK);
+
+    std::vector<unsigned char> dst(deflateBound(&strm, Src.size()));
+    strm.next_in   = (Bytef*)Src.data();
+    strm.avail_in  = Src.size();
+    strm.next_out  = dst.data();
+    strm.avail_out = dst.size();
+
+    ret = deflate(&strm, Z_FINISH);
+    assert(ret == Z_STREAM_END);
+
+    dst.resize(strm.total_out);
+    deflateEnd(&strm);
+    return dst;
+}
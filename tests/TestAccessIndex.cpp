@@ -0,0 +1,129 @@
+#include "zip/AccessIndex.hpp"
+#include "zip/Extract.hpp"
+#include "tests/Content.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+std::string
+Read(const zip::AccessIndex& Index, const std::vector<unsigned char>& Src, uint64_t Offset, size_t Len)
+{
+    std::string out(Len, '\0');
+    zip::Err e = Index.ReadRange(Src, Offset, { (unsigned char*)out.data(), out.size() });
+    assert(e == zip::Err::None);
+    return out;
+}
+
+}
+
+int
+main()
+{
+    const std::string content = MakeContent(3u << 20);
+    const uint32_t crc        = crc32(0u, (const Bytef*)content.data(), content.size());
+    const uint64_t span       = 256u * 1024u;
+
+    for (auto [level, strategy] : { std::pair{ 6, Z_DEFAULT_STRATEGY }, std::pair{ 9, Z_FIXED }, std::pair{ 0, Z_DEFAULT_STRATEGY } })
+    {
+        const auto compressed = Deflate(content, level, strategy);
+
+        auto built = zip::AccessIndex::Build(compressed, span);
+        assert(built.HasValue());
+
+        const zip::AccessIndex& index = built.Value();
+        assert(index.OriginalSz() == content.size());
+        assert(index.Crc() == crc);
+        assert(index.Points().size() > 4u);
+        assert(index.Points().front().Out == 0u);
+
+        //
+        // ranges at, just before and just after access points, spanning
+        // several of them, and at the very end
+        //
+        for (const auto& p : index.Points())
+        {
+            for (uint64_t off : { p.Out, p.Out + 1u, p.Out ? p.Out - 1u : 0u })
+            {
+                size_t len = std::min<size_t>(5000u, content.size() - off);
+                assert(Read(index, compressed, off, len) == content.substr(off, len));
+            }
+        }
+
+        assert(Read(index, compressed, 100u, 3u * span) == content.substr(100u, 3u * span));
+        assert(Read(index, compressed, content.size() - 10u, 10u) == content.substr(content.size() - 10u));
+        assert(Read(index, compressed, content.size(), 0u).empty());
+
+        unsigned char b[2];
+        assert(index.ReadRange(compressed, content.size() - 1u, { b, 2u }) == zip::Err::SizeMismatch);
+        assert(index.ReadRange(compressed, content.size() + 1u, { b, 0u }) == zip::Err::SizeMismatch);
+
+        //
+        // a round trip through the serialized form gives the same answers
+        //
+        const auto bytes = index.Serialize();
+
+        auto restored = zip::AccessIndex::Deserialize(bytes);
+        assert(restored.HasValue());
+        assert(restored.Value().Matches(compressed.size(), content.size(), crc));
+        assert(restored.Value().Points().size() == index.Points().size());
+        assert(Read(restored.Value(), compressed, content.size() / 2u, 1000u) == content.substr(content.size() / 2u, 1000u));
+
+        assert(zip::AccessIndex::Deserialize({ bytes.data(), bytes.size() - 1u }).Error() == zip::Err::BadData);
+
+        auto badMagic = bytes;
+        badMagic[0] ^= 1u;
+        assert(zip::AccessIndex::Deserialize(badMagic).Error() == zip::Err::Unsupported);
+    }
+
+    //
+    // per entry: the index is built on first use, and rebuilt when it
+    // belongs to some other member
+    //
+    {
+        const auto compressed = Deflate(content, 6, Z_DEFAULT_STRATEGY);
+
+        zip::AccessIndex index;
+        assert(!index.IsBuilt());
+
+        std::string out(100u, '\0');
+        utils::WrBuf_t dst{ (unsigned char*)out.data(), out.size() };
+
+        const uint64_t tail = content.size() - out.size();
+
+        assert(zip::ReadRange(8u, compressed, content.size(), crc, index, tail, dst) == zip::Err::None);
+        assert(index.IsBuilt());
+        assert(out == content.substr(tail));
+
+        assert(zip::ReadRange(8u, compressed, content.size(), crc, index, 0u, dst) == zip::Err::None);
+        assert(out == content.substr(0u, out.size()));
+
+        const auto other        = Deflate(content.substr(1u), 6, Z_DEFAULT_STRATEGY);
+        const uint32_t otherCrc = crc32(0u, (const Bytef*)content.data() + 1u, content.size() - 1u);
+
+        assert(zip::ReadRange(8u, other, content.size() - 1u, otherCrc, index, 0u, dst) == zip::Err::None);
+        assert(out == content.substr(1u, out.size()));
+        assert(index.Matches(other.size(), content.size() - 1u, otherCrc));
+
+        zip::AccessIndex fresh;
+        assert(zip::ReadRange(8u, compressed, content.size(), crc ^ 1u, fresh, 0u, dst) == zip::Err::BadCrc);
+        assert(zip::ReadRange(8u, compressed, content.size() + 1u, crc, fresh, 0u, dst) == zip::Err::SizeMismatch);
+
+        const utils::RdBuf_t stored{ (const unsigned char*)content.data(), content.size() };
+        assert(zip::ReadRange(0u, stored, content.size(), crc, fresh, 7u, dst) == zip::Err::None);
+        assert(out == content.substr(7u, out.size()));
+        assert(zip::ReadRange(0u, stored, content.size(), crc, fresh, tail + 1u, dst) == zip::Err::SizeMismatch);
+
+        auto damaged = compressed;
+        damaged[damaged.size() / 2u] ^= 0x10u;
+        assert(zip::ReadRange(8u, damaged, content.size(), crc, fresh, 0u, dst) != zip::Err::None);
+    }
+}
@@ -0,0 +1,202 @@
+#include "zip/Archive.hpp"
+#include "tests/Content.hpp"
+#include "tests/ZipBuilder.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+std::string
+AsString(const std::vector<unsigned char>& V)
+{
+    return { (const char*)V.data(), V.size() };
+}
+
+}
+
+int
+main()
+{
+    for (const char* fname : { "assets/test1-pyzip.zip", "assets/test3-zipcmd.zip", "assets/test5-zstd.zip" })
+    {
+        zip::Archive archive{ fname };
+        assert(archive.IsMapped());
+        assert(archive.IsValid());
+        assert(archive.CDirs().size() == 1u);
+
+        std::vector<std::string> names;
+        assert(archive.ForEachEntry(
+            [&names](const zip::CDFHeader& cdfh, const zip::LFHeader&, utils::RdBuf_t)
+            {
+                names.emplace_back(utils::AsPlainStringView(cdfh.name));
+                return true;
+            }
+        ));
+
+        const std::string prefix = std::string_view{ fname } == "assets/test3-zipcmd.zip" ? "zz/" : "";
+        assert(std::find(names.begin(), names.end(), prefix + "two.txt") != names.end());
+
+        auto e = archive.Find(prefix + "two.txt");
+        assert(e);
+        assert(utils::AsPlainStringView(e->lfh.name) == prefix + "two.txt");
+        assert(e->fileBuf.size() == e->cdfh.compressedSz);
+
+        auto data = archive.Extract(*e);
+        assert(data.HasValue());
+        assert(AsString(data.Value()) == "this is another test content2 - 1\n");
+
+        assert(!archive.Find("two.tx"));
+        assert(!archive.Find(prefix + "two.txt/"));
+
+        //
+        // the walk stops as soon as the callback says so
+        //
+        size_t visited = 0u;
+        assert(!archive.ForEachEntry(
+            [&visited](const zip::CDFHeader&, const zip::LFHeader&, utils::RdBuf_t)
+            {
+                return ++visited < 2u;
+            }
+        ));
+        assert(visited == 2u);
+
+        //
+        // same thing over memory the caller owns
+        //
+        zip::Archive inMemory{ archive.Buffer() };
+        assert(inMemory.IsValid());
+        assert(!inMemory.File().IsValid());
+
+        auto again = inMemory.Find(prefix + "two.txt");
+        assert(again && again->fileBuf.data() == e->fileBuf.data());
+    }
+
+    {
+        zip::Archive missing{ "assets/no-such-file.zip" };
+        assert(!missing.IsMapped());
+        assert(!missing.IsValid());
+        assert(!missing.Find("one.txt"));
+
+        const unsigned char junk[] = "not a zip file, no end of central directory in here";
+        zip::Archive notZip{ utils::RdBuf_t{ junk, sizeof junk } };
+        assert(notZip.IsMapped());
+        assert(!notZip.IsValid());
+    }
+
+    //
+    // listing reads the central directory only: it is unaffected by every
+    // local header being wiped, which only shows once an entry is resolved
+    //
+    for (const char* fname : { "assets/test3-zipcmd.zip", "assets/test4-zip64cmd.zip" })
+    {
+        zip::Archive archive{ fname };
+
+        std::vector<std::string> names;
+        archive.ForEachEntry(
+            [&names](const zip::CDFHeader& cdfh, const zip::LFHeader&, utils::RdBuf_t)
+            {
+                names.emplace_back(utils::AsPlainStringView(cdfh.name));
+                return true;
+            }
+        );
+
+        std::vector<unsigned char> copy(archive.Buffer().begin(), archive.Buffer().end());
+        std::fill_n(copy.begin(), archive.CDirs()[0].eocd.offsetOfCentralDir, 0u);
+        zip::Archive wiped{ utils::RdBuf_t{ copy } };
+
+        std::vector<std::string> listed;
+        assert(wiped.List(
+            [&](const zip::CDFHeader& cdfh, const zip::NameIndex::Hit& Hit)
+            {
+                listed.emplace_back(utils::AsPlainStringView(cdfh.name));
+                assert(!wiped.At(Hit));
+
+                auto e = archive.At(Hit);
+                assert(e && utils::AsPlainStringView(e->cdfh.name) == listed.back() && e->fileBuf.size() == cdfh.compressedSz);
+                return true;
+            }
+        ));
+        assert(listed == names);
+
+        size_t visited = 0u;
+        assert(!wiped.List(
+            [&visited](const zip::CDFHeader&, const zip::NameIndex::Hit&)
+            {
+                return ++visited < 2u;
+            }
+        ));
+        assert(visited == 2u);
+    }
+
+    //
+    // members larger than a local header could ever be: their data goes on
+    // past the span the header is read from
+    //
+    {
+        const std::vector<ZipMember> members = {
+            { "big.bin", MakeContent(300000u, 1u) },
+            { "big.txt", MakeContent(1000000u, 2u), true },
+            { "big-desc.txt", MakeContent(600000u, 3u), true, true },
+        };
+        const BuiltZip built = BuildZip(members);
+
+        zip::Archive archive{ utils::RdBuf_t{ built.zip } };
+        assert(archive.IsValid());
+
+        size_t i = 0u;
+        assert(archive.ForEachEntry(
+            [&](const zip::CDFHeader& cdfh, const zip::LFHeader& lfh, utils::RdBuf_t dataBuf)
+            {
+                assert(cdfh.compressedSz > 128u * 1024u);
+                assert(dataBuf.size() == cdfh.compressedSz);
+
+                auto data = archive.Extract({ cdfh, lfh, dataBuf });
+                assert(data.HasValue() && AsString(data.Value()) == members[i].data);
+
+                i += 1u;
+                return true;
+            }
+        ));
+        assert(i == members.size());
+
+        for (const auto& m : members)
+        {
+            auto e = archive.Find(m.name);
+            assert(e && e->fileBuf.size() == e->cdfh.compressedSz);
+
+            auto data = archive.Extract(*e);
+            assert(data.HasValue() && AsString(data.Value()) == m.data);
+        }
+
+        //
+        // a size that runs into the central directory
+        //
+        std::vector<unsigned char> overlong = built.zip;
+        overlong[built.cdOffset + 22u] = 0xffu;
+
+        zip::Archive bad{ utils::RdBuf_t{ overlong } };
+        assert(bad.IsValid());
+        assert(!bad.Find("big.bin"));
+        assert(bad.Find("big.txt"));
+    }
+
+    //
+    // moving keeps the mapping, and what was found in it, valid
+    //
+    {
+        zip::Archive a{ "assets/test1-pyzip.zip" };
+        auto e = a.Find("one.txt");
+
+        zip::Archive b = std::move(a);
+        assert(b.IsValid());
+
+        auto data = b.Extract(*e);
+        assert(data.HasValue() && AsString(data.Value()) == "this is test content1 - 1\n");
+    }
+}
@@ -0,0 +1,124 @@
+#include "zip/CDIndex.hpp"
+#include "tests/ZipBuilder.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//
+// A zip with an entry of i bytes for name i. Only the central directory
+// matters here, so the data is junk and the method is whatever is asked for.
+//
+std::vector<unsigned char>
+MakeZip(const std::vector<std::string>& Names, const std::vector<uint16_t>& Methods)
+{
+    std::vector<unsigned char> zip;
+    std::vector<unsigned char> cd;
+
+    for (size_t i = 0; i < Names.size(); ++i)
+    {
+        const uint32_t offset = zip.size();
+        const ZipFields f{ 20u, 0u, Methods[i], uint32_t(i * 31u), uint32_t(i), uint32_t(i * 3u) };
+
+        PutLFHeader(zip, f, Names[i]);
+        zip.insert(zip.end(), i, 0xaau);
+        PutCDFHeader(cd, f, Names[i], offset);
+    }
+
+    const uint32_t cdOffset = zip.size();
+    zip.insert(zip.end(), cd.begin(), cd.end());
+    PutEOCDRec(zip, Names.size(), cd.size(), cdOffset);
+
+    return zip;
+}
+
+}
+
+int
+main()
+{
+    //
+    // every count around the scan width, to get the tails of the scans right
+    //
+    for (size_t n : { 0u, 1u, 7u, 8u, 9u, 15u, 16u, 17u, 100u, 5000u })
+    {
+        std::vector<std::string> names;
+        std::vector<uint16_t> methods;
+        for (size_t i = 0; i < n; ++i)
+        {
+            names.push_back(i % 10u == 0u ? "" : "dir/file-" + std::to_string(i));
+            methods.push_back(i % 3u == 0u ? 8u : i % 3u == 1u ? 0u : 93u);
+        }
+
+        const auto buf = MakeZip(names, methods);
+        zip::Archive archive{ utils::RdBuf_t{ buf } };
+        assert(archive.IsValid());
+
+        zip::CDIndex index{ archive };
+        assert(index.Size() == n);
+
+        size_t i = 0;
+        uint64_t original   = 0u;
+        uint64_t compressed = 0u;
+        size_t deflated     = 0u;
+        archive.ForEachEntry(
+            [&](const zip::CDFHeader& cdfh, const zip::LFHeader&, utils::RdBuf_t)
+            {
+                assert(index.Name(i) == utils::AsPlainStringView(cdfh.name));
+                assert(index.LFHOffset(i) == cdfh.offsetOfLFHeader);
+                assert(index.CompressedSz(i) == cdfh.compressedSz);
+                assert(index.OriginalSz(i) == cdfh.originalSz);
+                assert(index.Crc(i) == cdfh.crc32);
+                assert(index.Method(i) == cdfh.compression);
+
+                original += cdfh.originalSz;
+                compressed += cdfh.compressedSz;
+                deflated += cdfh.compression == 8u;
+                ++i;
+                return true;
+            }
+        );
+        assert(i == n);
+
+        assert(index.TotalOriginalSz() == original);
+        assert(index.TotalCompressedSz() == compressed);
+        assert(index.CountMethod(8u) == deflated);
+        assert(index.CountMethod(0u) + index.CountMethod(8u) + index.CountMethod(93u) == n);
+        assert(index.CountMethod(12u) == 0u);
+
+        //
+        // 34 bytes of columns per entry, plus the names
+        //
+        if (n >= 100u)
+        {
+            size_t nameBytes = 0u;
+            for (const auto& name : names)
+            {
+                nameBytes += name.size();
+            }
+
+            assert(index.BytesPerEntry() >= 34.0);
+            assert(index.BytesPerEntry() <= 34.0 + double(nameBytes) / n + 1.0);
+        }
+    }
+
+    {
+        zip::Archive archive{ "assets/test1-pyzip.zip" };
+        zip::CDIndex index{ archive };
+        assert(index.Size() == 3u);
+        assert(index.Name(2u) == "sub/three.txt");
+        assert(index.CountMethod(8u) == 3u);
+        assert(index.TotalOriginalSz() == 26u + 34u + 42u);
+    }
+
+    {
+        zip::CDIndex empty;
+        assert(empty.Size() == 0u);
+        assert(empty.TotalOriginalSz() == 0u);
+        assert(empty.BytesPerEntry() == 0.0);
+    }
+}
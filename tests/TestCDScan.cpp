@@ -0,0 +1,178 @@
+#include "zip/CDIndex.hpp"
+#include "zip/CDScan.hpp"
+#include "tests/ZipBuilder.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//
+// a central directory header with a crc and sizes made up from Offset
+//
+void
+PutRecord(std::vector<unsigned char>& Cd, uint32_t Offset, const std::string& Name, const std::string& Comment, uint16_t DiskNum = 0u)
+{
+    PutCDFHeader(Cd, { 20u, 0u, 8u, Offset * 7u, 0u, Offset }, Name, 0u, Comment, DiskNum);
+}
+
+//
+// Only the central directory matters: a run of empty local headers, then
+// a central directory whose names and comments are full of signatures -
+// stray ones, ones that chain into nowhere, and whole fake records whose
+// length leads exactly onto the next real record.
+//
+std::vector<unsigned char>
+MakeZip(size_t N, size_t BadAt = ~size_t(0u), bool BadSig = true)
+{
+    std::vector<unsigned char> zip(N * 30u, 0u);
+    for (size_t i = 0; i < N; ++i)
+    {
+        zip[i * 30u + 0u] = 0x50u;
+        zip[i * 30u + 1u] = 0x4bu;
+        zip[i * 30u + 2u] = 0x03u;
+        zip[i * 30u + 3u] = 0x04u;
+    }
+
+    std::vector<unsigned char> cd;
+    for (size_t i = 0; i < N; ++i)
+    {
+        std::string name = "dir/file-" + std::to_string(i);
+        std::string comment;
+
+        if (i % 5u == 1u)
+        {
+            name += std::string("PK\x01\x02", 4u);
+        }
+
+        if (i % 7u == 3u)
+        {
+            //
+            // a fake record of the right length, inside the comment
+            //
+            std::vector<unsigned char> fake;
+            PutRecord(fake, 0u, "fake", "");
+            comment = "c" + std::string(fake.begin(), fake.end());
+        }
+
+        if (i % 11u == 4u)
+        {
+            std::vector<unsigned char> fake;
+            PutRecord(fake, 0u, std::string(300u, 'x'), "");
+            comment = std::string(fake.begin(), fake.begin() + 40u);
+        }
+
+        const size_t at = cd.size();
+        PutRecord(cd, uint32_t(i * 30u), name, comment, i == BadAt && !BadSig ? 1u : 0u);
+        if (i == BadAt && BadSig)
+        {
+            cd[at] = 'X';
+        }
+    }
+
+    const uint32_t cdOffset = zip.size();
+    zip.insert(zip.end(), cd.begin(), cd.end());
+
+    PutEOCDRec(zip, N, cd.size(), cdOffset);
+
+    return zip;
+}
+
+std::vector<uint64_t>
+SerialOffsets(const zip::Archive& A)
+{
+    std::vector<uint64_t> offsets;
+    zip::ForEachCDFHeader(
+        A.CDirs()[0],
+        A.Buffer(),
+        [&offsets](const zip::CDFHeader&, uint64_t CdOffset)
+        {
+            offsets.push_back(CdOffset);
+            return true;
+        }
+    );
+    return offsets;
+}
+
+void
+CheckSame(const zip::CDIndex& L, const zip::CDIndex& R)
+{
+    assert(L.Size() == R.Size());
+    for (size_t i = 0; i < L.Size(); ++i)
+    {
+        assert(L.Name(i) == R.Name(i));
+        assert(L.LFHOffset(i) == R.LFHOffset(i));
+        assert(L.CompressedSz(i) == R.CompressedSz(i));
+        assert(L.OriginalSz(i) == R.OriginalSz(i));
+        assert(L.Crc(i) == R.Crc(i));
+        assert(L.Method(i) == R.Method(i));
+    }
+}
+
+}
+
+int
+main()
+{
+    //
+    // every chunk count, so that chunk boundaries fall into names,
+    // comments and fake records alike
+    //
+    for (size_t n : { 0u, 1u, 2u, 50u, 3000u })
+    {
+        const auto buf = MakeZip(n);
+        zip::Archive archive{ utils::RdBuf_t{ buf } };
+        assert(archive.IsValid());
+
+        const auto serial = SerialOffsets(archive);
+        assert(serial.size() == n);
+        assert(zip::ScanCDFHeaders(archive.CDirs()[0], buf) == serial);
+
+        const zip::CDIndex plain{ archive };
+        for (unsigned threads : { 2u, 3u, 4u, 7u, 16u, 61u })
+        {
+            const zip::CDScanConfig config{ 0u, threads, 1u };
+            assert(zip::ScanCDFHeaders(archive.CDirs()[0], buf, config) == serial);
+            CheckSame(zip::CDIndex{ archive, config }, plain);
+        }
+    }
+
+    //
+    // a broken signature ends the scan where it ends the walk, and a
+    // bogus header (found, but not valid) ends the index where it ends the
+    // plain one
+    //
+    for (size_t bad : { 0u, 1u, 1234u, 2999u })
+    {
+        for (bool badSig : { true, false })
+        {
+            const auto buf = MakeZip(3000u, bad, badSig);
+            zip::Archive archive{ utils::RdBuf_t{ buf } };
+
+            const auto serial = SerialOffsets(archive);
+            assert(serial.size() == bad);
+
+            const zip::CDIndex plain{ archive };
+            assert(plain.Size() == bad);
+
+            for (unsigned threads : { 1u, 4u, 9u })
+            {
+                const zip::CDScanConfig config{ 0u, threads, 1u };
+                const auto scanned = zip::ScanCDFHeaders(archive.CDirs()[0], buf, config);
+                assert(scanned.size() == (badSig ? bad : 3000u));
+                assert(std::equal(serial.begin(), serial.end(), scanned.begin()));
+
+                CheckSame(zip::CDIndex{ archive, config }, plain);
+            }
+        }
+    }
+
+    {
+        zip::Archive archive{ "assets/test4-zip64cmd.zip" };
+        const zip::CDScanConfig config{ 0u, 3u, 1u };
+        CheckSame(zip::CDIndex{ archive, config }, zip::CDIndex{ archive });
+    }
+}
@@ -0,0 +1,131 @@
+#include "zip/Codec.hpp"
+#include "zip/Inflate.hpp"
+#include "tests/Content.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+int
+main()
+{
+    const std::string content = MakeContent(200000u);
+    const auto compressed     = Deflate(content);
+    const uint32_t crc        = crc32(0u, (const Bytef*)content.data(), content.size());
+    const utils::RdBuf_t stored{ (const unsigned char*)content.data(), content.size() };
+
+    zip::CodecRegistry r = zip::CodecRegistry::Default();
+
+    assert(r.Find(0u) && std::string_view{ r.Find(0u)->Name } == "stored");
+    assert(r.Find(8u) && std::string_view{ r.Find(8u)->Name } == "zlib");
+    assert(r.Find(8u, "native") && !r.Find(8u, "stored"));
+    assert(r.Find(14u) == nullptr);
+    assert(r.ForMethod(8u).size() == 3u);
+    assert(Has(r.Find(8u, "parallel")->Caps, zip::CodecCaps::Parallel));
+    assert(!Has(r.Find(8u, "native")->Caps, zip::CodecCaps::Streaming));
+
+    //
+    // every backend decodes to the same thing, through whatever it offers
+    //
+    for (uint16_t method : { 0u, 8u })
+    {
+        const utils::RdBuf_t src = method == 0u ? stored : utils::RdBuf_t{ compressed };
+
+        for (const zip::Codec* c : r.ForMethod(method))
+        {
+            assert(c->Method == method);
+            assert(Has(c->Caps, zip::CodecCaps::OneShot) == (c->Decode != nullptr));
+            assert(Has(c->Caps, zip::CodecCaps::Streaming) == (c->Stream != nullptr));
+
+            if (c->Decode)
+            {
+                std::string out(content.size(), '\0');
+                uint32_t outCrc = 0u;
+                assert(c->Decode(src, { (unsigned char*)out.data(), out.size() }, &outCrc) == zip::Err::None);
+                assert(out == content && outCrc == crc);
+            }
+
+            if (c->Stream)
+            {
+                std::string out;
+                auto sink = [&out](utils::RdBuf_t Chunk)
+                {
+                    out.append((const char*)Chunk.data(), Chunk.size());
+                };
+                assert(c->Stream(src, sink) == zip::Err::None);
+                assert(out == content);
+            }
+
+            assert(zip::Verify(*c, src, content.size(), crc) == zip::Err::None);
+            assert(zip::Verify(*c, src, content.size(), crc ^ 1u) == zip::Err::BadCrc);
+            assert(zip::Verify(*c, src, content.size() + 1u, crc) != zip::Err::None);
+        }
+    }
+
+    //
+    // sizes from damaged headers are not allocated for
+    //
+    for (const zip::Codec* c : r.ForMethod(8u))
+    {
+        assert(zip::Verify(*c, compressed, size_t(1u) << 50, crc) != zip::Err::None);
+        assert(zip::Verify(*c, compressed, compressed.size() * zip::DEFLATE_MAX_RATIO - 1u, crc) != zip::Err::None);
+    }
+
+    //
+    // preferences: by name, and by racing the backends
+    //
+    assert(r.Prefer("native"));
+    assert(std::string_view{ r.Find(8u)->Name } == "native");
+    assert(!r.Prefer("no-such-backend"));
+    assert(std::string_view{ r.Find(8u)->Name } == "native");
+
+    const zip::Codec* fastest = r.Calibrate(8u, compressed, content.size(), crc);
+    assert(fastest && fastest == r.Find(8u));
+
+    assert(r.Calibrate(8u, compressed, content.size(), crc ^ 1u) == nullptr);
+    assert(r.Calibrate(8u, compressed, size_t(1u) << 50, crc) == nullptr);
+    assert(r.Find(8u) == fastest);
+
+    //
+    // the copy above left the default registry alone
+    //
+    assert(std::string_view{ zip::CodecRegistry::Default().Find(8u)->Name } == "zlib");
+
+    //
+    // third party backends
+    //
+    zip::Codec upper;
+    upper.Name   = "upper";
+    upper.Method = 99u;
+    upper.Caps   = zip::CodecCaps::OneShot;
+    upper.Decode = [](utils::RdBuf_t Src, utils::WrBuf_t Dst, uint32_t* Crc)
+    {
+        if (Src.size() != Dst.size())
+        {
+            return zip::Err::SizeMismatch;
+        }
+
+        for (size_t i = 0; i < Src.size(); ++i)
+        {
+            Dst[i] = Src[i] >= 'a' && Src[i] <= 'z' ? Src[i] - 32u : Src[i];
+        }
+
+        if (Crc)
+        {
+            *Crc = crc32(0u, Dst.data(), Dst.size());
+        }
+        return zip::Err::None;
+    };
+    r.Register(upper);
+
+    assert(r.Find(99u) && std::string_view{ r.Find(99u)->Name } == "upper");
+
+    unsigned char out[3];
+    assert(r.Find(99u)->Decode({ (const unsigned char*)"abC", 3u }, { out, 3u }, nullptr) == zip::Err::None);
+    assert(std::memcmp(out, "ABC", 3u) == 0);
+}
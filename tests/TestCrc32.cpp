@@ -0,0 +1,102 @@
+#include "utils/Crc32.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+
+uint32_t
+ZlibCrc(const unsigned char* P, size_t N)
+{
+    return crc32(0u, P, N);
+}
+
+}
+
+int
+main()
+{
+    std::vector<unsigned char> buf(3u << 20);
+
+    uint32_t x = 2463534242u;
+    for (auto& c : buf)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        c = uint8_t(x);
+    }
+
+    assert(utils::Crc32(0u, {}) == 0u);
+    assert(utils::Crc32(0u, { (const unsigned char*)"123456789", 9u }) == 0xCBF43926u);
+
+    //
+    // every length around the kernel thresholds, at every alignment
+    //
+    for (size_t off = 0; off < 16u; ++off)
+    {
+        for (size_t len = 0; len <= 300u; ++len)
+        {
+            utils::RdBuf_t in{ buf.data() + off, len };
+
+            uint32_t want = ZlibCrc(in.data(), in.size());
+            assert(utils::Crc32SliceBy16(0u, in) == want);
+            assert(utils::Crc32Clmul(0u, in) == want);
+            assert(utils::Crc32(0u, in) == want);
+        }
+    }
+
+    {
+        uint32_t want = ZlibCrc(buf.data() + 3u, buf.size() - 3u);
+        assert(utils::Crc32SliceBy16(0u, utils::RdBuf_t{ buf }.subspan(3u)) == want);
+        assert(utils::Crc32Clmul(0u, utils::RdBuf_t{ buf }.subspan(3u)) == want);
+    }
+
+    //
+    // chaining, with uneven split points
+    //
+    for (size_t split : { 0u, 1u, 63u, 64u, 65u, 1000u, 4097u })
+    {
+        utils::RdBuf_t all{ buf.data(), 8192u };
+
+        uint32_t want = ZlibCrc(all.data(), all.size());
+        assert(utils::Crc32(utils::Crc32(0u, all.first(split)), all.subspan(split)) == want);
+        assert(utils::Crc32Clmul(utils::Crc32SliceBy16(0u, all.first(split)), all.subspan(split)) == want);
+    }
+
+    for (size_t split : { 0u, 1u, 100u, 65536u, 1000001u })
+    {
+        utils::RdBuf_t all{ buf };
+
+        uint32_t a = utils::Crc32(0u, all.first(split));
+        uint32_t b = utils::Crc32(0u, all.subspan(split));
+        assert(utils::Crc32Combine(a, b, all.size() - split) == crc32_combine(a, b, all.size() - split));
+        assert(utils::Crc32Combine(a, b, all.size() - split) == utils::Crc32(0u, all));
+    }
+
+    assert(utils::Crc32Combine(0x12345678u, 0x9abcdef0u, 1ull << 40) == crc32_combine64(0x12345678u, 0x9abcdef0u, 1ll << 40));
+
+    //
+    // parallel, for uneven sizes and any thread count
+    //
+    for (unsigned threads : { 0u, 1u, 2u, 3u, 7u })
+    {
+        for (size_t len : { 0u, 1000u, 2097152u + 13u, 3145728u })
+        {
+            utils::RdBuf_t in{ buf.data(), len };
+
+            uint32_t want = ZlibCrc(in.data(), in.size());
+            assert(utils::Crc32Parallel(0u, in, { 0u, threads }) == want);
+            assert(utils::Crc32Parallel(utils::Crc32(0u, in), in, { 0u, threads }) == crc32(want, in.data(), in.size()));
+        }
+    }
+
+    assert(
+        utils::Crc32ActiveKernel() == utils::Crc32Kernel::Clmul
+        || utils::Crc32ActiveKernel() == utils::Crc32Kernel::SliceBy16
+    );
+}
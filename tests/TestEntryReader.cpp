@@ -0,0 +1,162 @@
+#include "zip/EntryReader.hpp"
+#include "tests/Content.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+uint32_t
+Crc(const std::string& S)
+{
+    return crc32(0u, (const Bytef*)S.data(), S.size());
+}
+
+//
+// pulls everything through Read() with a buffer of the given size
+//
+zip::Err
+ReadAll(zip::EntryReader& Reader, size_t BufSz, std::string& Out)
+{
+    std::vector<unsigned char> buf(BufSz);
+    while (true)
+    {
+        auto n = Reader.Read({ buf.data(), buf.size() });
+        if (n.HasError())
+        {
+            return n.Error();
+        }
+
+        if (n.Value() == 0u)
+        {
+            return Reader.Done() ? zip::Err::None : zip::Err::BadData;
+        }
+
+        Out.append((const char*)buf.data(), n.Value());
+    }
+}
+
+}
+
+int
+main()
+{
+    for (size_t sz : { 0u, 1u, 1000u, 65536u, 300000u })
+    {
+        const std::string content = MakeContent(sz);
+        const auto compressed     = Deflate(content);
+        const utils::RdBuf_t stored{ (const unsigned char*)content.data(), content.size() };
+
+        for (size_t bufSz : { 1u, 7u, 4096u, 1000000u })
+        {
+            std::string out;
+            zip::EntryReader deflated{ 8u, compressed, content.size(), Crc(content) };
+            assert(ReadAll(deflated, bufSz, out) == zip::Err::None);
+            assert(out == content);
+            assert(deflated.Produced() == content.size());
+
+            out.clear();
+            zip::EntryReader plain{ 0u, stored, content.size(), Crc(content) };
+            assert(ReadAll(plain, bufSz, out) == zip::Err::None);
+            assert(out == content);
+        }
+
+        //
+        // Next(): stored chunks point into the source, deflated ones are
+        // never larger than the configured chunk size
+        //
+        for (uint16_t method : { 0u, 8u })
+        {
+            utils::RdBuf_t src = method == 0u ? stored : utils::RdBuf_t{ compressed };
+            zip::EntryReader reader{ method, src, content.size(), Crc(content), { 1000u } };
+
+            std::string out;
+            while (true)
+            {
+                auto chunk = reader.Next();
+                assert(chunk.HasValue());
+                if (chunk.Value().empty())
+                {
+                    break;
+                }
+
+                assert(chunk.Value().size() <= 1000u);
+                if (method == 0u)
+                {
+                    assert(chunk.Value().data() == stored.data() + out.size());
+                }
+                out.append((const char*)chunk.Value().data(), chunk.Value().size());
+            }
+            assert(out == content);
+            assert(reader.Done());
+        }
+    }
+
+    //
+    // many readers interleaved on one thread, each with its stream suspended
+    //
+    {
+        std::vector<std::string> contents;
+        std::vector<std::vector<unsigned char>> compressed;
+        for (size_t i = 0; i < 16u; ++i)
+        {
+            contents.push_back(MakeContent(50000u + i * 1000u));
+            compressed.push_back(Deflate(contents.back()));
+        }
+
+        std::vector<zip::EntryReader> readers;
+        for (size_t i = 0; i < contents.size(); ++i)
+        {
+            readers.emplace_back(8u, compressed[i], contents[i].size(), Crc(contents[i]));
+        }
+
+        std::vector<std::string> outs(contents.size());
+        for (bool more = true; more;)
+        {
+            more = false;
+            for (size_t i = 0; i < readers.size(); ++i)
+            {
+                unsigned char buf[333];
+                auto n = readers[i].Read({ buf, sizeof buf });
+                assert(n.HasValue());
+                outs[i].append((const char*)buf, n.Value());
+                more |= n.Value() != 0u;
+            }
+        }
+        assert(outs == contents);
+    }
+
+    //
+    // sizes and crc are checked at the end, errors stick
+    //
+    {
+        const std::string content = MakeContent(100000u);
+        const auto compressed     = Deflate(content);
+
+        std::string out;
+        zip::EntryReader badCrc{ 8u, compressed, content.size(), Crc(content) ^ 1u };
+        assert(ReadAll(badCrc, 4096u, out) == zip::Err::BadCrc);
+        assert(badCrc.Read({}).Error() == zip::Err::BadCrc);
+
+        out.clear();
+        zip::EntryReader shorter{ 8u, compressed, content.size() - 1u, Crc(content) };
+        assert(ReadAll(shorter, 4096u, out) == zip::Err::SizeMismatch);
+
+        out.clear();
+        zip::EntryReader longer{ 8u, compressed, content.size() + 1u, Crc(content) };
+        assert(ReadAll(longer, 4096u, out) == zip::Err::SizeMismatch);
+
+        out.clear();
+        zip::EntryReader truncated{ 8u, utils::RdBuf_t{ compressed }.first(compressed.size() / 2u), content.size(), Crc(content) };
+        assert(ReadAll(truncated, 4096u, out) == zip::Err::BadData);
+
+        out.clear();
+        zip::EntryReader unsupported{ 12u, compressed, content.size(), Crc(content) };
+        assert(ReadAll(unsupported, 4096u, out) == zip::Err::Unsupported);
+    }
+}
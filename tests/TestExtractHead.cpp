@@ -0,0 +1,81 @@
+#include "zip/Extract.hpp"
+#include "tests/Content.hpp"
+
+#include <zlib.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+int
+main()
+{
+    const std::string content = MakeContent(300000u);
+    const auto compressed     = Deflate(content);
+    const utils::RdBuf_t stored{ (const unsigned char*)content.data(), content.size() };
+
+    for (uint16_t method : { 0u, 8u })
+    {
+        const utils::RdBuf_t src = method == 0u ? stored : utils::RdBuf_t{ compressed };
+
+        for (size_t n : { 0u, 1u, 100u, 70000u, 300000u, 300001u, 1000000u })
+        {
+            std::vector<unsigned char> buf(n);
+
+            auto got = zip::ExtractHead(method, src, content.size(), { buf.data(), buf.size() });
+            assert(got.HasValue());
+            assert(got.Value() == std::min(n, content.size()));
+            assert(std::memcmp(buf.data(), content.data(), got.Value()) == 0);
+        }
+    }
+
+    //
+    // the rest of the stream is never looked at: a head read still works on
+    // a truncated entry, and with everything past the first pages unreadable
+    //
+    {
+        std::vector<unsigned char> buf(100u);
+
+        auto got = zip::ExtractHead(8u, utils::RdBuf_t{ compressed }.first(compressed.size() / 2u), content.size(), { buf.data(), buf.size() });
+        assert(got.HasValue() && got.Value() == buf.size());
+
+        const size_t page = sysconf(_SC_PAGESIZE);
+        const size_t len  = (compressed.size() + page - 1u) / page * page;
+
+        void* p = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        assert(p != MAP_FAILED);
+
+        std::memcpy(p, compressed.data(), compressed.size());
+        assert(mprotect((unsigned char*)p + 4u * page, len - 4u * page, PROT_NONE) == 0);
+
+        got = zip::ExtractHead(8u, { (const unsigned char*)p, compressed.size() }, content.size(), { buf.data(), buf.size() });
+        assert(got.HasValue() && got.Value() == buf.size());
+        assert(std::memcmp(buf.data(), content.data(), buf.size()) == 0);
+
+        munmap(p, len);
+    }
+
+    //
+    // entries shorter than their headers say, and broken ones
+    //
+    {
+        std::vector<unsigned char> buf(content.size() + 10u);
+
+        auto got = zip::ExtractHead(8u, compressed, content.size() + 10u, { buf.data(), buf.size() });
+        assert(got.HasError() && got.Error() == zip::Err::SizeMismatch);
+
+        got = zip::ExtractHead(8u, utils::RdBuf_t{ compressed }.first(compressed.size() / 2u), content.size(), { buf.data(), buf.size() });
+        assert(got.HasError() && got.Error() == zip::Err::BadData);
+
+        got = zip::ExtractHead(0u, stored.first(10u), content.size(), { buf.data(), buf.size() });
+        assert(got.HasError() && got.Error() == zip::Err::SizeMismatch);
+
+        got = zip::ExtractHead(14u, compressed, content.size(), { buf.data(), buf.size() });
+        assert(got.HasError() && got.Error() == zip::Err::Unsupported);
+    }
+}
@@ -0,0 +1,217 @@
+#include "zip/Archive.hpp"
+#include "zip/GlobalIndex.hpp"
+#include "tests/ZipBuilder.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+//
+// the names of archive K: a manifest in all of them, a few classes shared
+// with its neighbours, and one with a duplicate
+//
+std::vector<std::string>
+NamesOf(size_t K)
+{
+    std::vector<std::string> names{ "META-INF/MANIFEST.MF" };
+    for (size_t i = 0; i < 40u; ++i)
+    {
+        names.push_back("pkg" + std::to_string((K + i) % 13u) + "/Class" + std::to_string(K / 3u + i) + ".class");
+    }
+
+    if (K % 5u == 0u)
+    {
+        names.push_back("META-INF/MANIFEST.MF");
+    }
+
+    return names;
+}
+
+bool
+Has(const std::vector<std::string>& Names, const std::string& Name)
+{
+    for (const auto& n : Names)
+    {
+        if (n == Name)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+}
+
+int
+main()
+{
+    const size_t ARCHIVES = 30u;
+    const char* INDEX     = "tmp_global.gidx";
+
+    std::vector<std::string> paths;
+    for (size_t k = 0; k < ARCHIVES; ++k)
+    {
+        paths.push_back("tmp_global-" + std::to_string(k) + ".zip");
+        WriteFile(paths.back().c_str(), MakeZip(NamesOf(k), k * 1000u));
+    }
+    paths.push_back("no-such-dir/missing.zip");
+
+    assert(zip::GlobalIndex::Write(paths, INDEX, { 1u }) == zip::Err::None);
+    const auto serial = ReadFile(INDEX);
+
+    //
+    // the file does not depend on the order the archives are read in
+    //
+    assert(zip::GlobalIndex::Write(paths, INDEX, { 4u }) == zip::Err::None);
+    assert(ReadFile(INDEX) == serial);
+
+    auto opened = zip::GlobalIndex::Open(INDEX);
+    assert(opened.HasValue());
+    const zip::GlobalIndex& index = opened.Value();
+    assert(index.Archives() == paths.size());
+
+    std::vector<zip::Archive> archives;
+    for (size_t k = 0; k < ARCHIVES; ++k)
+    {
+        assert(index.Path(k) == paths[k]);
+        archives.emplace_back(paths[k].c_str());
+        assert(index.Matches(k, archives.back()));
+    }
+
+    //
+    // every name of every archive, answered the way the archives answer it
+    //
+    for (size_t k = 0; k < ARCHIVES; ++k)
+    {
+        for (const auto& name : NamesOf(k))
+        {
+            assert(index.MayContain(k, name));
+
+            auto hit = index.Find(name, k);
+            assert(hit);
+
+            auto e = archives[k].At(*hit);
+            auto f = archives[k].Find(name);
+            assert(e && f && e->fileBuf == f->fileBuf);
+
+            std::vector<uint32_t> in;
+            assert(index.ForEach(
+                name,
+                [&](const zip::GlobalIndex::Hit& Hit)
+                {
+                    in.push_back(Hit.Archive);
+                    return true;
+                }
+            ));
+
+            std::vector<uint32_t> expected;
+            for (size_t j = 0; j < ARCHIVES; ++j)
+            {
+                if (Has(NamesOf(j), name))
+                {
+                    expected.push_back(uint32_t(j));
+                }
+            }
+            assert(in == expected);
+
+            auto first = index.Find(name);
+            assert(first && first->Archive == expected.front());
+        }
+    }
+
+    //
+    // names that are not there: never found, and rarely let through by
+    // the filters
+    //
+    size_t passed = 0u;
+    size_t asked  = 0u;
+    for (size_t i = 0; i < 2000u; ++i)
+    {
+        const std::string name = "other/Missing" + std::to_string(i) + ".class";
+        assert(!index.Find(name));
+        for (size_t k = 0; k < ARCHIVES; ++k)
+        {
+            passed += index.MayContain(k, name) ? 1u : 0u;
+            asked += 1u;
+            assert(!index.Find(name, k));
+        }
+    }
+    assert(passed * 20u < asked);
+
+    {
+        //
+        // a name of some archives only, asked of the others
+        //
+        const std::string name = NamesOf(0u)[1];
+        for (size_t k = 0; k < ARCHIVES; ++k)
+        {
+            assert(index.Find(name, k).has_value() == Has(NamesOf(k), name));
+        }
+    }
+
+    //
+    // an archive that could not be read has no entries, and matches nothing
+    //
+    assert(index.Path(ARCHIVES) == "no-such-dir/missing.zip");
+    assert(!index.MayContain(ARCHIVES, "META-INF/MANIFEST.MF"));
+    assert(!index.Find("META-INF/MANIFEST.MF", ARCHIVES));
+    assert(!index.Matches(ARCHIVES, archives[0]));
+    assert(!index.Matches(ARCHIVES + 1u, archives[0]));
+    assert(index.Path(ARCHIVES + 1u).empty());
+
+    //
+    // an archive that changed no longer matches, nor does another one
+    //
+    {
+        WriteFile(paths[3].c_str(), MakeZip(NamesOf(3u), 1u));
+        zip::Archive changed{ paths[3].c_str() };
+        assert(!index.Matches(3u, changed));
+        assert(!index.Matches(4u, archives[5]));
+        assert(index.Matches(4u, archives[4]));
+    }
+
+    //
+    // files that are not a global index
+    //
+    {
+        assert(zip::GlobalIndex::Open("no-such-dir/tmp_global.gidx").Error() == zip::Err::Io);
+
+        std::vector<unsigned char> truncated(serial.begin(), serial.begin() + serial.size() / 2u);
+        WriteFile(INDEX, truncated);
+        assert(zip::GlobalIndex::Open(INDEX).Error() == zip::Err::BadData);
+
+        WriteFile(INDEX, std::vector<unsigned char>(64u, 0u));
+        assert(zip::GlobalIndex::Open(INDEX).Error() == zip::Err::BadData);
+
+        std::vector<unsigned char> wrongVersion = serial;
+        wrongVersion[4] += 1u;
+        WriteFile(INDEX, wrongVersion);
+        assert(zip::GlobalIndex::Open(INDEX).Error() == zip::Err::BadData);
+    }
+
+    //
+    // no archives at all
+    //
+    {
+        assert(zip::GlobalIndex::Write({}, INDEX) == zip::Err::None);
+
+        auto empty = zip::GlobalIndex::Open(INDEX);
+        assert(empty.HasValue());
+        assert(empty.Value().Archives() == 0u);
+        assert(!empty.Value().Find("META-INF/MANIFEST.MF"));
+        assert(!empty.Value().MayContain(0u, "META-INF/MANIFEST.MF"));
+    }
+
+    std::remove(INDEX);
+    for (size_t k = 0; k < ARCHIVES; ++k)
+    {
+        std::remove(paths[k].c_str());
+    }
+}
@@ -0,0 +1,205 @@
+#include "zip/Inflate.hpp"
+#include "zip/InflateContext.hpp"
+#include "zip/Extract.hpp"
+#include "zip/Stored.hpp"
+#include "tests/Content.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <string>
+#include <vector>
+
+int
+main()
+{
+    for (size_t sz : { 0u, 1u, 100u, 16384u, 16385u, 1000000u })
+    {
+        const std::string content = MakeContent(sz);
+        const auto compressed     = Deflate(content);
+
+        std::string byByte;
+        int ret = zip::Inflate(
+            compressed,
+            std::function<void(unsigned char)>{ [&byByte](unsigned char c)
+                                                { byByte += char(c); } }
+        );
+        assert(ret == 0);
+        assert(byByte == content);
+
+        std::string byChunk;
+        size_t chunks = 0;
+        ret           = zip::Inflate(
+            compressed,
+            [&byChunk, &chunks](utils::RdBuf_t Chunk)
+            {
+                byChunk.append(reinterpret_cast<const char*>(Chunk.data()), Chunk.size());
+                ++chunks;
+            }
+        );
+        assert(ret == 0);
+        assert(byChunk == content);
+        assert(chunks <= content.size() / 16384u + 1u);
+
+        std::string stored;
+        ret = zip::Stored(
+            utils::RdBuf_t{ reinterpret_cast<const unsigned char*>(content.data()), content.size() },
+            [&stored](utils::RdBuf_t Chunk)
+            {
+                stored.append(reinterpret_cast<const char*>(Chunk.data()), Chunk.size());
+            }
+        );
+        assert(ret == 0);
+        assert(stored == content);
+    }
+
+    const unsigned char garbage[] = { 0xff, 0xff, 0xff, 0xff };
+    int ret                       = zip::Inflate(garbage, [](utils::RdBuf_t) {});
+    assert(ret != 0);
+
+    for (size_t sz : { 0u, 1u, 100u, 1000000u })
+    {
+        const std::string content = MakeContent(sz);
+        const auto compressed     = Deflate(content);
+
+        std::vector<unsigned char> out(sz);
+        assert(zip::InflateInto(compressed, { out.data(), out.size() }) == zip::Err::None);
+        assert(std::string(out.begin(), out.end()) == content);
+
+        std::vector<unsigned char> small(sz + 1u);
+        assert(zip::InflateInto(compressed, { small.data(), sz / 2u }) == (sz ? zip::Err::SizeMismatch : zip::Err::None));
+        assert(zip::InflateInto(compressed, { small.data(), sz + 1u }) == zip::Err::SizeMismatch);
+
+        if (compressed.size() > 2u)
+        {
+            utils::RdBuf_t truncated = utils::RdBuf_t{ compressed }.first(compressed.size() / 2u);
+            assert(zip::InflateInto(truncated, { out.data(), out.size() }) == zip::Err::BadData);
+        }
+
+        auto inflated = zip::ExtractToVector(8u, compressed, sz);
+        assert(inflated.HasValue());
+        assert(std::string(inflated.Value().begin(), inflated.Value().end()) == content);
+
+        auto stored = zip::ExtractToVector(0u, utils::RdBuf_t{ reinterpret_cast<const unsigned char*>(content.data()), sz }, sz);
+        assert(stored.HasValue());
+        assert(std::string(stored.Value().begin(), stored.Value().end()) == content);
+
+        auto mismatched = zip::ExtractToVector(8u, compressed, sz + 10u);
+        assert(mismatched.HasError() && mismatched.Error() == zip::Err::SizeMismatch);
+
+        //
+        // sizes from the headers that the data cannot have are turned down
+        // before anything is allocated for them
+        //
+        const utils::RdBuf_t contentBuf{ reinterpret_cast<const unsigned char*>(content.data()), sz };
+        assert(zip::ExtractToVector(0u, contentBuf, size_t(1u) << 50).Error() == zip::Err::SizeMismatch);
+        assert(zip::ExtractToVector(8u, compressed, size_t(1u) << 50).Error() == zip::Err::SizeMismatch);
+        assert(zip::ExtractToVector(8u, compressed, size_t(1u) << 50, zip::InflateBackend::Parallel).Error() == zip::Err::SizeMismatch);
+        assert(zip::CheckOriginalSz(8u, compressed, compressed.size() * zip::DEFLATE_MAX_RATIO) == zip::Err::None);
+        assert(zip::CheckOriginalSz(8u, compressed, (compressed.size() + 1u) * zip::DEFLATE_MAX_RATIO) == zip::Err::SizeMismatch);
+
+        //
+        // crc computed on the way, by every backend and method
+        //
+        const uint32_t want = crc32(0u, (const Bytef*)content.data(), content.size());
+
+        for (auto backend : { zip::InflateBackend::Zlib, zip::InflateBackend::Native })
+        {
+            uint32_t crc = ~want;
+            assert(zip::InflateInto(compressed, { out.data(), out.size() }, backend, &crc) == zip::Err::None);
+            assert(crc == want);
+
+            crc = ~want;
+            assert(zip::ExtractToVector(0u, utils::RdBuf_t{ reinterpret_cast<const unsigned char*>(content.data()), sz }, sz, backend, &crc).HasValue());
+            assert(crc == want);
+
+            struct
+            {
+                uint16_t compression;
+                size_t originalSz;
+                uint32_t crc32;
+            } hdr{ 8u, sz, want };
+            assert(zip::ExtractToVector(hdr, compressed, backend).HasValue());
+
+            hdr.crc32 = ~want;
+            assert(zip::ExtractToVector(hdr, compressed, backend).Error() == zip::Err::BadCrc);
+        }
+
+        std::string sunk;
+        auto toString = [&sunk](utils::RdBuf_t Chunk)
+        {
+            sunk.append(reinterpret_cast<const char*>(Chunk.data()), Chunk.size());
+        };
+
+        zip::CrcSink crcSink{ toString };
+        assert(zip::Inflate(compressed, crcSink) == 0);
+        assert(crcSink.Crc() == want && sunk == content);
+
+        assert(zip::Verify(0u, contentBuf, sz, want, zip::InflateBackend::Zlib, { 0u, 4u }) == zip::Err::None);
+        assert(zip::Verify(0u, contentBuf, sz, ~want, zip::InflateBackend::Zlib, { 0u, 4u }) == zip::Err::BadCrc);
+        assert(zip::Verify(0u, contentBuf, sz + 1u, want) == zip::Err::SizeMismatch);
+        assert(zip::Verify(8u, compressed, sz, want, zip::InflateBackend::Native) == zip::Err::None);
+        assert(zip::Verify(8u, compressed, sz, ~want) == zip::Err::BadCrc);
+        assert(zip::Verify(8u, compressed, sz, want) == zip::Err::None);
+        assert(zip::Verify(8u, compressed, sz + 1u, want) == zip::Err::SizeMismatch);
+        assert(zip::Verify(8u, compressed, size_t(1u) << 50, want) == zip::Err::SizeMismatch);
+        assert(zip::Verify(8u, compressed, size_t(1u) << 50, want, zip::InflateBackend::Native) == zip::Err::SizeMismatch);
+
+        zip::CrcSink storedCrcSink{ toString };
+        zip::Stored(utils::RdBuf_t{ reinterpret_cast<const unsigned char*>(content.data()), sz }, storedCrcSink);
+        assert(storedCrcSink.Crc() == want);
+    }
+
+    assert(zip::InflateInto(garbage, {}) == zip::Err::BadData);
+    assert(zip::ExtractToVector(12u, garbage, 4u).Error() == zip::Err::Unsupported);
+
+    {
+        zip::InflateContext ctx;
+        assert(ctx.IsValid());
+
+        for (size_t i = 0; i < 1000u; ++i)
+        {
+            const std::string content = MakeContent(i * 37u);
+            const auto compressed     = Deflate(content);
+
+            std::string out;
+            ret = ctx.Inflate(
+                i % 100u == 0u ? utils::RdBuf_t{ garbage } : utils::RdBuf_t{ compressed },
+                [&out](utils::RdBuf_t Chunk)
+                {
+                    out.append(reinterpret_cast<const char*>(Chunk.data()), Chunk.size());
+                }
+            );
+            assert(i % 100u == 0u ? ret != 0 : ret == 0 && out == content);
+        }
+
+        //
+        // a stream cut short is not a success, whatever it produced so far
+        //
+        const auto compressed = Deflate(MakeContent(100000u));
+        ret = ctx.Inflate(
+            utils::RdBuf_t{ compressed.data(), compressed.size() / 2u },
+            [](utils::RdBuf_t) {}
+        );
+        assert(ret != 0);
+
+        assert(ctx.HeapAllocs() == 0u);
+    }
+
+    {
+        auto& pool = zip::InflateContextPool::ThreadLocal();
+        {
+            auto a = pool.Acquire();
+            auto b = pool.Acquire();
+            assert(&*a != &*b);
+        }
+
+        const size_t avail = pool.Available();
+        assert(avail >= 2u);
+        {
+            auto a = pool.Acquire();
+            assert(pool.Available() == avail - 1u);
+        }
+        assert(pool.Available() == avail);
+    }
+}
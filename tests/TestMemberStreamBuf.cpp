@@ -0,0 +1,133 @@
+#include "zip/MemberStreamBuf.hpp"
+#include "tests/Content.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <istream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+uint32_t
+Crc(const std::string& S)
+{
+    return crc32(0u, (const Bytef*)S.data(), S.size());
+}
+
+}
+
+int
+main()
+{
+    //
+    // ending with a newline, for the getline() loop below
+    //
+    std::string content = MakeContent(1000000u);
+    content.back()      = '\n';
+
+    const auto compressed = Deflate(content);
+    const utils::RdBuf_t stored{ (const unsigned char*)content.data(), content.size() };
+
+    for (uint16_t method : { 0u, 8u })
+    {
+        const utils::RdBuf_t src = method == 0u ? stored : utils::RdBuf_t{ compressed };
+
+        //
+        // formatted and line-wise input
+        //
+        {
+            zip::MemberStreamBuf buf{ method, src, content.size(), Crc(content), { 4096u } };
+            std::istream in{ &buf };
+
+            std::string line;
+            std::string all;
+            while (std::getline(in, line))
+            {
+                all += line + "\n";
+            }
+            assert(all == content);
+            assert(buf.Error() == zip::Err::None);
+        }
+
+        //
+        // large reads, which for deflated entries skip the chunk buffer
+        //
+        {
+            zip::MemberStreamBuf buf{ method, src, content.size(), Crc(content), { 4096u } };
+            std::istream in{ &buf };
+
+            std::string head(10u, '\0');
+            in.read(head.data(), head.size());
+            assert(head == content.substr(0u, 10u));
+            assert(in.tellg() == 10);
+
+            std::string rest(content.size(), '\0');
+            in.read(rest.data(), rest.size());
+            assert(size_t(in.gcount()) == content.size() - 10u);
+            assert(rest.substr(0u, content.size() - 10u) == content.substr(10u));
+            assert(in.eof());
+            assert(buf.Error() == zip::Err::None);
+        }
+
+        {
+            zip::MemberStreamBuf buf{ method, src, content.size(), Crc(content) };
+            std::istream in{ &buf };
+
+            std::string all{ std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{} };
+            assert(all == content);
+        }
+
+        //
+        // the crc is checked at the end
+        //
+        {
+            zip::MemberStreamBuf buf{ method, src, content.size(), Crc(content) ^ 1u };
+            std::istream in{ &buf };
+
+            std::string all{ std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{} };
+            assert(buf.Error() == zip::Err::BadCrc);
+        }
+    }
+
+    //
+    // stored entries seek anywhere, deflated ones only tell
+    //
+    {
+        zip::MemberStreamBuf buf{ 0u, stored, content.size(), Crc(content) };
+        std::istream in{ &buf };
+
+        in.seekg(-6, std::ios_base::end);
+        std::string tail(6u, '\0');
+        in.read(tail.data(), tail.size());
+        assert(tail == content.substr(content.size() - 6u));
+
+        in.seekg(100);
+        assert(in.get() == content[100]);
+        assert(in.tellg() == 101);
+    }
+
+    {
+        zip::MemberStreamBuf buf{ 8u, compressed, content.size(), Crc(content) };
+        std::istream in{ &buf };
+
+        in.seekg(100);
+        assert(in.fail());
+    }
+
+    {
+        zip::MemberStreamBuf buf{ 8u, compressed, content.size() + 1u, Crc(content) };
+        std::istream in{ &buf };
+
+        std::string all{ std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{} };
+        assert(buf.Error() == zip::Err::SizeMismatch);
+
+        zip::MemberStreamBuf unsupported{ 14u, compressed, content.size(), Crc(content) };
+        assert(unsupported.Error() == zip::Err::Unsupported);
+        assert(std::istream{ &unsupported }.get() == std::char_traits<char>::eof());
+    }
+}
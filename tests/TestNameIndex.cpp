@@ -0,0 +1,117 @@
+#include "zip/Archive.hpp"
+#include "tests/ZipBuilder.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::string
+Content(const zip::Archive& A, const zip::Entry& E)
+{
+    auto data = A.Extract(E);
+    assert(data.HasValue());
+    return { (const char*)data.Value().data(), data.Value().size() };
+}
+
+}
+
+int
+main()
+{
+    //
+    // names that differ only at the very end, in a table that has to grow
+    // from its initial size a few times along the way
+    //
+    {
+        std::vector<std::string> names;
+        for (size_t i = 0; i < 20000u; ++i)
+        {
+            names.push_back("data/partition=" + std::to_string(i % 7u) + "/part-" + std::to_string(i) + ".csv");
+        }
+
+        const auto buf = MakeZip(names);
+        zip::Archive archive{ utils::RdBuf_t{ buf } };
+        assert(archive.IsValid());
+        assert(archive.Names().Size() == names.size());
+        assert(archive.Names().Bytes() <= 4u * names.size() * 16u);
+
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            auto e = archive.Find(names[i]);
+            assert(e);
+            assert(utils::AsPlainStringView(e->cdfh.name) == names[i]);
+            assert(Content(archive, *e) == std::to_string(i));
+        }
+
+        assert(!archive.Find(""));
+        assert(!archive.Find("data/partition=0/part-0.cs"));
+        assert(!archive.Find("data/partition=0/part-0.csvx"));
+        assert(!archive.Find("data/partition=0/part-1.csv"));
+    }
+
+    //
+    // the table on its own, grown from nothing: every name is found at the
+    // offset it was inserted with, duplicates are refused
+    //
+    {
+        std::vector<std::string> names;
+        for (size_t i = 0; i < 1000u; ++i)
+        {
+            names.push_back("n" + std::to_string(i));
+        }
+
+        const auto buf = MakeZip(names);
+        zip::Archive archive{ utils::RdBuf_t{ buf } };
+
+        zip::NameIndex index{ buf };
+        zip::ForEachCDFHeader(
+            archive.CDirs()[0],
+            buf,
+            [&index](const zip::CDFHeader& Cdfh, uint64_t CdOffset)
+            {
+                assert(index.Insert(utils::AsPlainStringView(Cdfh.name), CdOffset, 3u));
+                assert(!index.Insert(utils::AsPlainStringView(Cdfh.name), CdOffset + 1u));
+                return true;
+            }
+        );
+        assert(index.Size() == names.size());
+
+        for (const auto& n : names)
+        {
+            auto hit = index.Find(n);
+            assert(hit && hit->CDir == 3u);
+            assert(hit->CdOffset == archive.Names().Find(n)->CdOffset);
+        }
+    }
+
+    //
+    // the first of several entries with the same name wins, like a walk of
+    // the central directory would have it
+    //
+    {
+        const auto buf = MakeZip({ "a.txt", "b.txt", "a.txt", "", "dir/" });
+        zip::Archive archive{ utils::RdBuf_t{ buf } };
+        assert(archive.Names().Size() == 4u);
+
+        auto a = archive.Find("a.txt");
+        assert(a && Content(archive, *a) == "0");
+
+        auto empty = archive.Find("");
+        assert(empty && Content(archive, *empty) == "3");
+
+        assert(archive.Find("dir/"));
+        assert(!archive.Find("dir"));
+    }
+
+    {
+        zip::Archive missing{ "assets/no-such-file.zip" };
+        assert(missing.Names().Size() == 0u);
+        assert(!missing.Find("one.txt"));
+    }
+}
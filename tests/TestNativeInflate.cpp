@@ -0,0 +1,210 @@
+#include "zip/Inflate.hpp"
+#include "zip/NativeInflate.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::vector<unsigned char>
+Deflate(const std::string& Src, int Level, int Strategy, int WindowBits, size_t FlushEvery)
+{
+    z_stream strm{};
+    int ret = deflateInit2(&strm, Level, Z_DEFLATED, -WindowBits, 8, Strategy);
+    assert(ret == Z_OK);
+
+    std::vector<unsigned char> dst(deflateBound(&strm, Src.size()) + Src.size() / 8u + 64u);
+    strm.next_out  = dst.data();
+    strm.avail_out = dst.size();
+
+    size_t off = 0u;
+    do
+    {
+        size_t n      = std::min(FlushEvery, Src.size() - off);
+        strm.next_in  = (Bytef*)Src.data() + off;
+        strm.avail_in = n;
+        off += n;
+
+        ret = deflate(&strm, off == Src.size() ? Z_FINISH : Z_SYNC_FLUSH);
+        assert(ret == Z_OK || ret == Z_STREAM_END);
+    } while (ret != Z_STREAM_END);
+
+    dst.resize(strm.total_out);
+    deflateEnd(&strm);
+    return dst;
+}
+
+struct Rng
+{
+    uint32_t
+    operator()()
+    {
+        m_X ^= m_X << 13;
+        m_X ^= m_X >> 17;
+        m_X ^= m_X << 5;
+        return m_X;
+    }
+
+    uint32_t m_X = 2463534242u;
+};
+
+std::vector<std::string>
+Corpus()
+{
+    Rng rng;
+    std::vector<std::string> corpus;
+
+    std::string text;
+    while (text.size() < 300000u)
+    {
+        text += "line " + std::to_string(rng() % 5000u) + " of some moderately repetitive test content\n";
+    }
+    corpus.push_back(text);
+
+    std::string random;
+    while (random.size() < 100000u)
+    {
+        random += char(rng());
+    }
+    corpus.push_back(random);
+
+    std::string runs;
+    while (runs.size() < 200000u)
+    {
+        runs.append(rng() % 600u, char(rng() % 4u));
+    }
+    corpus.push_back(runs);
+
+    std::string periodic;
+    for (size_t period = 1u; period <= 9u; ++period)
+    {
+        for (size_t i = 0; i < 5000u; ++i)
+        {
+            periodic += char('a' + i % period);
+        }
+    }
+    corpus.push_back(periodic);
+
+    std::string binary;
+    while (binary.size() < 200000u)
+    {
+        uint32_t x = rng();
+        if (x % 3u == 0u)
+        {
+            binary += random.substr(x % 1000u, 40u + x % 300u);
+        }
+        else
+        {
+            binary += text.substr(x % 10000u, 20u + x % 100u);
+        }
+    }
+    corpus.push_back(binary);
+
+    corpus.push_back("");
+    corpus.push_back("x");
+    corpus.push_back(std::string(1000000u, '\0'));
+
+    return corpus;
+}
+
+void
+CrossCheck(const std::vector<unsigned char>& Compressed, size_t OriginalSz)
+{
+    std::vector<unsigned char> viaZlib(OriginalSz);
+    std::vector<unsigned char> viaNative(OriginalSz);
+
+    zip::Err z = zip::InflateInto(Compressed, { viaZlib.data(), viaZlib.size() });
+    zip::Err n = zip::NativeInflateInto(Compressed, { viaNative.data(), viaNative.size() });
+
+    assert((z == zip::Err::None) == (n == zip::Err::None));
+    if (z == zip::Err::None)
+    {
+        assert(viaZlib == viaNative);
+    }
+}
+
+}
+
+int
+main()
+{
+    const int strategies[] = { Z_DEFAULT_STRATEGY, Z_FILTERED, Z_HUFFMAN_ONLY, Z_RLE, Z_FIXED };
+
+    for (const std::string& content : Corpus())
+    {
+        for (int level = 0; level <= 9; ++level)
+        {
+            for (int strategy : strategies)
+            {
+                for (int windowBits : { 9, 15 })
+                {
+                    const auto compressed = Deflate(content, level, strategy, windowBits, level == 5 ? 7000u : size_t(-1));
+
+                    std::vector<unsigned char> out(content.size());
+                    uint32_t crc = 0u;
+                    zip::Err e   = zip::NativeInflateInto(compressed, { out.data(), out.size() }, &crc);
+                    assert(e == zip::Err::None);
+                    assert(std::string(out.begin(), out.end()) == content);
+                    assert(crc == crc32(0u, (const Bytef*)content.data(), content.size()));
+
+                    size_t produced = 0u;
+                    size_t consumed = 0u;
+                    std::vector<unsigned char> larger(content.size() + 100u);
+                    e = zip::NativeInflate(compressed, { larger.data(), larger.size() }, produced, consumed);
+                    assert(e == zip::Err::None);
+                    assert(produced == content.size());
+                    assert(consumed == compressed.size());
+
+                    if (!content.empty())
+                    {
+                        e = zip::NativeInflateInto(compressed, { out.data(), out.size() - 1u });
+                        assert(e == zip::Err::SizeMismatch);
+                    }
+
+                    e = zip::NativeInflateInto(compressed, { larger.data(), larger.size() });
+                    assert(e == zip::Err::SizeMismatch);
+
+                    if (compressed.size() > 4u)
+                    {
+                        e = zip::NativeInflateInto(
+                            utils::RdBuf_t{ compressed }.first(compressed.size() - 3u),
+                            { out.data(), out.size() }
+                        );
+                        assert(e != zip::Err::None);
+                    }
+                }
+            }
+        }
+    }
+
+    //
+    // corrupted streams have to be rejected or decoded exactly like zlib does
+    //
+    Rng rng;
+    for (const std::string& content : Corpus())
+    {
+        for (int strategy : strategies)
+        {
+            const auto compressed = Deflate(content, 6, strategy, 15, size_t(-1));
+            if (compressed.size() < 8u)
+            {
+                continue;
+            }
+
+            for (size_t round = 0; round < 40u; ++round)
+            {
+                auto damaged = compressed;
+                for (size_t flips = 1u + rng() % 3u; flips > 0u; --flips)
+                {
+                    damaged[rng() % std::min<size_t>(damaged.size(), 512u)] ^= uint8_t(1u << (rng() % 8u));
+                }
+                CrossCheck(damaged, content.size());
+            }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+#include "zip/ParallelInflate.hpp"
+#include "zip/NativeInflate.hpp"
+#include "tests/Content.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+int
+main()
+{
+    const std::string content = MakeContent(3u << 20);
+    const uint32_t want       = crc32(0u, (const Bytef*)content.data(), content.size());
+
+    for (int level : { 1, 9 })
+    {
+        const auto compressed = Deflate(content, level, Z_DEFAULT_STRATEGY);
+
+        for (unsigned threads : { 3u, 8u })
+        {
+            zip::ParallelInflateConfig config;
+            config.Threads  = threads;
+            config.MinChunk = 64u * 1024u;
+
+            std::vector<unsigned char> out(content.size());
+            uint32_t crc = 0u;
+            zip::ParallelInflateStats stats;
+
+            zip::Err e = zip::ParallelInflateInto(compressed, { out.data(), out.size() }, &crc, config, &stats);
+            assert(e == zip::Err::None);
+            assert(std::string(out.begin(), out.end()) == content);
+            assert(crc == want);
+
+            //
+            // the speculation has to have worked for ordinary zlib output
+            //
+            assert(!stats.Fallback && stats.Chunks > 1u);
+
+            e = zip::ParallelInflateInto(compressed, { out.data(), out.size() - 1u }, nullptr, config);
+            assert(e == zip::Err::SizeMismatch);
+
+            std::vector<unsigned char> larger(content.size() + 1u);
+            e = zip::ParallelInflateInto(compressed, { larger.data(), larger.size() }, nullptr, config);
+            assert(e == zip::Err::SizeMismatch);
+        }
+    }
+
+    //
+    // streams without dynamic blocks give the workers nothing to find, and
+    // damaged streams have to fail just like with the serial decoder
+    //
+    for (int strategy : { Z_FIXED, Z_DEFAULT_STRATEGY })
+    {
+        const auto compressed = Deflate(content, strategy == Z_FIXED ? 6 : 0, strategy);
+
+        zip::ParallelInflateConfig config;
+        config.Threads  = 4u;
+        config.MinChunk = 64u * 1024u;
+
+        std::vector<unsigned char> out(content.size());
+        zip::Err e = zip::ParallelInflateInto(compressed, { out.data(), out.size() }, nullptr, config);
+        assert(e == zip::Err::None);
+        assert(std::string(out.begin(), out.end()) == content);
+    }
+
+    //
+    // a chunk that expands far beyond its share of the output is not kept
+    // in the workers' buffers, the stream is decoded serially instead
+    //
+    {
+        const std::string skewed = content + std::string(32u << 20, 'a');
+        const auto compressed    = Deflate(skewed, 6, Z_DEFAULT_STRATEGY);
+
+        zip::ParallelInflateConfig config;
+        config.Threads  = 4u;
+        config.MinChunk = 64u * 1024u;
+
+        std::vector<unsigned char> out(skewed.size());
+        zip::ParallelInflateStats stats;
+
+        zip::Err e = zip::ParallelInflateInto(compressed, { out.data(), out.size() }, nullptr, config, &stats);
+        assert(e == zip::Err::None);
+        assert(std::string(out.begin(), out.end()) == skewed);
+        assert(stats.Fallback);
+    }
+
+    {
+        auto damaged = Deflate(content, 6, Z_DEFAULT_STRATEGY);
+        damaged[damaged.size() / 2u] ^= 0x10u;
+
+        zip::ParallelInflateConfig config;
+        config.Threads  = 4u;
+        config.MinChunk = 64u * 1024u;
+
+        std::vector<unsigned char> viaParallel(content.size());
+        std::vector<unsigned char> viaSerial(content.size());
+        zip::Err p = zip::ParallelInflateInto(damaged, { viaParallel.data(), viaParallel.size() }, nullptr, config);
+        zip::Err s = zip::NativeInflateInto(damaged, { viaSerial.data(), viaSerial.size() });
+        assert(p == s);
+    }
+}
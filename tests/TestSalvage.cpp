@@ -0,0 +1,171 @@
+#include "zip/Salvage.hpp"
+#include "zip/Inflate.hpp"
+#include "utils/AsPlainStringView.hpp"
+#include "tests/Content.hpp"
+#include "tests/ZipBuilder.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+std::string
+Decoded(const zip::SalvagedEntry& E)
+{
+    std::string out(E.lfh.originalSz, '\0');
+    if (E.lfh.compression == 0u)
+    {
+        out.assign(E.fileBuf.begin(), E.fileBuf.end());
+        assert(crc32(0u, E.fileBuf.data(), E.fileBuf.size()) == E.lfh.crc32);
+        return out;
+    }
+
+    uint32_t crc = 0u;
+    assert(zip::InflateInto(E.fileBuf, { (unsigned char*)out.data(), out.size() }, zip::InflateBackend::Zlib, &crc) == zip::Err::None);
+    assert(crc == E.lfh.crc32);
+    return out;
+}
+
+bool
+Same(const std::vector<zip::SalvagedEntry>& L, const std::vector<zip::SalvagedEntry>& R)
+{
+    if (L.size() != R.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < L.size(); ++i)
+    {
+        if (!(L[i].lfh == R[i].lfh) || L[i].lfhOffset != R[i].lfhOffset || !(L[i].fileBuf == R[i].fileBuf) || L[i].truncated != R[i].truncated)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+int
+main()
+{
+    //
+    // a stored zip as a member: its local headers are inside the data of
+    // the outer one, and not entries of it
+    //
+    const BuiltZip inner = BuildZip({ { "inner/x.txt", "inner x", false }, { "inner/y.txt", MakeContent(3000u, 7u), true } });
+
+    const std::vector<ZipMember> members = {
+        { "a.txt", MakeContent(20000u, 1u), true },
+        { "b.bin", MakeContent(500u, 2u), false },
+        { "c.txt", MakeContent(70000u, 3u), true, true },
+        { "d.bin", MakeContent(900u, 4u), false, true },
+        { "inner.zip", std::string(inner.zip.begin(), inner.zip.end()), false },
+        { "e.txt", MakeContent(5000u, 5u), true, true, false },
+        { "empty", "", false },
+        { "f.txt", MakeContent(100u, 6u), true, true },
+    };
+    const BuiltZip built = BuildZip(members);
+
+    const auto all = zip::Salvage(built.zip);
+    assert(all.size() == members.size());
+    for (size_t i = 0; i < members.size(); ++i)
+    {
+        assert(utils::AsPlainStringView(all[i].lfh.name) == members[i].name);
+        assert(!all[i].truncated);
+        assert(Decoded(all[i]) == members[i].data);
+    }
+
+    for (unsigned threads : { 2u, 3u, 8u })
+    {
+        assert(Same(zip::Salvage(built.zip, { 0u, threads, 1u }), all));
+    }
+
+    //
+    // cut off anywhere: every member that is whole is found whole, and
+    // nothing else is made up
+    //
+    for (size_t cut = 0; cut <= built.zip.size(); cut += 13u)
+    {
+        const utils::RdBuf_t buf = utils::RdBuf_t{ built.zip }.first(cut);
+
+        const auto some = zip::Salvage(buf);
+        assert(Same(zip::Salvage(buf, { 0u, 4u, 1u }), some));
+
+        size_t whole = 0u;
+        while (whole < members.size() && built.ends[whole] <= cut)
+        {
+            ++whole;
+        }
+
+        assert(some.size() >= whole && some.size() <= whole + 1u);
+        for (size_t i = 0; i < some.size(); ++i)
+        {
+            assert(some[i].lfhOffset == all[i].lfhOffset);
+            if (i < whole)
+            {
+                assert(!some[i].truncated);
+                assert(some[i].fileBuf == all[i].fileBuf);
+            }
+            else if (!some[i].truncated)
+            {
+                //
+                // the data is all there, only the descriptor is not
+                //
+                assert(Decoded(some[i]) == members[i].data);
+            }
+        }
+    }
+
+    //
+    // a broken deflate stream behind a descriptor: the entry is there, with
+    // no end, and does not swallow the ones after it
+    //
+    {
+        BuiltZip broken = BuildZip(members);
+        const size_t at = all[2].fileBuf.data() - built.zip.data();
+        for (size_t i = 0; i < 64u; ++i)
+        {
+            broken.zip[at + 100u + i] = 0xffu;
+        }
+
+        const auto some = zip::Salvage(broken.zip);
+        assert(some.size() == members.size());
+        assert(some[2].truncated);
+        assert(some[2].fileBuf.data() + some[2].fileBuf.size() == broken.zip.data() + all[3].lfhOffset);
+        for (size_t i = 3; i < members.size(); ++i)
+        {
+            assert(!some[i].truncated);
+            assert(Decoded(some[i]) == members[i].data);
+        }
+    }
+
+    //
+    // an intact archive salvages to its own entries
+    //
+    {
+        zip::Archive archive{ "assets/test1-pyzip.zip" };
+
+        std::vector<std::string> names;
+        archive.ForEachEntry(
+            [&names](const zip::CDFHeader& cdfh, const zip::LFHeader&, utils::RdBuf_t)
+            {
+                names.emplace_back(utils::AsPlainStringView(cdfh.name));
+                return true;
+            }
+        );
+
+        const auto salvaged = zip::Salvage(archive.Buffer());
+        assert(salvaged.size() == names.size());
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            assert(utils::AsPlainStringView(salvaged[i].lfh.name) == names[i]);
+        }
+    }
+}
@@ -0,0 +1,182 @@
+#include "zip/Archive.hpp"
+#include "zip/SidecarIndex.hpp"
+#include "tests/ZipBuilder.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+std::string
+Content(const zip::Archive& A, std::string_view Name)
+{
+    auto e = A.Find(Name);
+    assert(e);
+
+    auto data = A.Extract(*e);
+    assert(data.HasValue());
+    return { (const char*)data.Value().data(), data.Value().size() };
+}
+
+}
+
+int
+main()
+{
+    const char* ZIP           = "tmp_sidecar.zip";
+    const std::string SIDECAR = zip::SidecarIndex::PathFor(ZIP);
+    assert(SIDECAR == "tmp_sidecar.zip.zidx");
+
+    std::vector<std::string> names;
+    for (size_t i = 0; i < 3000u; ++i)
+    {
+        names.push_back(i % 100u == 0u ? "dir/" + std::to_string(i) + "/" : "dir/" + std::to_string(i % 7u) + "/file-" + std::to_string(i));
+    }
+    names.push_back("dir/1/file-1");
+
+    std::remove(SIDECAR.c_str());
+    WriteFile(ZIP, MakeZip(names));
+
+    //
+    // written on first use, then found the same way as the in memory index
+    //
+    {
+        zip::Archive archive{ ZIP, SIDECAR.c_str() };
+        assert(archive.IsValid());
+        assert(archive.Sidecar() != nullptr);
+        assert(archive.Names().Size() == 0u);
+
+        const zip::SidecarIndex& sidecar = *archive.Sidecar();
+        assert(sidecar.Size() == names.size());
+        assert(sidecar.Matches(archive));
+
+        zip::Archive plain{ ZIP };
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            auto e = archive.Find(names[i]);
+            assert(e);
+            assert(utils::AsPlainStringView(e->cdfh.name) == names[i]);
+            assert(e->cdfh.offsetOfLFHeader == plain.Find(names[i])->cdfh.offsetOfLFHeader);
+
+            assert(sidecar.Name(i) == names[i]);
+            assert(sidecar.OriginalSz(i) == std::to_string(i).size());
+            assert(sidecar.Method(i) == 0u);
+        }
+
+        //
+        // the duplicate at the end loses to the first one
+        //
+        assert(Content(archive, "dir/1/file-1") == "1");
+
+        assert(!archive.Find(""));
+        assert(!archive.Find("dir/0/file-"));
+        assert(!archive.Find("dir/0/file-10"));
+    }
+
+    //
+    // reopened as is, not rewritten
+    //
+    {
+        const auto before = ReadFile(SIDECAR.c_str());
+
+        auto sidecar = zip::SidecarIndex::Open(SIDECAR.c_str());
+        assert(sidecar.HasValue());
+
+        zip::Archive archive{ ZIP, SIDECAR.c_str() };
+        assert(archive.Sidecar() != nullptr);
+        assert(ReadFile(SIDECAR.c_str()) == before);
+        assert(Content(archive, "dir/2/file-2998") == "2998");
+    }
+
+    //
+    // a different archive under the same name: the fingerprint tells, and
+    // the sidecar is rebuilt
+    //
+    {
+        WriteFile(ZIP, MakeZip(names, 1u));
+
+        auto stale = zip::SidecarIndex::Open(SIDECAR.c_str());
+        assert(stale.HasValue());
+        {
+            zip::Archive archive{ ZIP };
+            assert(!stale.Value().Matches(archive));
+        }
+
+        zip::Archive archive{ ZIP, SIDECAR.c_str() };
+        assert(archive.Sidecar() != nullptr);
+        assert(archive.Sidecar()->Matches(archive));
+        assert(Content(archive, "dir/2/file-2998") == "2999");
+    }
+
+    //
+    // damaged sidecars are refused by Open(), and replaced
+    //
+    {
+        auto good = ReadFile(SIDECAR.c_str());
+
+        auto truncated = good;
+        truncated.resize(truncated.size() - 1u);
+        WriteFile(SIDECAR.c_str(), truncated);
+        assert(zip::SidecarIndex::Open(SIDECAR.c_str()).Error() == zip::Err::BadData);
+
+        WriteFile(SIDECAR.c_str(), std::vector<unsigned char>(64u, 0u));
+        assert(zip::SidecarIndex::Open(SIDECAR.c_str()).Error() == zip::Err::BadData);
+
+        auto wrongVersion = good;
+        wrongVersion[4] ^= 0xffu;
+        WriteFile(SIDECAR.c_str(), wrongVersion);
+        assert(zip::SidecarIndex::Open(SIDECAR.c_str()).Error() == zip::Err::BadData);
+
+        zip::Archive archive{ ZIP, SIDECAR.c_str() };
+        assert(archive.Sidecar() != nullptr);
+        assert(archive.Find("dir/100/"));
+        assert(ReadFile(SIDECAR.c_str()) == good);
+    }
+
+    //
+    // where no sidecar can be written, the index is built in memory
+    //
+    {
+        zip::Archive archive{ ZIP, "no-such-dir/tmp_sidecar.zip.zidx" };
+        assert(archive.Sidecar() == nullptr);
+        assert(archive.Names().Size() == names.size() - 1u);
+        assert(archive.Find("dir/100/"));
+
+        assert(zip::SidecarIndex::Open("no-such-dir/tmp_sidecar.zip.zidx").Error() == zip::Err::Io);
+    }
+
+    //
+    // the cache directory variant: one file per archive path
+    //
+    {
+        const std::string a = zip::SidecarIndex::PathFor("x/y/data.zip", "/var/cache/zidx");
+        const std::string b = zip::SidecarIndex::PathFor("z/data.zip", "/var/cache/zidx");
+        assert(a.rfind("/var/cache/zidx/data.zip-", 0u) == 0u);
+        assert(a.size() > 5u && a.compare(a.size() - 5u, 5u, ".zidx") == 0);
+        assert(a != b);
+        assert(a == zip::SidecarIndex::PathFor("x/y/data.zip", "/var/cache/zidx"));
+    }
+
+    {
+        const char* EMPTY_ZIP = "tmp_sidecar-empty.zip";
+        WriteFile(EMPTY_ZIP, MakeZip({}));
+
+        zip::Archive archive{ EMPTY_ZIP, "tmp_sidecar-empty.zip.zidx" };
+        assert(archive.Sidecar() != nullptr);
+        assert(archive.Sidecar()->Size() == 0u);
+        assert(!archive.Find("a"));
+
+        std::remove(EMPTY_ZIP);
+        std::remove("tmp_sidecar-empty.zip.zidx");
+    }
+
+    std::remove(ZIP);
+    std::remove(SIDECAR.c_str());
+}
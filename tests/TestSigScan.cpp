@@ -0,0 +1,153 @@
+#include "utils/SigScan.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+
+constexpr utils::SigScanKernel KERNELS[] = {
+    utils::SigScanKernel::Scalar,
+    utils::SigScanKernel::Sse2,
+    utils::SigScanKernel::Avx2,
+};
+
+std::vector<size_t>
+NaiveMatches(utils::RdBuf_t Buf, const utils::Sig_t& Sig)
+{
+    std::vector<size_t> matches;
+    for (size_t i = 0; i + Sig.size() <= Buf.size(); ++i)
+    {
+        if (std::memcmp(Buf.data() + i, Sig.data(), Sig.size()) == 0)
+        {
+            matches.push_back(i);
+        }
+    }
+    return matches;
+}
+
+//
+// every match, by each kernel in both directions, from every start
+//
+void
+Check(utils::RdBuf_t Buf, const utils::Sig_t& Sig)
+{
+    const auto want = NaiveMatches(Buf, Sig);
+
+    for (auto kernel : KERNELS)
+    {
+        for (size_t from = 0; from <= Buf.size() + 1u; ++from)
+        {
+            size_t next = Buf.size();
+            size_t prev = Buf.size();
+            for (size_t m : want)
+            {
+                if (m >= from && next == Buf.size())
+                {
+                    next = m;
+                }
+                if (m < from)
+                {
+                    prev = m;
+                }
+            }
+
+            assert(utils::FindSig(Buf, Sig, from, kernel) == next);
+            assert(utils::RFindSig(Buf, Sig, from, kernel) == prev);
+        }
+    }
+
+    std::vector<size_t> forward;
+    assert(utils::ForEachSig(
+        Buf,
+        Sig,
+        utils::SigScanDir::Forward,
+        [&forward](size_t At)
+        {
+            forward.push_back(At);
+            return true;
+        }
+    ));
+    assert(forward == want);
+
+    std::vector<size_t> backward;
+    utils::ForEachSig(
+        Buf,
+        Sig,
+        utils::SigScanDir::Backward,
+        [&backward](size_t At)
+        {
+            backward.insert(backward.begin(), At);
+            return true;
+        }
+    );
+    assert(backward == want);
+}
+
+}
+
+int
+main()
+{
+    const utils::Sig_t PK{ 'P', 'K', 5u, 6u };
+
+    std::vector<unsigned char> buf(300u);
+
+    uint32_t x = 2463534242u;
+    for (auto& c : buf)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        c = "PK\5\6"[x % 4u]; // many partial matches
+    }
+
+    //
+    // every length, at every alignment, across the vector block sizes
+    //
+    for (size_t off = 0; off < 8u; ++off)
+    {
+        for (size_t len = 0; len <= 100u; ++len)
+        {
+            Check({ buf.data() + off, len }, PK);
+        }
+    }
+    Check(buf, PK);
+
+    //
+    // matches at both ends and overlapping ones
+    //
+    {
+        std::vector<unsigned char> a(70u, 'a');
+        Check(a, { 'a', 'a', 'a', 'a' });
+
+        std::vector<unsigned char> ends(67u, 0u);
+        std::memcpy(ends.data(), PK.data(), 4u);
+        std::memcpy(ends.data() + 63u, PK.data(), 4u);
+        Check(ends, PK);
+    }
+
+    //
+    // stops when told to
+    //
+    {
+        std::vector<unsigned char> a(70u, 'a');
+        size_t calls = 0u;
+        assert(!utils::ForEachSig(
+            a,
+            { 'a', 'a', 'a', 'a' },
+            utils::SigScanDir::Backward,
+            [&calls](size_t At)
+            {
+                assert(At == 66u - calls);
+                return ++calls < 5u;
+            }
+        ));
+        assert(calls == 5u);
+    }
+
+    assert(utils::FindSig({}, PK) == 0u);
+    assert(utils::RFindSig({}, PK, 0u) == 0u);
+}
@@ -0,0 +1,274 @@
+#include "zip/SortedNames.hpp"
+#include "tests/ZipBuilder.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+//
+// the obvious recursive matcher, to check Match() against
+//
+bool
+NaiveMatch(std::string_view G, std::string_view N)
+{
+    if (G.empty())
+    {
+        return N.empty();
+    }
+
+    if (G[0] == '*')
+    {
+        for (size_t k = 0; k <= N.size(); ++k)
+        {
+            if (NaiveMatch(G.substr(1u), N.substr(k)))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    if (N.empty())
+    {
+        return false;
+    }
+
+    if (G[0] == '[')
+    {
+        size_t k = 1u;
+        bool negate = k < G.size() && (G[k] == '!' || G[k] == '^');
+        k += negate;
+        size_t close = G.find(']', k + (k < G.size() && G[k] == ']'));
+        if (close != std::string_view::npos)
+        {
+            bool in = false;
+            for (size_t i = k; i < close; ++i)
+            {
+                if (i + 2u < close && G[i + 1u] == '-')
+                {
+                    in |= (unsigned char)G[i] <= (unsigned char)N[0] && (unsigned char)N[0] <= (unsigned char)G[i + 2u];
+                    i += 2u;
+                }
+                else
+                {
+                    in |= G[i] == N[0];
+                }
+            }
+            return in != negate && NaiveMatch(G.substr(close + 1u), N.substr(1u));
+        }
+    }
+
+    return (G[0] == '?' || G[0] == N[0]) && NaiveMatch(G.substr(1u), N.substr(1u));
+}
+
+}
+
+int
+main()
+{
+    {
+        assert(zip::SortedNames::Match("*.parquet", "data/2026/10/x.parquet"));
+        assert(!zip::SortedNames::Match("*.parquet", "data/2026/10/x.parquet.crc"));
+        assert(zip::SortedNames::Match("data/*/10/*", "data/2026/10/x"));
+        assert(zip::SortedNames::Match("data/20[0-9][0-9]/1?/*.csv", "data/2026/10/a.csv"));
+        assert(!zip::SortedNames::Match("data/20[0-9][0-9]/1?/*.csv", "data/2026/1/a.csv"));
+        assert(zip::SortedNames::Match("[!a]*", "b"));
+        assert(!zip::SortedNames::Match("[!a]*", "abc"));
+        assert(zip::SortedNames::Match("[]]", "]"));
+        assert(zip::SortedNames::Match("a[b", "a[b"));
+        assert(zip::SortedNames::Match("", ""));
+        assert(zip::SortedNames::Match("*", ""));
+        assert(!zip::SortedNames::Match("?", ""));
+        assert(zip::SortedNames::Match("**a**", "bab"));
+        assert(zip::SortedNames::Match("*a*b*c*", "xxaxxbxxcxx"));
+        assert(!zip::SortedNames::Match("*a*b*c*", "xxaxxcxxbxx"));
+
+        const char* globs[] = { "*", "a*", "*b", "?b*", "a?*c", "[ab]*", "[!a-b]?", "*[", "a[b", "[]a]*", "*a*a*", "b*/", "*/*" };
+        const char* names[] = { "", "a", "b", "ab", "abc", "a/b/c", "ba", "[", "a[b", "]x", "aaa", "cc", "b/c/" };
+        for (const char* g : globs)
+        {
+            for (const char* n : names)
+            {
+                assert(zip::SortedNames::Match(g, n) == NaiveMatch(g, n));
+            }
+        }
+    }
+
+    //
+    // prefixes, directories and globs against brute force over the names,
+    // with explicit directory entries for some directories only, and a
+    // name that occurs twice
+    //
+    {
+        std::vector<std::string> names;
+        for (size_t i = 0; i < 2000u; ++i)
+        {
+            const std::string day = std::to_string(1u + i % 28u);
+            names.push_back("data/2026/" + std::to_string(1u + i % 12u) + "/" + day + "/part-" + std::to_string(i) + (i % 3u == 0u ? ".parquet" : ".csv"));
+        }
+        names.push_back("data/2026/10/");
+        names.push_back("data/2026/");
+        names.push_back("data/README");
+        names.push_back(names[0]);
+        names.push_back("top.txt");
+        names.push_back("data-old/x.parquet");
+        names.push_back("");
+
+        const auto buf = MakeZip(names);
+        zip::Archive archive{ utils::RdBuf_t{ buf } };
+        zip::SortedNames sorted{ archive };
+        assert(sorted.Size() == names.size());
+
+        for (size_t r = 1; r < sorted.Size(); ++r)
+        {
+            assert(sorted.Name(r - 1u) <= sorted.Name(r));
+        }
+
+        for (size_t r = 0; r < sorted.Size(); ++r)
+        {
+            assert(sorted.Name(r) == names[sorted.Entry(r)]);
+
+            auto e = archive.At(sorted.Hit(r));
+            assert(e && utils::AsPlainStringView(e->cdfh.name) == sorted.Name(r));
+        }
+
+        for (std::string_view prefix : { "", "data", "data/", "data/2026/10/", "data/2026/10/1", "data/2026/10/1/", "dat", "top.txt", "zzz", "data/2026/1/1/part-0.parquet" })
+        {
+            auto [first, last] = sorted.PrefixRange(prefix);
+
+            size_t n = 0u;
+            for (const auto& name : names)
+            {
+                n += name.compare(0u, prefix.size(), prefix) == 0;
+            }
+            assert(last - first == n);
+
+            for (size_t r = first; r < last; ++r)
+            {
+                assert(sorted.Name(r).substr(0u, prefix.size()) == prefix);
+            }
+        }
+
+        for (std::string_view dir : { "", "data", "data/", "data/2026", "data/2026/10/", "data/2026/1/1", "nothing" })
+        {
+            std::string prefix{ dir };
+            if (!prefix.empty() && prefix.back() != '/')
+            {
+                prefix += '/';
+            }
+
+            std::set<std::pair<std::string, bool>> expected;
+            for (const auto& name : names)
+            {
+                if (name.size() <= prefix.size() || name.compare(0u, prefix.size(), prefix) != 0)
+                {
+                    continue;
+                }
+
+                const std::string rest = name.substr(prefix.size());
+                const size_t slash     = rest.find('/');
+                expected.insert({ rest.substr(0u, slash == std::string::npos ? slash : slash + 1u), slash != std::string::npos });
+            }
+
+            std::vector<std::pair<std::string, bool>> listed;
+            sorted.ForEachInDir(
+                dir,
+                [&listed](std::string_view Child, bool IsDir)
+                {
+                    listed.push_back({ std::string(Child), IsDir });
+                    return true;
+                }
+            );
+
+            assert(std::is_sorted(listed.begin(), listed.end()));
+            assert(listed.size() == expected.size() + (dir == "data/2026/1/1" ? 1u : 0u));
+
+            listed.erase(std::unique(listed.begin(), listed.end()), listed.end());
+            assert(std::equal(listed.begin(), listed.end(), expected.begin(), expected.end()));
+        }
+
+        for (std::string_view glob : { "*.parquet", "data/2026/10/*", "data/2026/1?/2/*.csv", "data/2026/[1-3]/1/part-1*", "*", "top.txt", "top.tx", "data/README", "", "x*" })
+        {
+            std::vector<std::string> expected;
+            for (const auto& name : names)
+            {
+                if (NaiveMatch(glob, name))
+                {
+                    expected.push_back(name);
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+
+            std::vector<std::string> matched;
+            sorted.ForEachMatch(
+                glob,
+                [&](std::string_view Name, const zip::NameIndex::Hit& Hit)
+                {
+                    auto e = archive.At(Hit);
+                    assert(e && utils::AsPlainStringView(e->cdfh.name) == Name);
+                    matched.emplace_back(Name);
+                    return true;
+                }
+            );
+            assert(matched == expected);
+        }
+
+        //
+        // stops when told to
+        //
+        size_t calls = 0u;
+        assert(!sorted.ForEachMatch(
+            "*.csv",
+            [&calls](std::string_view, const zip::NameIndex::Hit&)
+            {
+                return ++calls < 3u;
+            }
+        ));
+        assert(calls == 3u);
+
+        calls = 0u;
+        assert(!sorted.ForEachInDir(
+            "data/2026",
+            [&calls](std::string_view, bool)
+            {
+                return ++calls < 2u;
+            }
+        ));
+        assert(calls == 2u);
+    }
+
+    {
+        zip::Archive archive{ "assets/test1-pyzip.zip" };
+        zip::SortedNames sorted{ archive };
+        assert(sorted.Size() == 3u);
+        assert(sorted.Name(0u) == "one.txt");
+        assert(sorted.Name(1u) == "sub/three.txt");
+        assert(sorted.Name(2u) == "two.txt");
+
+        std::vector<std::string> top;
+        sorted.ForEachInDir(
+            "",
+            [&top](std::string_view Child, bool)
+            {
+                top.emplace_back(Child);
+                return true;
+            }
+        );
+        assert((top == std::vector<std::string>{ "one.txt", "sub/", "two.txt" }));
+    }
+
+    {
+        zip::SortedNames empty;
+        assert(empty.Size() == 0u);
+        assert(empty.PrefixRange("a") == std::make_pair(size_t(0u), size_t(0u)));
+    }
+}
@@ -0,0 +1,331 @@
+#include "zip/StreamReader.hpp"
+#include "zip/Archive.hpp"
+#include "zip/Codec.hpp"
+#include "utils/Crc32.hpp"
+#include "utils/AsPlainStringView.hpp"
+#include "tests/Content.hpp"
+#include "tests/ZipBuilder.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+//
+// Buf in pieces of at most Chunk bytes, the way a pipe hands them out
+//
+zip::StreamSource
+Chunked(utils::RdBuf_t Buf, size_t Chunk)
+{
+    return [Buf, Chunk, at = size_t(0u)](utils::WrBuf_t Dst) mutable -> ssize_t
+    {
+        const size_t n = std::min({ Chunk, Dst.size(), Buf.size() - at });
+        std::memcpy(Dst.data(), Buf.data() + at, n);
+        at += n;
+        return ssize_t(n);
+    };
+}
+
+//
+// a codec that can only decode whole entries, for method 97: every byte
+// of the output twice
+//
+zip::Err
+Undouble(utils::RdBuf_t Src, utils::WrBuf_t Dst, uint32_t* Crc)
+{
+    if (Dst.size() != 2u * Src.size())
+    {
+        return zip::Err::SizeMismatch;
+    }
+
+    for (size_t i = 0; i < Src.size(); ++i)
+    {
+        Dst[2u * i]      = Src[i];
+        Dst[2u * i + 1u] = Src[i];
+    }
+
+    if (Crc)
+    {
+        *Crc = utils::Crc32(0u, { Dst.data(), Dst.size() });
+    }
+
+    return zip::Err::None;
+}
+
+std::vector<unsigned char>
+MakeDoubledZip(const std::vector<std::string>& Halves)
+{
+    std::vector<unsigned char> zip;
+    std::vector<unsigned char> cd;
+
+    for (size_t i = 0; i < Halves.size(); ++i)
+    {
+        std::string data;
+        for (char c : Halves[i])
+        {
+            data += std::string(2u, c);
+        }
+
+        const std::string name = "d" + std::to_string(i);
+        const uint32_t offset  = zip.size();
+
+        ZipFields f;
+        f.method       = 97u;
+        f.crc          = crc32(0u, (const Bytef*)data.data(), data.size());
+        f.compressedSz = Halves[i].size();
+        f.originalSz   = data.size();
+
+        PutLFHeader(zip, f, name);
+        zip.insert(zip.end(), Halves[i].begin(), Halves[i].end());
+        PutCDFHeader(cd, f, name, offset);
+    }
+
+    const uint32_t cdOffset = zip.size();
+    zip.insert(zip.end(), cd.begin(), cd.end());
+    PutEOCDRec(zip, Halves.size(), cd.size(), cdOffset);
+
+    return zip;
+}
+
+struct Streamed
+{
+    std::string name;
+    std::string data;
+    zip::Err err = zip::Err::None;
+};
+
+zip::Err
+StreamAll(zip::StreamSource Source, std::vector<Streamed>& Out, size_t BufferSize = 256u * 1024u)
+{
+    zip::StreamReader reader{ std::move(Source), { BufferSize } };
+    while (reader.Next())
+    {
+        Streamed s;
+        s.name = reader.Entry().name;
+        s.err  = reader.Data(
+            [&s](utils::RdBuf_t Chunk)
+            {
+                s.data.append((const char*)Chunk.data(), Chunk.size());
+            }
+        );
+
+        assert(s.err != zip::Err::None || reader.Entry().originalSz == s.data.size());
+        Out.push_back(std::move(s));
+    }
+
+    return reader.Finish();
+}
+
+}
+
+int
+main()
+{
+    //
+    // stored data that has a descriptor signature in it, followed by sizes
+    // that do not fit: it is data, and not where the entry ends
+    //
+    std::string fakeDesc = MakeContent(300u, 8u);
+    fakeDesc += std::string("PK\x07\x08", 4u) + std::string(12u, '\x01') + MakeContent(200u, 9u);
+
+    const std::vector<ZipMember> members = {
+        { "a.txt", MakeContent(300000u, 1u), true },
+        { "b.bin", MakeContent(500u, 2u), false },
+        { "c.txt", MakeContent(70000u, 3u), true, true },
+        { "d.bin", MakeContent(90000u, 4u), false, true },
+        { "fake.bin", fakeDesc, false, true },
+        { "e.txt", MakeContent(5000u, 5u), true, true, false },
+        { "empty", "", false, true },
+        { "f.txt", MakeContent(100u, 6u), true, true },
+    };
+    const BuiltZip built = BuildZip(members);
+
+    for (size_t chunk : { 1u, 7u, 4096u, 1u << 20 })
+    {
+        std::vector<Streamed> out;
+        assert(StreamAll(Chunked(built.zip, chunk), out, chunk == 1u ? 1u : 256u * 1024u) == zip::Err::None);
+
+        assert(out.size() == members.size());
+        for (size_t i = 0; i < members.size(); ++i)
+        {
+            assert(out[i].name == members[i].name);
+            assert(out[i].err == zip::Err::None);
+            assert(out[i].data == members[i].data);
+        }
+    }
+
+    //
+    // entries that are skipped are still checked against the central
+    // directory
+    //
+    {
+        zip::StreamReader reader{ Chunked(built.zip, 999u) };
+
+        size_t n = 0u;
+        while (reader.Next())
+        {
+            n += 1u;
+        }
+
+        assert(n == members.size());
+        assert(reader.Finish() == zip::Err::None);
+    }
+
+    //
+    // a damaged entry of known size is reported and skipped, the others
+    // are fine
+    //
+    {
+        BuiltZip damaged = built;
+        damaged.zip[30u + members[0].name.size() + 1000u] ^= 0x55u;
+
+        std::vector<Streamed> out;
+        assert(StreamAll(Chunked(damaged.zip, 4096u), out) == zip::Err::None);
+        assert(out.size() == members.size());
+        assert(out[0].err != zip::Err::None);
+        for (size_t i = 1; i < members.size(); ++i)
+        {
+            assert(out[i].err == zip::Err::None);
+            assert(out[i].data == members[i].data);
+        }
+    }
+
+    //
+    // a central directory that disagrees with the entries
+    //
+    {
+        BuiltZip mismatch = built;
+        mismatch.zip[mismatch.cdOffset + 16u] ^= 0x01u;
+
+        std::vector<Streamed> out;
+        assert(StreamAll(Chunked(mismatch.zip, 4096u), out) == zip::Err::BadData);
+        assert(out.size() == members.size());
+    }
+
+    //
+    // a deflate stream that ends before its recorded size: reported, and
+    // the entry after it is still where the header says
+    //
+    {
+        const std::string data = MakeContent(20000u, 7u);
+        const std::string next = MakeContent(3000u, 8u);
+
+        auto packed = Deflate(data);
+        packed.insert(packed.end(), 100u, 0u);
+
+        std::vector<unsigned char> zip;
+        std::vector<unsigned char> cd;
+
+        ZipFields f;
+        f.method       = 8u;
+        f.crc          = crc32(0u, (const Bytef*)data.data(), data.size());
+        f.compressedSz = packed.size();
+        f.originalSz   = data.size();
+
+        PutLFHeader(zip, f, "padded");
+        zip.insert(zip.end(), packed.begin(), packed.end());
+        PutCDFHeader(cd, f, "padded", 0u);
+
+        const uint32_t offset = zip.size();
+
+        f.method       = 0u;
+        f.crc          = crc32(0u, (const Bytef*)next.data(), next.size());
+        f.compressedSz = next.size();
+        f.originalSz   = next.size();
+
+        PutLFHeader(zip, f, "next");
+        zip.insert(zip.end(), next.begin(), next.end());
+        PutCDFHeader(cd, f, "next", offset);
+
+        const uint32_t cdOffset = zip.size();
+        zip.insert(zip.end(), cd.begin(), cd.end());
+        PutEOCDRec(zip, 2u, cd.size(), cdOffset);
+
+        for (size_t chunk : { 7u, 4096u, 1u << 20 })
+        {
+            std::vector<Streamed> out;
+            assert(StreamAll(Chunked(zip, chunk), out) == zip::Err::None);
+            assert(out.size() == 2u);
+            assert(out[0].err == zip::Err::SizeMismatch);
+            assert(out[1].err == zip::Err::None && out[1].data == next);
+        }
+    }
+
+    //
+    // cut off anywhere: never a success
+    //
+    for (size_t cut = 0; cut < built.zip.size(); cut += 997u)
+    {
+        std::vector<Streamed> out;
+        assert(StreamAll(Chunked(utils::RdBuf_t{ built.zip }.first(cut), 4096u), out) != zip::Err::None);
+    }
+
+    //
+    // a codec that cannot stream decodes an entry whole, as long as its
+    // output is no larger than the buffer
+    //
+    {
+        zip::Codec doubled;
+        doubled.Name   = "doubled";
+        doubled.Method = 97u;
+        doubled.Caps   = zip::CodecCaps::OneShot;
+        doubled.Decode = Undouble;
+        zip::CodecRegistry::Default().Register(doubled);
+
+        const std::vector<std::string> halves = { MakeContent(1000u, 1u), MakeContent(150000u, 2u), MakeContent(100000u, 3u) };
+        const auto buf = MakeDoubledZip(halves);
+
+        std::vector<Streamed> out;
+        assert(StreamAll(Chunked(buf, 4096u), out) == zip::Err::None);
+        assert(out.size() == halves.size());
+        assert(out[0].err == zip::Err::None && out[0].data.size() == 2000u);
+        assert(out[1].err == zip::Err::Unsupported && out[1].data.empty());
+        assert(out[2].err == zip::Err::None && out[2].data.size() == 200000u);
+    }
+
+    //
+    // a source that fails
+    //
+    {
+        zip::StreamReader reader{ [](utils::WrBuf_t) -> ssize_t { return -1; } };
+        assert(!reader.Next());
+        assert(reader.Error() == zip::Err::Io);
+        assert(reader.Finish() == zip::Err::Io);
+    }
+
+    //
+    // streamed, the assets have the same entries as they have mapped
+    //
+    for (const char* fname : { "assets/test1-pyzip.zip", "assets/test2-pyzip64.zip", "assets/test3-zipcmd.zip", "assets/test4-zip64cmd.zip", "assets/test5-zstd.zip" })
+    {
+        zip::Archive archive{ fname };
+
+        std::vector<Streamed> out;
+        assert(StreamAll(Chunked(archive.Buffer(), 5u), out) == zip::Err::None);
+
+        size_t i = 0u;
+        archive.ForEachEntry(
+            [&](const zip::CDFHeader& cdfh, const zip::LFHeader& lfh, utils::RdBuf_t dataBuf)
+            {
+                auto data = archive.Extract({ cdfh, lfh, dataBuf });
+                assert(data.HasValue());
+
+                assert(i < out.size());
+                assert(out[i].name == utils::AsPlainStringView(cdfh.name));
+                assert(out[i].err == zip::Err::None);
+                assert(out[i].data == std::string(data.Value().begin(), data.Value().end()));
+
+                i += 1u;
+                return true;
+            }
+        );
+        assert(i == out.size());
+    }
+}
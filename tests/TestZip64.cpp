@@ -0,0 +1,291 @@
+#include "zip/Archive.hpp"
+#include "zip/CDIndex.hpp"
+#include "tests/ZipBuilder.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+constexpr uint64_t SAT16 = 0xffffu;
+constexpr uint64_t SAT32 = 0xffffffffu;
+
+//
+// A zip64 archive with one stored entry per name, whose content is the
+// string in Contents, or its index past the end of it. Every field that can defer to a zip64 structure does: the sizes of
+// the local headers, sizes and offsets in the central directory, and the
+// counts and offsets of the end record. Full is false for an archive whose
+// end record holds the values itself, next to the zip64 one.
+//
+std::vector<unsigned char>
+MakeZip64(const std::vector<std::string>& Names, bool Full = true, const std::vector<std::string>& Contents = {})
+{
+    std::vector<unsigned char> zip;
+    std::vector<unsigned char> cd;
+
+    for (size_t i = 0; i < Names.size(); ++i)
+    {
+        const std::string data = i < Contents.size() ? Contents[i] : std::to_string(i);
+        const uint32_t crc     = crc32(0u, (const Bytef*)data.data(), data.size());
+        const uint64_t offset  = zip.size();
+
+        PutLE(zip, 0x04034b50u, 4u);
+        PutLE(zip, 45u, 2u);
+        PutLE(zip, 0u, 2u);
+        PutLE(zip, 0u, 2u);
+        PutLE(zip, 0u, 4u);
+        PutLE(zip, crc, 4u);
+        PutLE(zip, SAT32, 4u);
+        PutLE(zip, SAT32, 4u);
+        PutLE(zip, Names[i].size(), 2u);
+        PutLE(zip, 20u, 2u);
+        zip.insert(zip.end(), Names[i].begin(), Names[i].end());
+        PutLE(zip, 0x0001u, 2u);
+        PutLE(zip, 16u, 2u);
+        PutLE(zip, data.size(), 8u);
+        PutLE(zip, data.size(), 8u);
+        zip.insert(zip.end(), data.begin(), data.end());
+
+        //
+        // an unrelated extra field record first, to be skipped
+        //
+        PutLE(cd, 0x02014b50u, 4u);
+        PutLE(cd, 45u, 2u);
+        PutLE(cd, 45u, 2u);
+        PutLE(cd, 0u, 2u);
+        PutLE(cd, 0u, 2u);
+        PutLE(cd, 0u, 4u);
+        PutLE(cd, crc, 4u);
+        PutLE(cd, SAT32, 4u);
+        PutLE(cd, data.size(), 4u);
+        PutLE(cd, Names[i].size(), 2u);
+        PutLE(cd, 9u + 20u, 2u);
+        PutLE(cd, 0u, 2u);
+        PutLE(cd, 0u, 2u);
+        PutLE(cd, 0u, 2u);
+        PutLE(cd, 0u, 4u);
+        PutLE(cd, SAT32, 4u);
+        cd.insert(cd.end(), Names[i].begin(), Names[i].end());
+        PutLE(cd, 0x5455u, 2u);
+        PutLE(cd, 5u, 2u);
+        PutLE(cd, 0u, 5u);
+        PutLE(cd, 0x0001u, 2u);
+        PutLE(cd, 16u, 2u);
+        PutLE(cd, data.size(), 8u); // compressed size, the original one is in the header
+        PutLE(cd, offset, 8u);
+    }
+
+    const uint64_t cdOffset = zip.size();
+    zip.insert(zip.end(), cd.begin(), cd.end());
+
+    const uint64_t eocd64Offset = zip.size();
+    PutLE(zip, 0x06064b50u, 4u);
+    PutLE(zip, 44u, 8u);
+    PutLE(zip, 45u, 2u);
+    PutLE(zip, 45u, 2u);
+    PutLE(zip, 0u, 4u);
+    PutLE(zip, 0u, 4u);
+    PutLE(zip, Names.size(), 8u);
+    PutLE(zip, Names.size(), 8u);
+    PutLE(zip, cd.size(), 8u);
+    PutLE(zip, cdOffset, 8u);
+
+    PutLE(zip, 0x07064b50u, 4u);
+    PutLE(zip, 0u, 4u);
+    PutLE(zip, eocd64Offset, 8u);
+    PutLE(zip, 1u, 4u);
+
+    PutLE(zip, 0x06054b50u, 4u);
+    PutLE(zip, 0u, 4u);
+    PutLE(zip, Full ? SAT16 : Names.size(), 2u);
+    PutLE(zip, Full ? SAT16 : Names.size(), 2u);
+    PutLE(zip, Full ? SAT32 : cd.size(), 4u);
+    PutLE(zip, Full ? SAT32 : cdOffset, 4u);
+    PutLE(zip, 0u, 2u);
+
+    return zip;
+}
+
+std::string
+Content(const zip::Archive& A, std::string_view Name)
+{
+    auto e = A.Find(Name);
+    assert(e);
+
+    auto data = A.Extract(*e);
+    assert(data.HasValue());
+    return { (const char*)data.Value().data(), data.Value().size() };
+}
+
+}
+
+int
+main()
+{
+    //
+    // saturated everywhere, and resolved everywhere
+    //
+    for (bool full : { true, false })
+    {
+        const std::vector<std::string> names{ "a.txt", "dir/b.txt", "dir/c.txt" };
+        const auto buf = MakeZip64(names, full);
+
+        zip::Archive archive{ utils::RdBuf_t{ buf } };
+        assert(archive.IsValid());
+        assert(archive.CDirs().size() == 1u);
+
+        const zip::CDir& cdir = archive.CDirs()[0];
+        assert(cdir.eocd64);
+        assert(cdir.eocd.totalEntries == names.size());
+        assert(cdir.eocd.offsetOfCentralDir == cdir.eocd64->offsetOfCentralDir);
+
+        size_t n = 0u;
+        archive.ForEachEntry(
+            [&n](const zip::CDFHeader& cdfh, const zip::LFHeader& lfh, utils::RdBuf_t)
+            {
+                const uint64_t sz = std::to_string(n).size();
+                assert(cdfh.compressedSz == sz && cdfh.originalSz == sz);
+                assert(lfh.compressedSz == sz && lfh.originalSz == sz);
+                assert(cdfh.offsetOfLFHeader < zip::ZIP64_SATURATED);
+                ++n;
+                return true;
+            }
+        );
+        assert(n == names.size());
+
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            assert(Content(archive, names[i]) == std::to_string(i));
+        }
+    }
+
+    //
+    // more entries than the plain end record can count
+    //
+    {
+        std::vector<std::string> names;
+        for (size_t i = 0; i < 70000u; ++i)
+        {
+            names.push_back("f" + std::to_string(i));
+        }
+
+        const auto buf = MakeZip64(names);
+        zip::Archive archive{ utils::RdBuf_t{ buf } };
+        assert(archive.IsValid());
+        assert(archive.CDirs()[0].eocd.totalEntries == 70000u);
+
+        zip::CDIndex index{ archive };
+        assert(index.Size() == names.size());
+        assert(index.Name(69999u) == "f69999");
+        assert(Content(archive, "f69999") == "69999");
+        assert(Content(archive, "f65536") == "65536");
+    }
+
+    //
+    // a member larger than a local header could ever be, with its sizes in
+    // the zip64 extra fields: its data goes on past the span the header is
+    // read from
+    //
+    {
+        const std::vector<std::string> names{ "a.txt", "big.bin", "c.txt" };
+        const std::vector<std::string> contents{ "0", MakeContent(400000u), "2" };
+        const auto buf = MakeZip64(names, true, contents);
+
+        zip::Archive archive{ utils::RdBuf_t{ buf } };
+        assert(archive.IsValid());
+
+        size_t n = 0u;
+        assert(archive.ForEachEntry(
+            [&](const zip::CDFHeader& cdfh, const zip::LFHeader&, utils::RdBuf_t dataBuf)
+            {
+                assert(cdfh.compressedSz == contents[n].size());
+                assert(dataBuf.size() == cdfh.compressedSz);
+                ++n;
+                return true;
+            }
+        ));
+        assert(n == names.size());
+        assert(contents[1].size() > zip::LFHeader::MaxBytes());
+
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            assert(Content(archive, names[i]) == contents[i]);
+        }
+    }
+
+    //
+    // a locator that points at no zip64 end record disqualifies its end
+    // record
+    //
+    {
+        auto buf = MakeZip64({ "a.txt" });
+        buf[buf.size() - 22u - 20u + 8u] ^= 0x01u;
+
+        zip::Archive archive{ utils::RdBuf_t{ buf } };
+        assert(!archive.IsValid());
+    }
+
+    //
+    // the zip64 extra field on its own
+    //
+    {
+        std::vector<unsigned char> ex;
+        PutLE(ex, 0x000au, 2u);
+        PutLE(ex, 4u, 2u);
+        PutLE(ex, 0u, 4u);
+        PutLE(ex, 0x0001u, 2u);
+        PutLE(ex, 16u, 2u);
+        PutLE(ex, 0x123456789u, 8u);
+        PutLE(ex, 0xabcdef012u, 8u);
+
+        uint64_t a = SAT32;
+        uint64_t b = 7u;
+        uint64_t c = SAT32;
+        assert(zip::ReadZip64(ex, { &a, nullptr, &c }));
+        assert(a == 0x123456789u && b == 7u && c == 0xabcdef012u);
+
+        uint64_t d = SAT32;
+        assert(!zip::ReadZip64(ex, { &a, &c, &d }));
+        assert(d == SAT32);
+
+        ex.resize(8u);
+        assert(!zip::ReadZip64(ex, { &d }));
+        assert(!zip::ReadZip64({}, { &d }));
+    }
+
+    //
+    // the zip64 assets, one zip64 in the local headers only, one in the
+    // central directory and the end record
+    //
+    {
+        zip::Archive archive{ "assets/test2-pyzip64.zip" };
+        assert(archive.IsValid());
+        assert(Content(archive, "one.txt").size() == 26u);
+        assert(Content(archive, "sub/three.txt").size() == 42u);
+    }
+
+    {
+        zip::Archive archive{ "assets/test4-zip64cmd.zip" };
+        assert(archive.IsValid());
+        assert(archive.CDirs()[0].eocd64);
+
+        size_t n = 0u;
+        archive.ForEachEntry(
+            [&n](const zip::CDFHeader&, const zip::LFHeader&, utils::RdBuf_t)
+            {
+                ++n;
+                return true;
+            }
+        );
+        assert(n == 5u);
+        assert(Content(archive, "zz/one.txt").size() == 26u);
+        assert(Content(archive, "zz/sub/three.txt").size() == 42u);
+        assert(Content(archive, "zz/sub/").empty());
+    }
+}
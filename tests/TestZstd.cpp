@@ -0,0 +1,219 @@
+#include "zip/Codec.hpp"
+#include "zip/Extract.hpp"
+#include "zip/Zstd.hpp"
+#include "tests/ZipBuilder.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace
+{
+
+//
+// Only the decoder is vendored, so the frames are put together by hand: raw
+// blocks, or RLE blocks for runs of a single byte, with a 1 MB window and no
+// content size. Compressed blocks are covered by assets/test5-zstd.zip.
+//
+std::vector<unsigned char>
+Frame(const std::string& Src, size_t BlockSz = 100000u)
+{
+    std::vector<unsigned char> dst;
+    PutLE(dst, 0xFD2FB528u, 4u); // magic
+    dst.push_back(0x00u);        // frame header descriptor
+    dst.push_back(0x50u);        // window descriptor, 2^20
+
+    size_t off = 0u;
+    do
+    {
+        size_t n  = std::min(Src.size() - off, BlockSz);
+        bool last = off + n == Src.size();
+        bool rle  = n > 1u && Src.find_first_not_of(Src[off], off) >= off + n;
+
+        PutLE(dst, uint32_t(last) | (uint32_t(rle) << 1) | uint32_t(n << 3), 3u);
+        if (rle)
+        {
+            dst.push_back((unsigned char)Src[off]);
+        }
+        else
+        {
+            dst.insert(dst.end(), Src.begin() + off, Src.begin() + off + n);
+        }
+
+        off += n;
+    } while (off < Src.size());
+
+    return dst;
+}
+
+std::string
+MakeFrameContent(size_t Sz)
+{
+    std::string s;
+    for (size_t i = 0; s.size() < Sz; ++i)
+    {
+        s += "frame " + std::to_string(i * 7919 % 1000) + " of zstd content\n";
+        if (i % 100u == 0u)
+        {
+            s += std::string(5000u, 'z');
+        }
+    }
+    s.resize(Sz);
+    return s;
+}
+
+uint32_t
+Crc(const std::string& S)
+{
+    return crc32(0u, (const Bytef*)S.data(), S.size());
+}
+
+std::string
+Stream(utils::RdBuf_t Src, zip::Err& E, size_t& Chunks)
+{
+    std::string out;
+    Chunks = 0u;
+    E      = zip::ZstdDecompress(
+        Src,
+        [&out, &Chunks](utils::RdBuf_t Chunk)
+        {
+            out.append((const char*)Chunk.data(), Chunk.size());
+            ++Chunks;
+        }
+    );
+    return out;
+}
+
+}
+
+int
+main()
+{
+    for (size_t sz : { 0u, 1u, 1000u, 100000u, 1000000u })
+    {
+        const std::string content = MakeFrameContent(sz);
+        const auto frame          = Frame(content);
+
+        std::string out(content.size(), '\0');
+        uint32_t crc = 0u;
+        assert(zip::ZstdDecompressInto(frame, { (unsigned char*)out.data(), out.size() }, &crc) == zip::Err::None);
+        assert(out == content);
+        assert(crc == Crc(content));
+
+        zip::Err e    = zip::Err::BadInit;
+        size_t chunks = 0u;
+        assert(Stream(frame, e, chunks) == content);
+        assert(e == zip::Err::None);
+        assert(sz < 1000000u || chunks > 1u);
+    }
+
+    //
+    // concatenated and skippable frames, as a parallel compressor writes them
+    //
+    {
+        const std::string a = MakeFrameContent(300000u);
+        const std::string b = MakeFrameContent(70000u);
+
+        auto frames = Frame(a);
+        PutLE(frames, 0x184D2A50u, 4u);
+        PutLE(frames, 3u, 4u);
+        PutLE(frames, 0u, 3u);
+        auto fb = Frame(b, 4096u);
+        frames.insert(frames.end(), fb.begin(), fb.end());
+
+        auto out = zip::ExtractToVector(zip::ZSTD_METHOD, frames, a.size() + b.size());
+        assert(out.HasValue());
+        assert(std::string((const char*)out.Value().data(), out.Value().size()) == a + b);
+
+        zip::Err e    = zip::Err::BadInit;
+        size_t chunks = 0u;
+        assert(Stream(frames, e, chunks) == a + b);
+        assert(e == zip::Err::None);
+    }
+
+    //
+    // sizes that disagree with the headers, and broken frames
+    //
+    {
+        const std::string content = MakeFrameContent(200000u);
+        const auto frame          = Frame(content);
+
+        std::vector<unsigned char> out(content.size() + 1u);
+        assert(zip::ZstdDecompressInto(frame, { out.data(), content.size() - 1u }) == zip::Err::SizeMismatch);
+        assert(zip::ZstdDecompressInto(frame, { out.data(), content.size() + 1u }) == zip::Err::SizeMismatch);
+
+        const utils::RdBuf_t truncated = utils::RdBuf_t{ frame }.first(frame.size() / 2u);
+        assert(zip::ZstdDecompressInto(truncated, { out.data(), content.size() }) == zip::Err::BadData);
+
+        zip::Err e    = zip::Err::None;
+        size_t chunks = 0u;
+        Stream(truncated, e, chunks);
+        assert(e == zip::Err::BadData);
+
+        auto bogus = frame;
+        bogus[0]   = 0u;
+        assert(zip::ZstdDecompressInto(bogus, { out.data(), content.size() }) == zip::Err::BadData);
+        Stream(bogus, e, chunks);
+        assert(e == zip::Err::BadData);
+    }
+
+    //
+    // head reads stop early, only the first block needs to be there
+    //
+    {
+        const std::string content = MakeFrameContent(1000000u);
+        const auto frame          = Frame(content);
+
+        std::vector<unsigned char> out(content.size() + 1u);
+        auto got = zip::ExtractHead(zip::ZSTD_METHOD, utils::RdBuf_t{ frame }.first(110000u), content.size(), { out.data(), 100u });
+        assert(got.HasValue() && got.Value() == 100u);
+        assert(std::string((const char*)out.data(), 100u) == content.substr(0u, 100u));
+
+        got = zip::ExtractHead(zip::ZSTD_METHOD, frame, content.size() + 1u, { out.data(), out.size() });
+        assert(got.HasError() && got.Error() == zip::Err::SizeMismatch);
+
+        got = zip::ExtractHead(zip::ZSTD_METHOD, utils::RdBuf_t{ frame }.first(110000u), content.size(), { out.data(), out.size() });
+        assert(got.HasError() && got.Error() == zip::Err::BadData);
+    }
+
+    //
+    // decoding from within a sink, which needs a second context
+    //
+    {
+        const std::string outer = MakeFrameContent(300000u);
+        const std::string inner = MakeFrameContent(1000u);
+        const auto outerFrame   = Frame(outer);
+        const auto innerFrame   = Frame(inner);
+
+        std::string out;
+        zip::Err e = zip::ZstdDecompress(
+            outerFrame,
+            [&](utils::RdBuf_t Chunk)
+            {
+                out.append((const char*)Chunk.data(), Chunk.size());
+
+                std::string nested(inner.size(), '\0');
+                assert(zip::ZstdDecompressInto(innerFrame, { (unsigned char*)nested.data(), nested.size() }) == zip::Err::None);
+                assert(nested == inner);
+            }
+        );
+        assert(e == zip::Err::None);
+        assert(out == outer);
+    }
+
+    {
+        const zip::Codec* c = zip::CodecRegistry::Default().Find(zip::ZSTD_METHOD);
+        assert(c && std::string_view{ c->Name } == "zstd");
+        assert(zip::Has(c->Caps, zip::CodecCaps::OneShot | zip::CodecCaps::Streaming));
+
+        const std::string content = MakeFrameContent(50000u);
+        assert(zip::Verify(*c, Frame(content), content.size(), Crc(content)) == zip::Err::None);
+        assert(zip::Verify(*c, Frame(content), content.size(), Crc(content) ^ 1u) == zip::Err::BadCrc);
+        assert(zip::Verify(zip::ZSTD_METHOD, Frame(content), content.size(), Crc(content)) == zip::Err::None);
+        assert(zip::Verify(zip::ZSTD_METHOD, Frame(content), size_t(1u) << 50, Crc(content)) == zip::Err::SizeMismatch);
+    }
+}
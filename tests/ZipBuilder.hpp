@@ -0,0 +1,186 @@
+#pragma once
+
+#include "tests/Content.hpp"
+
+#include <zlib.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+//
+// Zip archives written by hand, field by field, for the tests to take apart.
+//
+
+inline void
+PutLE(std::vector<unsigned char>& Dst, uint64_t V, size_t N)
+{
+    for (size_t i = 0; i < N; ++i)
+    {
+        Dst.push_back((unsigned char)(V >> (8u * i)));
+    }
+}
+
+//
+// the fields that a local header and its central directory header share
+//
+struct ZipFields
+{
+    uint16_t version      = 20u;
+    uint16_t flags        = 0u;
+    uint16_t method       = 0u;
+    uint32_t crc          = 0u;
+    uint32_t compressedSz = 0u;
+    uint32_t originalSz   = 0u;
+};
+
+inline void
+PutLFHeader(std::vector<unsigned char>& Dst, const ZipFields& F, const std::string& Name)
+{
+    PutLE(Dst, 0x04034b50u, 4u);
+    PutLE(Dst, F.version, 2u);
+    PutLE(Dst, F.flags, 2u);
+    PutLE(Dst, F.method, 2u);
+    PutLE(Dst, 0u, 4u);
+    PutLE(Dst, F.crc, 4u);
+    PutLE(Dst, F.compressedSz, 4u);
+    PutLE(Dst, F.originalSz, 4u);
+    PutLE(Dst, Name.size(), 2u);
+    PutLE(Dst, 0u, 2u);
+    Dst.insert(Dst.end(), Name.begin(), Name.end());
+}
+
+inline void
+PutCDFHeader(std::vector<unsigned char>& Dst, const ZipFields& F, const std::string& Name, uint32_t Offset, const std::string& Comment = "", uint16_t DiskNum = 0u)
+{
+    PutLE(Dst, 0x02014b50u, 4u);
+    PutLE(Dst, F.version, 2u);
+    PutLE(Dst, F.version, 2u);
+    PutLE(Dst, F.flags, 2u);
+    PutLE(Dst, F.method, 2u);
+    PutLE(Dst, 0u, 4u);
+    PutLE(Dst, F.crc, 4u);
+    PutLE(Dst, F.compressedSz, 4u);
+    PutLE(Dst, F.originalSz, 4u);
+    PutLE(Dst, Name.size(), 2u);
+    PutLE(Dst, 0u, 2u);
+    PutLE(Dst, Comment.size(), 2u);
+    PutLE(Dst, DiskNum, 2u);
+    PutLE(Dst, 0u, 2u);
+    PutLE(Dst, 0u, 4u);
+    PutLE(Dst, Offset, 4u);
+    Dst.insert(Dst.end(), Name.begin(), Name.end());
+    Dst.insert(Dst.end(), Comment.begin(), Comment.end());
+}
+
+inline void
+PutEOCDRec(std::vector<unsigned char>& Dst, size_t Entries, size_t CdSize, size_t CdOffset)
+{
+    PutLE(Dst, 0x06054b50u, 4u);
+    PutLE(Dst, 0u, 4u);
+    PutLE(Dst, Entries, 2u);
+    PutLE(Dst, Entries, 2u);
+    PutLE(Dst, CdSize, 4u);
+    PutLE(Dst, CdOffset, 4u);
+    PutLE(Dst, 0u, 2u);
+}
+
+struct ZipMember
+{
+    std::string name;
+    std::string data;
+    bool deflated   = false;
+    bool descriptor = false; // sizes and crc in a data descriptor (flag bit 3)
+    bool descSig    = true;  // the descriptor has its optional signature
+};
+
+struct BuiltZip
+{
+    std::vector<unsigned char> zip;
+    size_t cdOffset = 0u;
+    std::vector<size_t> ends; // where each member ends, its descriptor included
+};
+
+inline BuiltZip
+BuildZip(const std::vector<ZipMember>& Members)
+{
+    BuiltZip b;
+    std::vector<unsigned char> cd;
+
+    for (const auto& m : Members)
+    {
+        const auto packed  = m.deflated ? Deflate(m.data) : std::vector<unsigned char>(m.data.begin(), m.data.end());
+        const uint32_t off = b.zip.size();
+
+        ZipFields f;
+        f.flags        = m.descriptor ? 8u : 0u;
+        f.method       = m.deflated ? 8u : 0u;
+        f.crc          = crc32(0u, (const Bytef*)m.data.data(), m.data.size());
+        f.compressedSz = packed.size();
+        f.originalSz   = m.data.size();
+
+        PutLFHeader(b.zip, m.descriptor ? ZipFields{ f.version, f.flags, f.method } : f, m.name);
+        b.zip.insert(b.zip.end(), packed.begin(), packed.end());
+
+        if (m.descriptor)
+        {
+            if (m.descSig)
+            {
+                PutLE(b.zip, 0x08074b50u, 4u);
+            }
+            PutLE(b.zip, f.crc, 4u);
+            PutLE(b.zip, f.compressedSz, 4u);
+            PutLE(b.zip, f.originalSz, 4u);
+        }
+        b.ends.push_back(b.zip.size());
+
+        PutCDFHeader(cd, f, m.name, off);
+    }
+
+    b.cdOffset = b.zip.size();
+    b.zip.insert(b.zip.end(), cd.begin(), cd.end());
+    PutEOCDRec(b.zip, Members.size(), cd.size(), b.cdOffset);
+
+    return b;
+}
+
+//
+// a zip with one stored entry per name, whose content is its index plus Salt
+//
+inline std::vector<unsigned char>
+MakeZip(const std::vector<std::string>& Names, size_t Salt = 0u)
+{
+    std::vector<ZipMember> members;
+    for (size_t i = 0; i < Names.size(); ++i)
+    {
+        members.push_back({ Names[i], std::to_string(i + Salt) });
+    }
+
+    return BuildZip(members).zip;
+}
+
+inline void
+WriteFile(const char* Path, const std::vector<unsigned char>& Data)
+{
+    FILE* f = std::fopen(Path, "wb");
+    assert(f);
+    [[maybe_unused]] const size_t written = std::fwrite(Data.data(), 1u, Data.size(), f);
+    assert(written == Data.size());
+    std::fclose(f);
+}
+
+inline std::vector<unsigned char>
+ReadFile(const char* Path)
+{
+    std::vector<unsigned char> data;
+    FILE* f = std::fopen(Path, "rb");
+    assert(f);
+    for (int c; (c = std::fgetc(f)) != EOF;)
+    {
+        data.push_back((unsigned char)c);
+    }
+    std::fclose(f);
+    return data;
+}
@@ -0,0 +1,457 @@
+#include "utils/Crc32.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define UTILS_CRC32_X86 1
+#endif
+
+namespace utils::Impl
+{
+
+constexpr uint32_t CRC32_POLY = 0xEDB88320u;
+
+struct Crc32Tables
+{
+    uint32_t T[16][256] = {};
+};
+
+constexpr Crc32Tables
+MakeCrc32Tables()
+{
+    Crc32Tables t{};
+
+    for (uint32_t i = 0; i < 256u; ++i)
+    {
+        uint32_t c = i;
+        for (int k = 0; k < 8; ++k)
+        {
+            c = (c >> 1) ^ ((c & 1u) ? CRC32_POLY : 0u);
+        }
+        t.T[0][i] = c;
+    }
+
+    for (size_t k = 1; k < 16u; ++k)
+    {
+        for (uint32_t i = 0; i < 256u; ++i)
+        {
+            t.T[k][i] = (t.T[k - 1][i] >> 8) ^ t.T[0][t.T[k - 1][i] & 0xFFu];
+        }
+    }
+
+    return t;
+}
+
+constexpr Crc32Tables CRC32_TABLES = MakeCrc32Tables();
+
+inline uint32_t
+LoadLE32(const unsigned char* P)
+{
+    uint32_t v;
+    std::memcpy(&v, P, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap32(v);
+#endif
+    return v;
+}
+
+//
+// Operates on the pre-inverted CRC register, like the kernel below.
+//
+inline uint32_t
+SliceBy16(uint32_t Crc, const unsigned char* P, size_t N)
+{
+    const auto& T = CRC32_TABLES.T;
+
+    while (N >= 16u)
+    {
+        uint32_t w0 = LoadLE32(P) ^ Crc;
+        uint32_t w1 = LoadLE32(P + 4);
+        uint32_t w2 = LoadLE32(P + 8);
+        uint32_t w3 = LoadLE32(P + 12);
+
+        Crc = T[15][w0 & 0xFFu] ^ T[14][(w0 >> 8) & 0xFFu] ^ T[13][(w0 >> 16) & 0xFFu] ^ T[12][w0 >> 24]
+            ^ T[11][w1 & 0xFFu] ^ T[10][(w1 >> 8) & 0xFFu] ^ T[9][(w1 >> 16) & 0xFFu] ^ T[8][w1 >> 24]
+            ^ T[7][w2 & 0xFFu] ^ T[6][(w2 >> 8) & 0xFFu] ^ T[5][(w2 >> 16) & 0xFFu] ^ T[4][w2 >> 24]
+            ^ T[3][w3 & 0xFFu] ^ T[2][(w3 >> 8) & 0xFFu] ^ T[1][(w3 >> 16) & 0xFFu] ^ T[0][w3 >> 24];
+
+        P += 16;
+        N -= 16u;
+    }
+
+    while (N-- > 0u)
+    {
+        Crc = (Crc >> 8) ^ T[0][(Crc ^ *P++) & 0xFFu];
+    }
+
+    return Crc;
+}
+
+#if UTILS_CRC32_X86
+
+//
+// Folding with carry-less multiplication, as described in Intel's "Fast CRC
+// Computation for Generic Polynomials Using PCLMULQDQ Instruction", with the
+// bit-reflected constants for the zip polynomial (the same ones used by the
+// Linux kernel and Chromium's zlib).
+//
+// Requires Len >= 64 and a multiple of 16.
+//
+__attribute__((target("pclmul,sse4.1"))) uint32_t
+FoldClmul(uint32_t Crc, const unsigned char* P, size_t Len)
+{
+    alignas(16) static const uint64_t K1K2[] = { 0x0154442bd4, 0x01c6e41596 };
+    alignas(16) static const uint64_t K3K4[] = { 0x01751997d0, 0x00ccaa009e };
+    alignas(16) static const uint64_t K5K0[] = { 0x0163cd6124, 0x0000000000 };
+    alignas(16) static const uint64_t POLY[] = { 0x01db710641, 0x01f7011641 };
+
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8, y5, y6, y7, y8;
+
+    x1 = _mm_loadu_si128((const __m128i*)(P + 0x00));
+    x2 = _mm_loadu_si128((const __m128i*)(P + 0x10));
+    x3 = _mm_loadu_si128((const __m128i*)(P + 0x20));
+    x4 = _mm_loadu_si128((const __m128i*)(P + 0x30));
+
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(int(Crc)));
+
+    x0 = _mm_load_si128((const __m128i*)K1K2);
+
+    P += 64;
+    Len -= 64u;
+
+    //
+    // fold 4 x 128 bits in parallel
+    //
+    while (Len >= 64u)
+    {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+
+        y5 = _mm_loadu_si128((const __m128i*)(P + 0x00));
+        y6 = _mm_loadu_si128((const __m128i*)(P + 0x10));
+        y7 = _mm_loadu_si128((const __m128i*)(P + 0x20));
+        y8 = _mm_loadu_si128((const __m128i*)(P + 0x30));
+
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), y5);
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), y6);
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), y7);
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), y8);
+
+        P += 64;
+        Len -= 64u;
+    }
+
+    //
+    // fold into 128 bits
+    //
+    x0 = _mm_load_si128((const __m128i*)K3K4);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+
+    //
+    // single folds of the remaining 16 byte blocks
+    //
+    while (Len >= 16u)
+    {
+        x2 = _mm_loadu_si128((const __m128i*)P);
+
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+
+        P += 16;
+        Len -= 16u;
+    }
+
+    //
+    // 128 -> 64 bits
+    //
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+
+    x0 = _mm_loadl_epi64((const __m128i*)K5K0);
+
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    //
+    // Barrett reduction to 32 bits
+    //
+    x0 = _mm_load_si128((const __m128i*)POLY);
+
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return uint32_t(_mm_extract_epi32(x1, 1));
+}
+
+bool
+HasClmul()
+{
+    return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1");
+}
+
+#else
+
+uint32_t
+FoldClmul(uint32_t Crc, const unsigned char*, size_t)
+{
+    return Crc;
+}
+
+bool
+HasClmul()
+{
+    return false;
+}
+
+#endif
+
+uint32_t
+Clmul(uint32_t Crc, const unsigned char* P, size_t N)
+{
+    if (N >= 64u)
+    {
+        size_t n = N & ~size_t(15u);
+        Crc      = FoldClmul(Crc, P, n);
+        P += n;
+        N -= n;
+    }
+
+    return SliceBy16(Crc, P, N);
+}
+
+//
+// Arithmetic on polynomials over GF(2) modulo the crc polynomial, in the
+// reflected representation (x^0 is the top bit) - see zlib's crc32.c.
+//
+constexpr uint32_t
+MultModP(uint32_t A, uint32_t B)
+{
+    uint32_t m = 1u << 31;
+    uint32_t p = 0u;
+    while (true)
+    {
+        if (A & m)
+        {
+            p ^= B;
+            if ((A & (m - 1u)) == 0u)
+            {
+                break;
+            }
+        }
+        m >>= 1;
+        B = (B & 1u) ? (B >> 1) ^ CRC32_POLY : B >> 1;
+    }
+    return p;
+}
+
+struct X2NTable
+{
+    uint32_t T[32] = {};
+};
+
+//
+// T[n] = x^(2^n) mod p
+//
+constexpr X2NTable
+MakeX2NTable()
+{
+    X2NTable t{};
+
+    uint32_t p = 1u << 30; // x^1
+    t.T[0]     = p;
+    for (size_t n = 1; n < 32u; ++n)
+    {
+        t.T[n] = p = MultModP(p, p);
+    }
+
+    return t;
+}
+
+constexpr X2NTable X2N_TABLE = MakeX2NTable();
+
+//
+// x^(N * 2^K) mod p
+//
+constexpr uint32_t
+X2NModP(uint64_t N, unsigned K)
+{
+    uint32_t p = 1u << 31; // x^0
+    while (N)
+    {
+        if (N & 1u)
+        {
+            p = MultModP(X2N_TABLE.T[K & 31u], p);
+        }
+        N >>= 1;
+        K += 1u;
+    }
+    return p;
+}
+
+using KernelFn = uint32_t (*)(uint32_t, const unsigned char*, size_t);
+
+struct Dispatch
+{
+    Dispatch()
+    {
+        if (HasClmul())
+        {
+            Fn     = &Clmul;
+            Kernel = Crc32Kernel::Clmul;
+        }
+    }
+
+    KernelFn Fn        = &SliceBy16;
+    Crc32Kernel Kernel = Crc32Kernel::SliceBy16;
+};
+
+const Dispatch&
+Active()
+{
+    static const Dispatch d;
+    return d;
+}
+
+}
+
+namespace utils
+{
+
+uint32_t
+Crc32(
+    uint32_t Crc,
+    RdBuf_t Buf
+)
+{
+    return ~Impl::Active().Fn(~Crc, Buf.data(), Buf.size());
+}
+
+uint32_t
+Crc32Combine(
+    uint32_t Crc1,
+    uint32_t Crc2,
+    uint64_t Len2
+)
+{
+    return Impl::MultModP(Impl::X2NModP(Len2, 3u), Crc1) ^ Crc2;
+}
+
+uint32_t
+Crc32Parallel(
+    uint32_t Crc,
+    RdBuf_t Buf,
+    const Crc32ParallelConfig& Config
+)
+{
+    //
+    // segments below this are not worth a thread
+    //
+    constexpr size_t MIN_SEGMENT = 1024u * 1024u;
+
+    size_t threads = Config.Threads ? Config.Threads : std::max(1u, std::thread::hardware_concurrency());
+    threads        = std::min(threads, Buf.size() / MIN_SEGMENT);
+
+    if (Buf.size() < Config.Threshold || threads <= 1u)
+    {
+        return Crc32(Crc, Buf);
+    }
+
+    //
+    // cache line aligned segments, the last one takes the remainder
+    //
+    size_t segment = (Buf.size() / threads) & ~size_t(63u);
+
+    std::vector<uint32_t> crcs(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1u);
+
+    for (size_t i = 1; i < threads; ++i)
+    {
+        RdBuf_t part = i + 1u < threads ? Buf.subspan(i * segment, segment) : Buf.subspan(i * segment);
+        workers.emplace_back(
+            [part, &crcs, i]()
+            {
+                crcs[i] = Crc32(0u, part);
+            }
+        );
+    }
+
+    crcs[0] = Crc32(Crc, Buf.first(segment));
+
+    for (auto& w : workers)
+    {
+        w.join();
+    }
+
+    Crc = crcs[0];
+    for (size_t i = 1; i < threads; ++i)
+    {
+        size_t len = i + 1u < threads ? segment : Buf.size() - i * segment;
+        Crc        = Crc32Combine(Crc, crcs[i], len);
+    }
+
+    return Crc;
+}
+
+Crc32Kernel
+Crc32ActiveKernel(
+    void
+)
+{
+    return Impl::Active().Kernel;
+}
+
+uint32_t
+Crc32SliceBy16(
+    uint32_t Crc,
+    RdBuf_t Buf
+)
+{
+    return ~Impl::SliceBy16(~Crc, Buf.data(), Buf.size());
+}
+
+uint32_t
+Crc32Clmul(
+    uint32_t Crc,
+    RdBuf_t Buf
+)
+{
+    if (!Impl::HasClmul())
+    {
+        return Crc32SliceBy16(Crc, Buf);
+    }
+
+    return ~Impl::Clmul(~Crc, Buf.data(), Buf.size());
+}
+
+}
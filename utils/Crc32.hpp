@@ -0,0 +1,91 @@
+#pragma once
+
+#include "utils/RdBuf.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace utils
+{
+
+//
+// CRC-32 as used by zip (and zlib's crc32()): reflected polynomial
+// 0xEDB88320, and the same chaining convention, so that
+//
+//   Crc32(Crc32(0, a), b) == Crc32(0, a + b)
+//
+// The kernel is picked once, at first use, by CPU feature detection:
+// PCLMULQDQ folding where available, slice-by-16 tables otherwise.
+//
+uint32_t
+Crc32(
+    uint32_t Crc,
+    RdBuf_t Buf
+);
+
+//
+// CRC-32 of A + B, given Crc1 = Crc32(0, A), Crc2 = Crc32(0, B) and the
+// length of B - the same operation as zlib's crc32_combine(), computed in
+// O(log Len2) by multiplying with x^(8 * Len2) modulo the polynomial.
+//
+uint32_t
+Crc32Combine(
+    uint32_t Crc1,
+    uint32_t Crc2,
+    uint64_t Len2
+);
+
+struct Crc32ParallelConfig
+{
+    //
+    // buffers shorter than this are checksummed on the calling thread
+    //
+    size_t Threshold = 64u * 1024u * 1024u;
+
+    //
+    // number of threads to split across (the caller included), 0 for
+    // std::thread::hardware_concurrency()
+    //
+    unsigned Threads = 0u;
+};
+
+//
+// Same result as Crc32(), but large buffers are split into segments that are
+// checksummed concurrently and merged with Crc32Combine(). Meant for large
+// mapped data, where one core cannot saturate the memory bandwidth.
+//
+uint32_t
+Crc32Parallel(
+    uint32_t Crc,
+    RdBuf_t Buf,
+    const Crc32ParallelConfig& Config = {}
+);
+
+enum class Crc32Kernel
+{
+    SliceBy16,
+    Clmul,
+};
+
+Crc32Kernel
+Crc32ActiveKernel(
+    void
+);
+
+//
+// The individual kernels, for tests and benchmarks. Crc32Clmul() falls back
+// to slice-by-16 when the CPU lacks PCLMULQDQ/SSE4.1.
+//
+uint32_t
+Crc32SliceBy16(
+    uint32_t Crc,
+    RdBuf_t Buf
+);
+
+uint32_t
+Crc32Clmul(
+    uint32_t Crc,
+    RdBuf_t Buf
+);
+
+}
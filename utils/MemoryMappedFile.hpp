@@ -34,7 +34,9 @@ public:
     {
         MemoryMappedFile tmp = std::move(Rhs);
 
-        using std::swap;
+        //
+        // the member swap() - std::swap() would move assign, i.e. recurse
+        //
         swap(tmp, *this);
 
         return *this;
@@ -0,0 +1,256 @@
+#include "utils/SigScan.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+//
+// SSE2 is part of x86-64, so only AVX2 needs a check at run time
+//
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define UTILS_SIGSCAN_X86 1
+#endif
+
+namespace utils::Impl
+{
+
+//
+// All kernels take P, N with the candidates being the positions i with
+// i + 4 <= N, and return N when nothing matches.
+//
+size_t
+Candidates(size_t N)
+{
+    return N >= 4u ? N - 3u : 0u;
+}
+
+size_t
+FindScalar(const unsigned char* P, size_t N, const Sig_t& Sig, size_t From)
+{
+    const size_t last = Candidates(N);
+
+    while (From < last)
+    {
+        const void* hit = std::memchr(P + From, Sig[0], last - From);
+        if (hit == nullptr)
+        {
+            break;
+        }
+
+        From = size_t(static_cast<const unsigned char*>(hit) - P);
+        if (std::memcmp(P + From, Sig.data(), Sig.size()) == 0)
+        {
+            return From;
+        }
+
+        ++From;
+    }
+
+    return N;
+}
+
+size_t
+RFindScalar(const unsigned char* P, size_t N, const Sig_t& Sig, size_t To)
+{
+    for (size_t i = std::min(To, Candidates(N)); i-- > 0u;)
+    {
+        if (P[i] == Sig[0] && std::memcmp(P + i, Sig.data(), Sig.size()) == 0)
+        {
+            return i;
+        }
+    }
+
+    return N;
+}
+
+#ifdef UTILS_SIGSCAN_X86
+
+//
+// A bit per position of the 16 starting at P, set where all of Sig starts:
+// reads P[0, 19).
+//
+inline unsigned
+MatchMask16(const unsigned char* P, const __m128i (&S)[4])
+{
+    __m128i m = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)P), S[0]);
+    m         = _mm_and_si128(m, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(P + 1u)), S[1]));
+    m         = _mm_and_si128(m, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(P + 2u)), S[2]));
+    m         = _mm_and_si128(m, _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(P + 3u)), S[3]));
+    return unsigned(_mm_movemask_epi8(m));
+}
+
+size_t
+FindSse2(const unsigned char* P, size_t N, const Sig_t& Sig, size_t From)
+{
+    const __m128i s[4] = {
+        _mm_set1_epi8(char(Sig[0])),
+        _mm_set1_epi8(char(Sig[1])),
+        _mm_set1_epi8(char(Sig[2])),
+        _mm_set1_epi8(char(Sig[3])),
+    };
+
+    for (; From + 16u <= Candidates(N); From += 16u)
+    {
+        if (unsigned m = MatchMask16(P + From, s))
+        {
+            return From + unsigned(__builtin_ctz(m));
+        }
+    }
+
+    return FindScalar(P, N, Sig, From);
+}
+
+size_t
+RFindSse2(const unsigned char* P, size_t N, const Sig_t& Sig, size_t To)
+{
+    const __m128i s[4] = {
+        _mm_set1_epi8(char(Sig[0])),
+        _mm_set1_epi8(char(Sig[1])),
+        _mm_set1_epi8(char(Sig[2])),
+        _mm_set1_epi8(char(Sig[3])),
+    };
+
+    for (To = std::min(To, Candidates(N)); To >= 16u; To -= 16u)
+    {
+        if (unsigned m = MatchMask16(P + To - 16u, s))
+        {
+            return To - 16u + 31u - unsigned(__builtin_clz(m));
+        }
+    }
+
+    return RFindScalar(P, N, Sig, To);
+}
+
+__attribute__((target("avx2"))) inline unsigned
+MatchMask32(const unsigned char* P, const __m256i (&S)[4])
+{
+    __m256i m = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)P), S[0]);
+    m         = _mm256_and_si256(m, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(P + 1u)), S[1]));
+    m         = _mm256_and_si256(m, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(P + 2u)), S[2]));
+    m         = _mm256_and_si256(m, _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)(P + 3u)), S[3]));
+    return unsigned(_mm256_movemask_epi8(m));
+}
+
+__attribute__((target("avx2"))) size_t
+FindAvx2(const unsigned char* P, size_t N, const Sig_t& Sig, size_t From)
+{
+    const __m256i s[4] = {
+        _mm256_set1_epi8(char(Sig[0])),
+        _mm256_set1_epi8(char(Sig[1])),
+        _mm256_set1_epi8(char(Sig[2])),
+        _mm256_set1_epi8(char(Sig[3])),
+    };
+
+    for (; From + 32u <= Candidates(N); From += 32u)
+    {
+        if (unsigned m = MatchMask32(P + From, s))
+        {
+            return From + unsigned(__builtin_ctz(m));
+        }
+    }
+
+    return FindSse2(P, N, Sig, From);
+}
+
+__attribute__((target("avx2"))) size_t
+RFindAvx2(const unsigned char* P, size_t N, const Sig_t& Sig, size_t To)
+{
+    const __m256i s[4] = {
+        _mm256_set1_epi8(char(Sig[0])),
+        _mm256_set1_epi8(char(Sig[1])),
+        _mm256_set1_epi8(char(Sig[2])),
+        _mm256_set1_epi8(char(Sig[3])),
+    };
+
+    for (To = std::min(To, Candidates(N)); To >= 32u; To -= 32u)
+    {
+        if (unsigned m = MatchMask32(P + To - 32u, s))
+        {
+            return To - 32u + 31u - unsigned(__builtin_clz(m));
+        }
+    }
+
+    return RFindSse2(P, N, Sig, To);
+}
+
+bool
+HasAvx2()
+{
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+
+#endif
+
+SigScanKernel
+Supported(SigScanKernel Kernel)
+{
+#ifdef UTILS_SIGSCAN_X86
+    if (Kernel == SigScanKernel::Avx2 && !HasAvx2())
+    {
+        Kernel = SigScanKernel::Sse2;
+    }
+    return Kernel;
+#else
+    (void)Kernel;
+    return SigScanKernel::Scalar;
+#endif
+}
+
+}
+
+namespace utils
+{
+
+SigScanKernel
+SigScanActiveKernel(
+    void
+)
+{
+    static const SigScanKernel kernel = Impl::Supported(SigScanKernel::Avx2);
+    return kernel;
+}
+
+size_t
+FindSig(
+    RdBuf_t Buf,
+    const Sig_t& Sig,
+    size_t From,
+    SigScanKernel Kernel
+)
+{
+    switch (Impl::Supported(Kernel))
+    {
+#ifdef UTILS_SIGSCAN_X86
+    case SigScanKernel::Avx2:
+        return Impl::FindAvx2(Buf.data(), Buf.size(), Sig, From);
+    case SigScanKernel::Sse2:
+        return Impl::FindSse2(Buf.data(), Buf.size(), Sig, From);
+#endif
+    default:
+        return Impl::FindScalar(Buf.data(), Buf.size(), Sig, From);
+    }
+}
+
+size_t
+RFindSig(
+    RdBuf_t Buf,
+    const Sig_t& Sig,
+    size_t To,
+    SigScanKernel Kernel
+)
+{
+    switch (Impl::Supported(Kernel))
+    {
+#ifdef UTILS_SIGSCAN_X86
+    case SigScanKernel::Avx2:
+        return Impl::RFindAvx2(Buf.data(), Buf.size(), Sig, To);
+    case SigScanKernel::Sse2:
+        return Impl::RFindSse2(Buf.data(), Buf.size(), Sig, To);
+#endif
+    default:
+        return Impl::RFindScalar(Buf.data(), Buf.size(), Sig, To);
+    }
+}
+
+}
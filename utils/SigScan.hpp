@@ -0,0 +1,103 @@
+#pragma once
+
+#include "utils/RdBuf.hpp"
+
+#include <array>
+#include <cstddef>
+
+namespace utils
+{
+
+using Sig_t = std::array<unsigned char, 4u>;
+
+enum class SigScanKernel
+{
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+enum class SigScanDir
+{
+    Forward,
+    Backward,
+};
+
+//
+// The best kernel the CPU supports, detected once: AVX2, else SSE2 (always
+// there on x86-64), else the scalar loop.
+//
+SigScanKernel
+SigScanActiveKernel(
+    void
+);
+
+//
+// The offset of the first occurrence of Sig in Buf that starts at or after
+// From, or Buf.size() when there is none. Occurrences may overlap.
+//
+// The vector kernels compare 16 or 32 candidate positions at a time: each
+// of the four signature bytes against the block shifted by its index, so
+// that a set bit in the AND of the four masks is a whole match. Kernel is
+// for tests and benchmarks; one the CPU lacks falls back to the next best.
+//
+size_t
+FindSig(
+    RdBuf_t Buf,
+    const Sig_t& Sig,
+    size_t From = 0u,
+    SigScanKernel Kernel = SigScanActiveKernel()
+);
+
+//
+// The offset of the last occurrence of Sig in Buf that starts before To,
+// or Buf.size() when there is none.
+//
+size_t
+RFindSig(
+    RdBuf_t Buf,
+    const Sig_t& Sig,
+    size_t To,
+    SigScanKernel Kernel = SigScanActiveKernel()
+);
+
+//
+// Func(offset) for every occurrence of Sig in Buf, front to back or back to
+// front, while it returns true. Returns false when Func stopped it.
+//
+template<class FuncT>
+bool
+ForEachSig(
+    RdBuf_t Buf,
+    const Sig_t& Sig,
+    SigScanDir Dir,
+    FuncT&& Func
+)
+{
+    const SigScanKernel kernel = SigScanActiveKernel();
+
+    if (Dir == SigScanDir::Forward)
+    {
+        for (size_t at = FindSig(Buf, Sig, 0u, kernel); at < Buf.size(); at = FindSig(Buf, Sig, at + 1u, kernel))
+        {
+            if (!Func(at))
+            {
+                return false;
+            }
+        }
+    }
+    else
+    {
+        for (size_t at = RFindSig(Buf, Sig, Buf.size(), kernel); at < Buf.size(); at = RFindSig(Buf, Sig, at, kernel))
+        {
+            if (!Func(at))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+}
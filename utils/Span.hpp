@@ -122,7 +122,7 @@ struct Span
     T&
     operator[](
         size_t Index
-    )
+    ) const
     {
         assert(m_Data != nullptr && m_Sz > 0 && Index < m_Sz);
 
@@ -0,0 +1,427 @@
+#include "zip/AccessIndex.hpp"
+#include "utils/Crc32.hpp"
+#include "utils/ScopeExit.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+
+namespace zip::Impl
+{
+
+constexpr size_t INDEX_WINDOW = 32768u;
+
+constexpr size_t INDEX_MAX_AVAIL = std::numeric_limits<uInt>::max();
+
+//
+// serialized layout, all little endian:
+//   magic, version, span, compressed size, original size, crc, point count,
+//   then per point: out, in, bits, window size, window bytes
+//
+constexpr uint32_t INDEX_MAGIC   = 0x5844495au; // "ZIDX"
+constexpr uint32_t INDEX_VERSION = 1u;
+
+template<class T>
+void
+PutLE(
+    std::vector<unsigned char>& Buf,
+    T V
+)
+{
+    static_assert(std::is_unsigned_v<T>);
+
+    for (size_t i = 0; i < sizeof V; ++i)
+    {
+        Buf.push_back(uint8_t(uint64_t(V) >> i * 8u));
+    }
+}
+
+template<class T>
+bool
+GetLE(
+    utils::RdBuf_t& Buf,
+    T& V
+)
+{
+    static_assert(std::is_unsigned_v<T>);
+
+    if (Buf.size() < sizeof V)
+    {
+        return false;
+    }
+
+    uint64_t v = 0u;
+    for (size_t i = 0; i < sizeof V; ++i)
+    {
+        v |= uint64_t(Buf[i]) << i * 8u;
+    }
+
+    V   = T(v);
+    Buf = Buf.subspan(sizeof V);
+    return true;
+}
+
+//
+// Hands zlib the next piece of Src once it has used up the previous one -
+// avail_in is only 32 bits wide.
+//
+inline void
+Feed(
+    z_stream& Strm,
+    size_t& InLeft
+)
+{
+    if (Strm.avail_in == 0u)
+    {
+        uInt n        = uInt(std::min(InLeft, INDEX_MAX_AVAIL));
+        Strm.avail_in = n;
+        InLeft -= n;
+    }
+}
+
+}
+
+namespace zip
+{
+
+utils::Expected<AccessIndex, Err>
+AccessIndex::Build(
+    utils::RdBuf_t Src,
+    uint64_t Span
+)
+{
+    using namespace Impl;
+
+    z_stream strm{};
+    if (inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+    {
+        return utils::UnExpected{ Err::BadInit };
+    }
+
+    utils::ScopeExit end{ [&strm]()
+                          { inflateEnd(&strm); } };
+
+    AccessIndex index;
+    index.m_Span         = Span;
+    index.m_CompressedSz = Src.size();
+
+    //
+    // decoding always can start at the very beginning, without a window
+    //
+    index.m_Points.emplace_back();
+
+    //
+    // The output goes round a buffer of exactly one window, so at a block
+    // boundary the window of the point is simply what the buffer holds.
+    //
+    std::vector<unsigned char> ring(INDEX_WINDOW);
+
+    uint64_t totalIn  = 0u;
+    uint64_t totalOut = 0u;
+    uint64_t last     = 0u;
+    uint32_t crc      = 0u;
+    size_t inLeft     = Src.size();
+
+    strm.next_in = (decltype(strm.next_in))Src.data();
+
+    while (true)
+    {
+        Feed(strm, inLeft);
+
+        if (strm.avail_out == 0u)
+        {
+            strm.next_out  = ring.data();
+            strm.avail_out = uInt(ring.size());
+        }
+
+        unsigned char* sliceBeg = strm.next_out;
+        uInt availIn            = strm.avail_in;
+        uInt availOut           = strm.avail_out;
+
+        //
+        // Z_BLOCK returns at the end of every block
+        //
+        int ret = inflate(&strm, Z_BLOCK);
+
+        size_t produced = availOut - strm.avail_out;
+        totalIn += availIn - strm.avail_in;
+        totalOut += produced;
+        crc = utils::Crc32(crc, { sliceBeg, produced });
+
+        if (ret == Z_STREAM_END)
+        {
+            break;
+        }
+
+        if (ret != Z_OK && ret != Z_BUF_ERROR)
+        {
+            return utils::UnExpected{ ret == Z_MEM_ERROR ? Err::BadInit : Err::BadData };
+        }
+
+        if (ret == Z_BUF_ERROR && strm.avail_in == 0u && inLeft == 0u)
+        {
+            // truncated stream, nothing left to make progress with
+            return utils::UnExpected{ Err::BadData };
+        }
+
+        bool atBoundary = (strm.data_type & 128) != 0 && (strm.data_type & 64) == 0;
+        if (!atBoundary || totalOut - last < std::max<uint64_t>(Span, 1u))
+        {
+            continue;
+        }
+
+        AccessPoint p;
+        p.Out  = totalOut;
+        p.In   = totalIn;
+        p.Bits = uint8_t(strm.data_type & 7);
+
+        size_t have = size_t(std::min<uint64_t>(totalOut, INDEX_WINDOW));
+        size_t pos  = size_t(strm.next_out - ring.data());
+
+        p.Window.resize(have);
+        if (have <= pos)
+        {
+            std::copy_n(ring.data() + pos - have, have, p.Window.data());
+        }
+        else
+        {
+            size_t tail = have - pos;
+            std::copy_n(ring.data() + ring.size() - tail, tail, p.Window.data());
+            std::copy_n(ring.data(), pos, p.Window.data() + tail);
+        }
+
+        index.m_Points.push_back(std::move(p));
+        last = totalOut;
+    }
+
+    index.m_OriginalSz = totalOut;
+    index.m_Crc        = crc;
+
+    return index;
+}
+
+Err
+AccessIndex::ReadRange(
+    utils::RdBuf_t Src,
+    uint64_t Offset,
+    utils::WrBuf_t Dst
+) const
+{
+    using namespace Impl;
+
+    if (!IsBuilt() || Src.size() != m_CompressedSz)
+    {
+        return Err::BadInit;
+    }
+
+    if (Offset > m_OriginalSz || Dst.size() > m_OriginalSz - Offset)
+    {
+        return Err::SizeMismatch;
+    }
+
+    if (Dst.empty())
+    {
+        return Err::None;
+    }
+
+    auto next = std::upper_bound(
+        m_Points.begin(),
+        m_Points.end(),
+        Offset,
+        [](uint64_t Off, const AccessPoint& P)
+        {
+            return Off < P.Out;
+        }
+    );
+    const AccessPoint& p = *std::prev(next);
+
+    z_stream strm{};
+    if (inflateInit2(&strm, -MAX_WBITS) != Z_OK)
+    {
+        return Err::BadInit;
+    }
+
+    utils::ScopeExit end{ [&strm]()
+                          { inflateEnd(&strm); } };
+
+    //
+    // a point in the middle of a byte starts with the remaining bits of it
+    //
+    if (p.Bits != 0u)
+    {
+        if (inflatePrime(&strm, p.Bits, Src[p.In - 1u] >> (8u - p.Bits)) != Z_OK)
+        {
+            return Err::BadData;
+        }
+    }
+
+    if (!p.Window.empty() && inflateSetDictionary(&strm, p.Window.data(), uInt(p.Window.size())) != Z_OK)
+    {
+        return Err::BadData;
+    }
+
+    unsigned char discard[INDEX_WINDOW];
+
+    uint64_t skip  = Offset - p.Out;
+    size_t outLeft = Dst.size();
+    size_t inLeft  = Src.size() - p.In;
+
+    strm.next_in = (decltype(strm.next_in))Src.data() + p.In;
+
+    while (outLeft != 0u)
+    {
+        Feed(strm, inLeft);
+
+        uInt outChunk = 0u;
+        if (skip != 0u)
+        {
+            outChunk      = uInt(std::min<uint64_t>(skip, sizeof discard));
+            strm.next_out = discard;
+        }
+        else
+        {
+            outChunk      = uInt(std::min(outLeft, INDEX_MAX_AVAIL));
+            strm.next_out = Dst.data() + (Dst.size() - outLeft);
+        }
+        strm.avail_out = outChunk;
+
+        int ret = inflate(&strm, Z_NO_FLUSH);
+
+        size_t produced = outChunk - strm.avail_out;
+        if (skip != 0u)
+        {
+            skip -= produced;
+        }
+        else
+        {
+            outLeft -= produced;
+        }
+
+        if (ret == Z_STREAM_END)
+        {
+            // the member ends earlier than when the index was built
+            return outLeft == 0u ? Err::None : Err::BadData;
+        }
+
+        if (ret != Z_OK && ret != Z_BUF_ERROR)
+        {
+            return ret == Z_MEM_ERROR ? Err::BadInit : Err::BadData;
+        }
+
+        if (ret == Z_BUF_ERROR && strm.avail_in == 0u && inLeft == 0u)
+        {
+            return Err::BadData;
+        }
+    }
+
+    return Err::None;
+}
+
+std::vector<unsigned char>
+AccessIndex::Serialize(
+    void
+) const
+{
+    using namespace Impl;
+
+    std::vector<unsigned char> buf;
+
+    size_t windows = 0u;
+    for (const auto& p : m_Points)
+    {
+        windows += p.Window.size();
+    }
+    buf.reserve(44u + m_Points.size() * 21u + windows);
+
+    PutLE(buf, INDEX_MAGIC);
+    PutLE(buf, INDEX_VERSION);
+    PutLE(buf, m_Span);
+    PutLE(buf, m_CompressedSz);
+    PutLE(buf, m_OriginalSz);
+    PutLE(buf, m_Crc);
+    PutLE(buf, uint64_t(m_Points.size()));
+
+    for (const auto& p : m_Points)
+    {
+        PutLE(buf, p.Out);
+        PutLE(buf, p.In);
+        PutLE(buf, p.Bits);
+        PutLE(buf, uint32_t(p.Window.size()));
+        buf.insert(buf.end(), p.Window.begin(), p.Window.end());
+    }
+
+    return buf;
+}
+
+utils::Expected<AccessIndex, Err>
+AccessIndex::Deserialize(
+    utils::RdBuf_t Buf
+)
+{
+    using namespace Impl;
+
+    AccessIndex index;
+
+    uint32_t magic   = 0u;
+    uint32_t version = 0u;
+    uint64_t count   = 0u;
+
+    if (!GetLE(Buf, magic) || magic != INDEX_MAGIC || !GetLE(Buf, version) || version != INDEX_VERSION)
+    {
+        return utils::UnExpected{ Err::Unsupported };
+    }
+
+    if (!GetLE(Buf, index.m_Span)
+        || !GetLE(Buf, index.m_CompressedSz)
+        || !GetLE(Buf, index.m_OriginalSz)
+        || !GetLE(Buf, index.m_Crc)
+        || !GetLE(Buf, count)
+        || count == 0u
+        || count > Buf.size() / 21u)
+    {
+        return utils::UnExpected{ Err::BadData };
+    }
+
+    //
+    // everything ReadRange relies on is checked here: points in order and
+    // inside the member, each with the window it is supposed to have
+    //
+    index.m_Points.resize(size_t(count));
+    for (size_t i = 0; i < index.m_Points.size(); ++i)
+    {
+        AccessPoint& p = index.m_Points[i];
+
+        uint32_t windowSz = 0u;
+        if (!GetLE(Buf, p.Out) || !GetLE(Buf, p.In) || !GetLE(Buf, p.Bits) || !GetLE(Buf, windowSz))
+        {
+            return utils::UnExpected{ Err::BadData };
+        }
+
+        bool valid = p.Out <= index.m_OriginalSz
+            && p.In <= index.m_CompressedSz
+            && p.Bits < 8u
+            && (p.Bits == 0u || p.In != 0u)
+            && windowSz == std::min<uint64_t>(p.Out, INDEX_WINDOW)
+            && windowSz <= Buf.size()
+            && (i == 0u ? p.Out == 0u && p.In == 0u && p.Bits == 0u : p.Out > index.m_Points[i - 1u].Out);
+        if (!valid)
+        {
+            return utils::UnExpected{ Err::BadData };
+        }
+
+        p.Window.assign(Buf.begin(), Buf.begin() + windowSz);
+        Buf = Buf.subspan(windowSz);
+    }
+
+    if (!Buf.empty())
+    {
+        return utils::UnExpected{ Err::BadData };
+    }
+
+    return index;
+}
+
+}
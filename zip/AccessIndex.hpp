@@ -0,0 +1,134 @@
+#pragma once
+
+#include "zip/Err.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/WrBuf.hpp"
+#include "utils/Expected.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zip
+{
+
+//
+// A block boundary in a raw deflate stream where decoding can be picked up
+// again, together with the output right before it that back-references
+// from there on may still reach into.
+//
+struct AccessPoint
+{
+    uint64_t Out = 0u; // offset into the inflated data
+    uint64_t In  = 0u; // first whole byte of the compressed data from here on
+    uint8_t Bits = 0u; // trailing bits of the byte before In that belong here
+
+    std::vector<unsigned char> Window; // up to 32 KB of output before Out
+};
+
+//
+// Random access into a deflated member, in the style of zlib's zran.c: one
+// pass over the member records an access point every Span bytes of output,
+// after that any byte range is decoded starting from the closest point in
+// front of it instead of from the beginning of the member.
+//
+// The index costs a little over 32 KB per point. It can be serialized, so
+// that it does not have to be rebuilt by the next process - the sizes and
+// crc of the member are kept with it to tell whether it still belongs to
+// the member it is used with.
+//
+class AccessIndex
+{
+public:
+    static constexpr uint64_t DEFAULT_SPAN = 1u * 1024u * 1024u;
+
+    static utils::Expected<AccessIndex, Err>
+    Build(
+        utils::RdBuf_t Src,
+        uint64_t Span = DEFAULT_SPAN
+    );
+
+    //
+    // Inflates bytes [Offset, Offset + Dst.size()) of the member the index
+    // was built from (Src) into Dst. A range reaching past the end of the
+    // member is reported as Err::SizeMismatch.
+    //
+    Err
+    ReadRange(
+        utils::RdBuf_t Src,
+        uint64_t Offset,
+        utils::WrBuf_t Dst
+    ) const;
+
+    std::vector<unsigned char>
+    Serialize(
+        void
+    ) const;
+
+    static utils::Expected<AccessIndex, Err>
+    Deserialize(
+        utils::RdBuf_t Buf
+    );
+
+    bool
+    IsBuilt(
+        void
+    ) const
+    {
+        return !m_Points.empty();
+    }
+
+    //
+    // True when the index describes a member with these sizes and crc.
+    //
+    bool
+    Matches(
+        uint64_t CompressedSz,
+        uint64_t OriginalSz,
+        uint32_t Crc
+    ) const
+    {
+        return IsBuilt() && m_CompressedSz == CompressedSz && m_OriginalSz == OriginalSz && m_Crc == Crc;
+    }
+
+    const std::vector<AccessPoint>&
+    Points(
+        void
+    ) const
+    {
+        return m_Points;
+    }
+
+    uint64_t
+    CompressedSz(
+        void
+    ) const
+    {
+        return m_CompressedSz;
+    }
+
+    uint64_t
+    OriginalSz(
+        void
+    ) const
+    {
+        return m_OriginalSz;
+    }
+
+    uint32_t
+    Crc(
+        void
+    ) const
+    {
+        return m_Crc;
+    }
+
+private:
+    std::vector<AccessPoint> m_Points;
+    uint64_t m_Span         = DEFAULT_SPAN;
+    uint64_t m_CompressedSz = 0u;
+    uint64_t m_OriginalSz   = 0u;
+    uint32_t m_Crc          = 0u;
+};
+
+}
@@ -0,0 +1,319 @@
+#include "zip/Archive.hpp"
+#include "utils/AsPlainStringView.hpp"
+#include "utils/SigScan.hpp"
+
+#include <utility>
+
+namespace zip::Impl
+{
+
+//
+// Looks for the zip64 locator right in front of the end record at
+// EocdOffset, and takes the counts and offsets of the zip64 end record it
+// points at. False for a locator that leads nowhere valid, true otherwise
+// (including when there is no locator: not a zip64 archive).
+//
+bool
+ReadEOCD64(
+    CDir& Cdir,
+    utils::RdBuf_t ZipBuf,
+    size_t EocdOffset
+)
+{
+    if (EocdOffset < EOCD64Locator::MinBytes())
+    {
+        return true;
+    }
+
+    const size_t locOffset = EocdOffset - EOCD64Locator::MinBytes();
+
+    auto loc = EOCD64Locator::read(ZipBuf.subspan(locOffset, EOCD64Locator::MinBytes()));
+    if (!loc || AsBytes<uint32_t, unsigned char>(loc->sig) != EOCD64Locator::SIG)
+    {
+        return true;
+    }
+
+    if (loc->offsetOfEOCD64 > locOffset || locOffset - loc->offsetOfEOCD64 < EOCD64Rec::MinBytes())
+    {
+        return false;
+    }
+
+    auto eocd64 = EOCD64Rec::read(ZipBuf.subspan(loc->offsetOfEOCD64, EOCD64Rec::MinBytes()));
+    if (!eocd64 || !Validate(*eocd64, loc->offsetOfEOCD64))
+    {
+        return false;
+    }
+
+    Cdir.eocd.totalEntriesThisDisk = eocd64->totalEntriesThisDisk;
+    Cdir.eocd.totalEntries         = eocd64->totalEntries;
+    Cdir.eocd.sizeOfCentralDir     = eocd64->sizeOfCentralDir;
+    Cdir.eocd.offsetOfCentralDir   = eocd64->offsetOfCentralDir;
+    Cdir.eocd64                    = eocd64;
+    return true;
+}
+
+}
+
+namespace zip
+{
+
+bool
+Validate(const EOCDRec& r, size_t zipFileSize)
+{
+    return AsBytes<uint32_t, unsigned char>(r.sig) == EOCDRec::SIG
+        && r.thisDiskNum == 0u
+        && r.startDiskNum == 0u
+        && r.totalEntries == r.totalEntriesThisDisk
+        && r.totalEntries <= zipFileSize / CDFHeader::MinBytes()
+        && r.commentLen == r.comment.size()
+        && r.offsetOfCentralDir < zipFileSize
+        && r.sizeOfCentralDir <= zipFileSize - r.offsetOfCentralDir
+        && r.sizeOfCentralDir <= r.totalEntries * CDFHeader::MaxBytes()
+        && r.sizeOfCentralDir >= r.totalEntries * CDFHeader::MinBytes();
+}
+
+bool
+Validate(const EOCD64Rec& r, size_t eocd64Offset)
+{
+    return AsBytes<uint32_t, unsigned char>(r.sig) == EOCD64Rec::SIG
+        && r.sizeOfRecord >= EOCD64Rec::MinBytes() - 12u
+        && r.thisDiskNum == 0u
+        && r.startDiskNum == 0u
+        && r.totalEntries == r.totalEntriesThisDisk
+        && r.offsetOfCentralDir <= eocd64Offset
+        && r.sizeOfCentralDir <= eocd64Offset - r.offsetOfCentralDir;
+}
+
+bool
+Validate(const CDFHeader& r, const EOCDRec& eocd, size_t zipFileSize)
+{
+    return AsBytes<uint32_t, unsigned char>(r.sig) == CDFHeader::SIG
+        && r.diskNum == 0u
+        && r.nameLen == r.name.size()
+        && r.exFieldLen == r.exField.size()
+        && r.commentLen == r.comment.size()
+        && r.offsetOfLFHeader < zipFileSize
+        && r.offsetOfLFHeader < eocd.offsetOfCentralDir
+        && eocd.offsetOfCentralDir - r.offsetOfLFHeader >= LFHeader::MinBytes();
+}
+
+std::optional<utils::RdBuf_t>
+EntryData(const CDFHeader& cdfh, size_t LfhBytes, const EOCDRec& eocd, utils::RdBuf_t zipBuf)
+{
+    //
+    // the header offset is below the central directory (Validate()), the
+    // rest may not be
+    //
+    const uint64_t end = std::min<uint64_t>(eocd.offsetOfCentralDir, zipBuf.size());
+    if (cdfh.offsetOfLFHeader > end || LfhBytes > end - cdfh.offsetOfLFHeader)
+    {
+        return std::nullopt;
+    }
+
+    const uint64_t dataAt = cdfh.offsetOfLFHeader + LfhBytes;
+    if (cdfh.compressedSz > end - dataAt)
+    {
+        return std::nullopt;
+    }
+
+    return zipBuf.subspan(dataAt, cdfh.compressedSz);
+}
+
+bool
+Validate(const LFHeader& r, size_t zipFileSize)
+{
+    return AsBytes<uint32_t, unsigned char>(r.sig) == LFHeader::SIG
+        && r.nameLen == r.name.size()
+        && r.exFieldLen == r.exField.size()
+        && r.compressedSz < zipFileSize;
+}
+
+bool
+Validate(const LFHeader& r, const CDFHeader&, const EOCDRec& eocd, size_t zipFileSize)
+{
+    return Validate(r, zipFileSize)
+        && r.compressedSz < eocd.offsetOfCentralDir;
+}
+
+std::vector<CDir>
+GetPotentialCDir(utils::RdBuf_t zipBuf)
+{
+    std::vector<CDir> results;
+
+    utils::RdBuf_t eocdScanBuf = zipBuf.last(
+        std::min(EOCDRec::MaxBytes(), zipBuf.size())
+    );
+
+    utils::ForEachSig(
+        eocdScanBuf,
+        EOCDRec::SIG,
+        utils::SigScanDir::Backward,
+        [&results, zipBuf, eocdScanBuf](size_t At)
+        {
+            utils::RdBuf_t match = eocdScanBuf.subspan(At);
+
+            auto eocd = EOCDRec::read(match);
+            if (!eocd)
+            {
+                return true;
+            }
+
+            CDir cdir{ *eocd, std::nullopt };
+            if (Impl::ReadEOCD64(cdir, zipBuf, size_t(match.data() - zipBuf.data()))
+                && Validate(cdir.eocd, zipBuf.size()))
+            {
+                results.push_back(cdir);
+            }
+
+            return true;
+        }
+    );
+
+    return results;
+}
+
+Archive::Archive(
+    const char* Fname
+)
+  : m_File(Fname)
+  , m_Buf(m_File.Buffer())
+{
+    if (IsMapped())
+    {
+        m_CDirs = GetPotentialCDir(m_Buf);
+        Index();
+    }
+}
+
+Archive::Archive(
+    const char* Fname,
+    const char* SidecarPath
+)
+  : m_File(Fname)
+  , m_Buf(m_File.Buffer())
+{
+    if (!IsMapped())
+    {
+        return;
+    }
+
+    m_CDirs = GetPotentialCDir(m_Buf);
+
+    auto sidecar = SidecarIndex::OpenOrBuild(*this, SidecarPath);
+    if (sidecar.HasValue())
+    {
+        m_Sidecar = std::move(sidecar).Value();
+    }
+    else
+    {
+        Index();
+    }
+}
+
+Archive::Archive(
+    utils::RdBuf_t ZipBuf
+)
+  : m_Buf(ZipBuf)
+{
+    if (IsMapped())
+    {
+        m_CDirs = GetPotentialCDir(m_Buf);
+        Index();
+    }
+}
+
+void
+Archive::Index(
+    void
+)
+{
+    size_t expected = 0u;
+    for (const auto& cdir : m_CDirs)
+    {
+        expected += cdir.eocd.totalEntries;
+    }
+
+    m_Names = NameIndex{ m_Buf, expected };
+
+    for (size_t k = 0; k < m_CDirs.size(); ++k)
+    {
+        ForEachCDFHeader(
+            m_CDirs[k],
+            m_Buf,
+            [this, k](const CDFHeader& Cdfh, uint64_t CdOffset)
+            {
+                m_Names.Insert(utils::AsPlainStringView(Cdfh.name), CdOffset, uint16_t(k));
+                return true;
+            }
+        );
+    }
+}
+
+std::optional<Entry>
+Archive::Find(
+    std::string_view Name
+) const
+{
+    auto hit = m_Sidecar ? m_Sidecar->Find(Name) : m_Names.Find(Name);
+    if (!hit)
+    {
+        return std::nullopt;
+    }
+
+    return At(*hit);
+}
+
+std::optional<Entry>
+Archive::At(
+    const NameIndex::Hit& Hit
+) const
+{
+    if (Hit.CDir >= m_CDirs.size() || Hit.CdOffset >= m_Buf.size())
+    {
+        return std::nullopt;
+    }
+
+    //
+    // the same checks as ForEachEntry()
+    //
+    const EOCDRec& eocd = m_CDirs[Hit.CDir].eocd;
+
+    auto [cdfh, remCdBuf] = CDFHeader::read(m_Buf.subspan(Hit.CdOffset));
+    if (!cdfh || !Validate(*cdfh, eocd, m_Buf.size()))
+    {
+        return std::nullopt;
+    }
+
+    utils::RdBuf_t lfBuf = m_Buf.subspan(
+        cdfh->offsetOfLFHeader,
+        std::min<size_t>(
+            LFHeader::MaxBytes(),
+            eocd.offsetOfCentralDir - cdfh->offsetOfLFHeader
+        )
+    );
+
+    auto [lfh, remLfBuf] = LFHeader::read(lfBuf);
+    if (!lfh || !Validate(*lfh, *cdfh, eocd, m_Buf.size()))
+    {
+        return std::nullopt;
+    }
+
+    auto dataBuf = EntryData(*cdfh, size_t(remLfBuf.data() - lfBuf.data()), eocd, m_Buf);
+    if (!dataBuf)
+    {
+        return std::nullopt;
+    }
+
+    return Entry{ *cdfh, *lfh, *dataBuf };
+}
+
+utils::Expected<std::vector<unsigned char>, Err>
+Archive::Extract(
+    const Entry& E,
+    InflateBackend Backend
+) const
+{
+    return ExtractToVector(E.cdfh, E.fileBuf, Backend);
+}
+
+}
@@ -0,0 +1,396 @@
+#pragma once
+
+#include "zip/LFHeader.hpp"
+#include "zip/EOCDRec.hpp"
+#include "zip/EOCD64Rec.hpp"
+#include "zip/CDFHeader.hpp"
+#include "zip/Err.hpp"
+#include "zip/Extract.hpp"
+#include "zip/NameIndex.hpp"
+#include "zip/SidecarIndex.hpp"
+#include "utils/ForEach.hpp"
+#include "utils/MemoryMappedFile.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/Expected.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace zip
+{
+
+bool
+Validate(const EOCDRec& r, size_t zipFileSize);
+
+bool
+Validate(const EOCD64Rec& r, size_t eocd64Offset);
+
+bool
+Validate(const CDFHeader& r, const EOCDRec& eocd, size_t zipFileSize);
+
+//
+// the checks that need no central directory, as for a salvaged entry
+//
+bool
+Validate(const LFHeader& r, size_t zipFileSize);
+
+bool
+Validate(const LFHeader& r, const CDFHeader&, const EOCDRec& eocd, size_t zipFileSize);
+
+//
+// The compressed data of the entry of cdfh, whose local header is LfhBytes
+// long: compressedSz bytes (from the central directory - a local header
+// with a data descriptor has none) sliced from zipBuf, so that it is not
+// limited to the span the header was read from. nullopt when it does not
+// end before the central directory.
+//
+std::optional<utils::RdBuf_t>
+EntryData(const CDFHeader& cdfh, size_t LfhBytes, const EOCDRec& eocd, utils::RdBuf_t zipBuf);
+
+//
+// A central directory as announced by its end record. For a zip64 archive
+// eocd holds the values of eocd64 in place of its saturated ones, so that
+// it is all that is needed to walk the central directory either way.
+//
+struct CDir
+{
+    EOCDRec eocd;
+    std::optional<EOCD64Rec> eocd64;
+};
+
+//
+// Every plausible end of central directory record in the tail of the file,
+// the last one first, each with its zip64 end record if it has one.
+//
+std::vector<CDir>
+GetPotentialCDir(utils::RdBuf_t zipBuf);
+
+//
+// Calls Func(cdfh, lfh, dataBuf) for the entries of cdir, in central
+// directory order, with dataBuf the compressed data of the entry, see
+// EntryData(). Stops early (and returns false) when Func does; a bogus
+// header is reported on std::cerr and ends the walk.
+//
+template<class FuncT>
+bool
+ForEachEntry(const CDir& cdir, utils::RdBuf_t zipBuf, FuncT Func)
+{
+    const EOCDRec& eocd = cdir.eocd;
+
+    //
+    // std::cerr << "eocd: " << eocd << "\n";
+    //
+
+    utils::RdBuf_t cdBuf = zipBuf.subspan(
+        eocd.offsetOfCentralDir,
+        std::min<size_t>(
+            CDFHeader::MaxBytes() * eocd.totalEntries,
+            eocd.sizeOfCentralDir
+        )
+    );
+
+    for (size_t fn = 0; fn < eocd.totalEntries; ++fn)
+    {
+        auto [cdfh, remCdBuf] = CDFHeader::read(cdBuf);
+        if (!cdfh || !Validate(*cdfh, eocd, zipBuf.size()))
+        {
+            if (cdfh)
+                std::cerr << "cdfh[" << fn << "] is bogus (1):" << *cdfh << "\n";
+            else
+                std::cerr << "cdfh[" << fn << "] is bogus (1)" << "\n";
+
+            return true;
+        }
+
+        //
+        // std::cerr << "cdfh[" << fn << "]: " << *cdfh << "\n";
+        //
+
+        utils::RdBuf_t lfBuf = zipBuf.subspan(
+            cdfh->offsetOfLFHeader,
+            std::min<size_t>(
+                LFHeader::MaxBytes(),
+                eocd.offsetOfCentralDir - cdfh->offsetOfLFHeader
+            )
+        );
+
+        auto [lfh, remLfBuf] = LFHeader::read(lfBuf);
+        if (!lfh || !Validate(*lfh, *cdfh, eocd, zipBuf.size()))
+        {
+            if (lfh)
+                std::cerr << "lfh[" << fn << "] is bogus (1):" << *lfh << "\n";
+            else
+                std::cerr << "lfh[" << fn << "] is bogus (1)" << "\n";
+
+            return true;
+        }
+
+        auto dataBuf = EntryData(*cdfh, size_t(remLfBuf.data() - lfBuf.data()), eocd, zipBuf);
+        if (!dataBuf)
+        {
+            std::cerr << "cdfh[" << fn << "] data is out of bounds:" << *cdfh << "\n";
+            return true;
+        }
+
+        if (!Func(*cdfh, *lfh, *dataBuf))
+        {
+            return false;
+        }
+
+        cdBuf = remCdBuf;
+    }
+
+    return true;
+}
+
+//
+// Like ForEachEntry(), but only the central directory is read: Func(cdfh,
+// cdOffset) gets each header and its offset in zipBuf. A bogus header
+// silently ends the walk.
+//
+template<class FuncT>
+bool
+ForEachCDFHeader(const CDir& cdir, utils::RdBuf_t zipBuf, FuncT Func)
+{
+    const EOCDRec& eocd = cdir.eocd;
+
+    utils::RdBuf_t cdBuf = zipBuf.subspan(
+        eocd.offsetOfCentralDir,
+        std::min<size_t>(
+            CDFHeader::MaxBytes() * eocd.totalEntries,
+            eocd.sizeOfCentralDir
+        )
+    );
+
+    for (size_t fn = 0; fn < eocd.totalEntries; ++fn)
+    {
+        auto [cdfh, remCdBuf] = CDFHeader::read(cdBuf);
+        if (!cdfh || !Validate(*cdfh, eocd, zipBuf.size()))
+        {
+            return true;
+        }
+
+        if (!Func(*cdfh, uint64_t(cdBuf.data() - zipBuf.data())))
+        {
+            return false;
+        }
+
+        cdBuf = remCdBuf;
+    }
+
+    return true;
+}
+
+//
+// An entry as found by Archive::Find(): both headers, and the compressed
+// data (compressedSz bytes from the local header on).
+//
+struct Entry
+{
+    CDFHeader cdfh;
+    LFHeader lfh;
+    utils::RdBuf_t fileBuf;
+};
+
+//
+// A zip file, mapped and its end of central directory located and validated
+// once - after that, iterating, looking up and extracting entries only reads
+// the mapping. Lookups and extraction are const and may run concurrently.
+//
+//     zip::Archive archive{ "some.zip" };
+//     if (auto e = archive.Find("dir/file.txt"))
+//     {
+//         auto data = archive.Extract(*e);
+//     }
+//
+class Archive
+{
+public:
+    explicit Archive(
+        const char* Fname
+    );
+
+    //
+    // With the name index taken from the sidecar file at SidecarPath (see
+    // SidecarIndex::PathFor()), which is written first if it is missing or
+    // stale. Falls back to building the index in memory if the sidecar
+    // cannot be written.
+    //
+    Archive(
+        const char* Fname,
+        const char* SidecarPath
+    );
+
+    //
+    // over a buffer owned (and kept alive) by the caller
+    //
+    explicit Archive(
+        utils::RdBuf_t ZipBuf
+    );
+
+    //
+    // false if the file could not be mapped, see File().Error()
+    //
+    bool
+    IsMapped(
+        void
+    ) const
+    {
+        return m_Buf.data() != nullptr;
+    }
+
+    //
+    // mapped, and with at least one plausible central directory
+    //
+    bool
+    IsValid(
+        void
+    ) const
+    {
+        return IsMapped() && !m_CDirs.empty();
+    }
+
+    const utils::MemoryMappedFile&
+    File(
+        void
+    ) const
+    {
+        return m_File;
+    }
+
+    utils::RdBuf_t
+    Buffer(
+        void
+    ) const
+    {
+        return m_Buf;
+    }
+
+    const std::vector<CDir>&
+    CDirs(
+        void
+    ) const
+    {
+        return m_CDirs;
+    }
+
+    //
+    // zip::ForEachEntry() over every central directory
+    //
+    template<class FuncT>
+    bool
+    ForEachEntry(
+        FuncT Func
+    ) const
+    {
+        return utils::ForEach(
+            m_CDirs,
+            [this, &Func](const CDir& Cdir)
+            {
+                return zip::ForEachEntry(Cdir, m_Buf, Func);
+            }
+        );
+    }
+
+    //
+    // Calls Func(cdfh, hit) for the entries of every central directory, in
+    // order, described by the central directory alone: unlike ForEachEntry()
+    // no local header is read, so listing touches only the tail of the file
+    // and not a page per entry all over it. At(hit) resolves the local
+    // header and the data of an entry once they are wanted.
+    //
+    template<class FuncT>
+    bool
+    List(
+        FuncT Func
+    ) const
+    {
+        for (size_t k = 0; k < m_CDirs.size(); ++k)
+        {
+            const bool more = ForEachCDFHeader(
+                m_CDirs[k],
+                m_Buf,
+                [&Func, k](const CDFHeader& Cdfh, uint64_t CdOffset)
+                {
+                    return Func(Cdfh, NameIndex::Hit{ CdOffset, uint16_t(k) });
+                }
+            );
+
+            if (!more)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //
+    // The first entry called Name. A hash lookup in the name index (or the
+    // sidecar), which costs no allocation and decodes only the headers of
+    // that entry.
+    //
+    std::optional<Entry>
+    Find(
+        std::string_view Name
+    ) const;
+
+    //
+    // The entry whose central directory header is at Hit, as handed out by
+    // the name indexes (NameIndex, SidecarIndex, SortedNames).
+    //
+    std::optional<Entry>
+    At(
+        const NameIndex::Hit& Hit
+    ) const;
+
+    //
+    // The decoded data of E, checked against the crc of the central directory.
+    //
+    utils::Expected<std::vector<unsigned char>, Err>
+    Extract(
+        const Entry& E,
+        InflateBackend Backend = InflateBackend::Zlib
+    ) const;
+
+    //
+    // built when the archive is opened, one slot per distinct name - empty
+    // when a sidecar is used instead
+    //
+    const NameIndex&
+    Names(
+        void
+    ) const
+    {
+        return m_Names;
+    }
+
+    //
+    // nullptr unless opened with a sidecar path, and the sidecar could be
+    // opened or written
+    //
+    const SidecarIndex*
+    Sidecar(
+        void
+    ) const
+    {
+        return m_Sidecar ? &*m_Sidecar : nullptr;
+    }
+
+private:
+    void
+    Index(
+        void
+    );
+
+    utils::MemoryMappedFile m_File;
+    utils::RdBuf_t m_Buf;
+    std::vector<CDir> m_CDirs;
+    NameIndex m_Names;
+    std::optional<SidecarIndex> m_Sidecar;
+};
+
+}
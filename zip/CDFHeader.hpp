@@ -8,6 +8,7 @@
 #include "utils/Hexed.hpp"
 #include "utils/AsBytes.hpp"
 #include "utils/AsPlainStringView.hpp"
+#include "zip/ExtraField.hpp"
 
 #include <optional>
 #include <ostream>
@@ -28,15 +29,15 @@ struct CDFHeader
     uint16_t lastModTime;
     uint16_t lastModDate;
     uint32_t crc32;
-    uint32_t compressedSz;
-    uint32_t originalSz;
+    uint64_t compressedSz; // 32 bits, unless in the zip64 extra field
+    uint64_t originalSz;   // 32 bits, unless in the zip64 extra field
     uint16_t nameLen;
     uint16_t exFieldLen;
     uint16_t commentLen;
     uint16_t diskNum;
     uint16_t attrInternal;
     uint32_t attrExternal;
-    uint32_t offsetOfLFHeader;
+    uint64_t offsetOfLFHeader; // 32 bits, unless in the zip64 extra field
     utils::RdBuf_t name;
     utils::RdBuf_t exField;
     utils::RdBuf_t comment;
@@ -50,15 +51,15 @@ struct CDFHeader
         msg::Seg<&CDFHeader::lastModTime>,
         msg::Seg<&CDFHeader::lastModDate>,
         msg::Seg<&CDFHeader::crc32>,
-        msg::Seg<&CDFHeader::compressedSz>,
-        msg::Seg<&CDFHeader::originalSz>,
+        msg::Seg<&CDFHeader::compressedSz, msg::Pos<0u, 32u>>,
+        msg::Seg<&CDFHeader::originalSz, msg::Pos<0u, 32u>>,
         msg::Seg<&CDFHeader::nameLen>,
         msg::Seg<&CDFHeader::exFieldLen>,
         msg::Seg<&CDFHeader::commentLen>,
         msg::Seg<&CDFHeader::diskNum>,
         msg::Seg<&CDFHeader::attrInternal>,
         msg::Seg<&CDFHeader::attrExternal>,
-        msg::Seg<&CDFHeader::offsetOfLFHeader>,
+        msg::Seg<&CDFHeader::offsetOfLFHeader, msg::Pos<0u, 32u>>,
         msg::Seg<&CDFHeader::name, msg::Dyn<&CDFHeader::nameLen>>,
         msg::Seg<&CDFHeader::exField, msg::Dyn<&CDFHeader::exFieldLen>>,
         msg::Seg<&CDFHeader::comment, msg::Dyn<&CDFHeader::commentLen>>>;
@@ -135,6 +136,15 @@ struct CDFHeader
             b = Buf;
             h.reset();
         }
+        else
+        {
+            auto sat = [](uint64_t& Field)
+            {
+                return Field == ZIP64_SATURATED ? &Field : nullptr;
+            };
+
+            ReadZip64(h->exField, { sat(h->originalSz), sat(h->compressedSz), sat(h->offsetOfLFHeader) });
+        }
 
         return { h, *b };
     }
@@ -0,0 +1,269 @@
+#include "zip/CDIndex.hpp"
+#include "utils/AsPlainStringView.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace zip::Impl
+{
+
+//
+// Fixed width lanes the compiler can map onto vector registers even at -O2,
+// whose cost model leaves loops that need an epilogue alone.
+//
+constexpr size_t SCAN_LANES = 8u;
+
+uint64_t
+Sum(
+    const uint64_t* P,
+    size_t N
+)
+{
+    uint64_t lanes[SCAN_LANES] = {};
+
+    size_t i = 0;
+    for (; i + SCAN_LANES <= N; i += SCAN_LANES)
+    {
+        for (size_t k = 0; k < SCAN_LANES; ++k)
+        {
+            lanes[k] += P[i + k];
+        }
+    }
+
+    uint64_t sum = 0u;
+    for (; i < N; ++i)
+    {
+        sum += P[i];
+    }
+
+    for (uint64_t l : lanes)
+    {
+        sum += l;
+    }
+
+    return sum;
+}
+
+}
+
+namespace zip
+{
+
+CDIndex::CDIndex(
+    const Archive& A
+)
+{
+    size_t expected = 0u;
+    for (const auto& cdir : A.CDirs())
+    {
+        expected += cdir.eocd.totalEntries;
+    }
+
+    m_LFHOffset.reserve(expected);
+    m_CompressedSz.reserve(expected);
+    m_OriginalSz.reserve(expected);
+    m_Crc.reserve(expected);
+    m_Method.reserve(expected);
+    m_NameOffset.reserve(expected + 1u);
+
+    for (const auto& cdir : A.CDirs())
+    {
+        ForEachCDFHeader(
+            cdir,
+            A.Buffer(),
+            [this](const CDFHeader& Cdfh, uint64_t)
+            {
+                m_LFHOffset.push_back(Cdfh.offsetOfLFHeader);
+                m_CompressedSz.push_back(Cdfh.compressedSz);
+                m_OriginalSz.push_back(Cdfh.originalSz);
+                m_Crc.push_back(Cdfh.crc32);
+                m_Method.push_back(Cdfh.compression);
+
+                m_Names.insert(m_Names.end(), Cdfh.name.begin(), Cdfh.name.end());
+                m_NameOffset.push_back(m_Names.size());
+                return true;
+            }
+        );
+    }
+
+    m_Names.shrink_to_fit();
+}
+
+CDIndex::CDIndex(
+    const Archive& A,
+    const CDScanConfig& Config
+)
+{
+    const utils::RdBuf_t zipBuf = A.Buffer();
+
+    for (const auto& cdir : A.CDirs())
+    {
+        const std::vector<uint64_t> records = ScanCDFHeaders(cdir, zipBuf, Config);
+
+        const size_t base = Size();
+        const size_t n    = records.size();
+
+        m_LFHOffset.resize(base + n);
+        m_CompressedSz.resize(base + n);
+        m_OriginalSz.resize(base + n);
+        m_Crc.resize(base + n);
+        m_Method.resize(base + n);
+        m_NameOffset.resize(base + n + 1u);
+
+        const size_t parts = Impl::ScanThreads(Config, cdir.eocd.sizeOfCentralDir);
+        const size_t share = (n + parts - 1u) / parts;
+
+        auto first = [n, share](size_t P)
+        {
+            return std::min(n, P * share);
+        };
+
+        //
+        // decoded in place, with the name lengths where their offsets go
+        //
+        std::vector<size_t> valid(parts);
+        std::vector<size_t> nameBytes(parts);
+        Impl::ForEachPart(
+            parts,
+            [&](size_t P)
+            {
+                size_t i     = first(P);
+                size_t bytes = 0u;
+                for (; i < first(P + 1u); ++i)
+                {
+                    auto [cdfh, remCdBuf] = CDFHeader::read(zipBuf.subspan(records[i]));
+                    if (!cdfh || !Validate(*cdfh, cdir.eocd, zipBuf.size()))
+                    {
+                        break;
+                    }
+
+                    m_LFHOffset[base + i]       = cdfh->offsetOfLFHeader;
+                    m_CompressedSz[base + i]    = cdfh->compressedSz;
+                    m_OriginalSz[base + i]      = cdfh->originalSz;
+                    m_Crc[base + i]             = cdfh->crc32;
+                    m_Method[base + i]          = cdfh->compression;
+                    m_NameOffset[base + i + 1u] = cdfh->nameLen;
+                    bytes += cdfh->nameLen;
+                }
+
+                valid[P]     = i;
+                nameBytes[P] = bytes;
+            }
+        );
+
+        //
+        // where each share's names go, up to the first bogus header
+        //
+        size_t count = n;
+        std::vector<size_t> nameAt(parts);
+        size_t names = m_Names.size();
+        for (size_t p = 0; p < parts; ++p)
+        {
+            nameAt[p] = names;
+            names += nameBytes[p];
+
+            if (valid[p] < first(p + 1u))
+            {
+                count = valid[p];
+                break;
+            }
+        }
+
+        m_LFHOffset.resize(base + count);
+        m_CompressedSz.resize(base + count);
+        m_OriginalSz.resize(base + count);
+        m_Crc.resize(base + count);
+        m_Method.resize(base + count);
+        m_NameOffset.resize(base + count + 1u);
+        m_Names.resize(names);
+
+        Impl::ForEachPart(
+            parts,
+            [&](size_t P)
+            {
+                size_t at = nameAt[P];
+                for (size_t i = first(P); i < std::min(count, first(P + 1u)); ++i)
+                {
+                    const size_t len = m_NameOffset[base + i + 1u];
+                    std::memcpy(m_Names.data() + at, zipBuf.data() + records[i] + CDFHeader::MinBytes(), len);
+
+                    at += len;
+                    m_NameOffset[base + i + 1u] = uint32_t(at);
+                }
+            }
+        );
+    }
+}
+
+uint64_t
+CDIndex::TotalOriginalSz(
+    void
+) const
+{
+    return Impl::Sum(m_OriginalSz.data(), m_OriginalSz.size());
+}
+
+uint64_t
+CDIndex::TotalCompressedSz(
+    void
+) const
+{
+    return Impl::Sum(m_CompressedSz.data(), m_CompressedSz.size());
+}
+
+size_t
+CDIndex::CountMethod(
+    uint16_t Method
+) const
+{
+    const uint16_t* p = m_Method.data();
+    const size_t n    = m_Method.size();
+
+    uint16_t lanes[Impl::SCAN_LANES * 2u] = {};
+    size_t count = 0u;
+
+    size_t i = 0;
+    while (i + Impl::SCAN_LANES * 2u <= n)
+    {
+        //
+        // 16 bit lane counters, flushed before they can overflow
+        //
+        size_t stop = std::min(n - Impl::SCAN_LANES * 2u + 1u, i + 65535u * Impl::SCAN_LANES * 2u);
+        for (; i < stop; i += Impl::SCAN_LANES * 2u)
+        {
+            for (size_t k = 0; k < Impl::SCAN_LANES * 2u; ++k)
+            {
+                lanes[k] += p[i + k] == Method;
+            }
+        }
+
+        for (auto& l : lanes)
+        {
+            count += std::exchange(l, 0u);
+        }
+    }
+
+    for (; i < n; ++i)
+    {
+        count += p[i] == Method;
+    }
+
+    return count;
+}
+
+size_t
+CDIndex::Bytes(
+    void
+) const
+{
+    return m_LFHOffset.capacity() * sizeof(uint64_t)
+         + m_CompressedSz.capacity() * sizeof(uint64_t)
+         + m_OriginalSz.capacity() * sizeof(uint64_t)
+         + m_Crc.capacity() * sizeof(uint32_t)
+         + m_Method.capacity() * sizeof(uint16_t)
+         + m_NameOffset.capacity() * sizeof(uint32_t)
+         + m_Names.capacity();
+}
+
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "zip/Archive.hpp"
+#include "zip/CDScan.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace zip
+{
+
+//
+// The central directory, reduced to the columns that are actually read and
+// stored as a struct of arrays: one dense array per field, and all names
+// back to back in a single arena. A parsed CDFHeader is ~100 bytes before
+// its name; here an entry costs 34 bytes plus its name, and a scan over one
+// column (sizes, methods) streams through nothing but that column.
+//
+// Entries are numbered in central directory order, across the central
+// directories of the archive like Archive::ForEachEntry().
+//
+class CDIndex
+{
+public:
+    CDIndex(
+        void
+    ) = default;
+
+    explicit CDIndex(
+        const Archive& A
+    );
+
+    //
+    // The same index, with the records located by ScanCDFHeaders() and then
+    // decoded and validated across Config.Threads threads. Like the plain
+    // walk, a central directory ends at its first bogus header.
+    //
+    CDIndex(
+        const Archive& A,
+        const CDScanConfig& Config
+    );
+
+    size_t
+    Size(
+        void
+    ) const
+    {
+        return m_Crc.size();
+    }
+
+    std::string_view
+    Name(
+        size_t I
+    ) const
+    {
+        return { m_Names.data() + m_NameOffset[I], size_t(m_NameOffset[I + 1u] - m_NameOffset[I]) };
+    }
+
+    uint64_t
+    LFHOffset(
+        size_t I
+    ) const
+    {
+        return m_LFHOffset[I];
+    }
+
+    uint64_t
+    CompressedSz(
+        size_t I
+    ) const
+    {
+        return m_CompressedSz[I];
+    }
+
+    uint64_t
+    OriginalSz(
+        size_t I
+    ) const
+    {
+        return m_OriginalSz[I];
+    }
+
+    uint32_t
+    Crc(
+        size_t I
+    ) const
+    {
+        return m_Crc[I];
+    }
+
+    uint16_t
+    Method(
+        size_t I
+    ) const
+    {
+        return m_Method[I];
+    }
+
+    //
+    // whole columns, for scans
+    //
+    const std::vector<uint64_t>&
+    OriginalSizes(
+        void
+    ) const
+    {
+        return m_OriginalSz;
+    }
+
+    const std::vector<uint64_t>&
+    CompressedSizes(
+        void
+    ) const
+    {
+        return m_CompressedSz;
+    }
+
+    const std::vector<uint16_t>&
+    Methods(
+        void
+    ) const
+    {
+        return m_Method;
+    }
+
+    //
+    // Column scans, plain loops over a single array that the compiler
+    // vectorizes.
+    //
+    uint64_t
+    TotalOriginalSz(
+        void
+    ) const;
+
+    uint64_t
+    TotalCompressedSz(
+        void
+    ) const;
+
+    size_t
+    CountMethod(
+        uint16_t Method
+    ) const;
+
+    //
+    // memory held by the index, over all entries
+    //
+    size_t
+    Bytes(
+        void
+    ) const;
+
+    double
+    BytesPerEntry(
+        void
+    ) const
+    {
+        return Size() == 0u ? 0.0 : double(Bytes()) / Size();
+    }
+
+private:
+    std::vector<uint64_t> m_LFHOffset;
+    std::vector<uint64_t> m_CompressedSz;
+    std::vector<uint64_t> m_OriginalSz;
+    std::vector<uint32_t> m_Crc;
+    std::vector<uint16_t> m_Method;
+    std::vector<uint32_t> m_NameOffset{ 0u }; // Size() + 1, into m_Names
+    std::vector<char> m_Names;
+};
+
+}
@@ -0,0 +1,185 @@
+#include "zip/CDScan.hpp"
+#include "utils/SigScan.hpp"
+
+#include <cstring>
+
+namespace zip::Impl
+{
+
+//
+// Cd is the central directory, Off a position in it: the length of the
+// record there, or 0 if there is none - no signature, or not enough room
+// for its fixed part and its variable length fields.
+//
+size_t
+RecordAt(
+    utils::RdBuf_t Cd,
+    size_t Off
+)
+{
+    const size_t fixed = CDFHeader::MinBytes();
+    if (Off > Cd.size() || Cd.size() - Off < fixed)
+    {
+        return 0u;
+    }
+
+    const unsigned char* p = Cd.data() + Off;
+    if (std::memcmp(p, CDFHeader::SIG.data(), CDFHeader::SIG.size()) != 0)
+    {
+        return 0u;
+    }
+
+    //
+    // nameLen, exFieldLen and commentLen, at the end of the fixed part
+    //
+    auto le16 = [p](size_t At)
+    {
+        return size_t(p[At]) | size_t(p[At + 1u]) << 8;
+    };
+
+    const size_t len = fixed + le16(28u) + le16(30u) + le16(32u);
+    return len <= Cd.size() - Off ? len : 0u;
+}
+
+//
+// Appends the records from Off on while they start before End, at most
+// Limit in total. Returns where the chain leaves [.., End), or an offset
+// before End where it breaks.
+//
+size_t
+Chain(
+    utils::RdBuf_t Cd,
+    size_t Off,
+    size_t End,
+    size_t Limit,
+    std::vector<uint64_t>& Out
+)
+{
+    while (Off < End && Out.size() < Limit)
+    {
+        const size_t len = RecordAt(Cd, Off);
+        if (len == 0u)
+        {
+            return Off;
+        }
+
+        Out.push_back(Off);
+        Off += len;
+    }
+
+    return Off;
+}
+
+struct ScanChunk
+{
+    size_t Begin = 0u;
+    size_t End   = 0u;
+    size_t Exit  = 0u; // where Records leads out of the chunk
+    std::vector<uint64_t> Records;
+};
+
+}
+
+namespace zip
+{
+
+std::vector<uint64_t>
+ScanCDFHeaders(
+    const CDir& Cdir,
+    utils::RdBuf_t ZipBuf,
+    const CDScanConfig& Config
+)
+{
+    const EOCDRec& eocd = Cdir.eocd;
+    const size_t limit  = eocd.totalEntries;
+
+    const utils::RdBuf_t cd = ZipBuf.subspan(
+        eocd.offsetOfCentralDir,
+        std::min<size_t>(
+            CDFHeader::MaxBytes() * eocd.totalEntries,
+            eocd.sizeOfCentralDir
+        )
+    );
+
+    std::vector<uint64_t> records;
+    records.reserve(limit);
+
+    const size_t threads = Impl::ScanThreads(Config, cd.size());
+    if (threads <= 1u)
+    {
+        Impl::Chain(cd, 0u, cd.size(), limit, records);
+    }
+    else
+    {
+        const size_t chunk = cd.size() / threads;
+
+        std::vector<Impl::ScanChunk> chunks(threads);
+        Impl::ForEachPart(
+            threads,
+            [&](size_t P)
+            {
+                Impl::ScanChunk& c = chunks[P];
+                c.Begin            = P * chunk;
+                c.End              = P + 1u < threads ? c.Begin + chunk : cd.size();
+                c.Exit             = c.End;
+
+                //
+                // chained from each signature in turn, until one chain
+                // leaves the chunk - chains through false signatures
+                // mostly break after a record or two
+                //
+                const utils::RdBuf_t part = cd.first(std::min(cd.size(), c.End + CDFHeader::SIG.size() - 1u));
+                for (size_t sig = utils::FindSig(part, CDFHeader::SIG, c.Begin); sig < c.End; sig = utils::FindSig(part, CDFHeader::SIG, sig + 1u))
+                {
+                    c.Records.clear();
+                    const size_t exit = Impl::Chain(cd, sig, c.End, limit, c.Records);
+                    if (exit >= c.End)
+                    {
+                        c.Exit = exit;
+                        return;
+                    }
+                }
+
+                c.Records.clear();
+            }
+        );
+
+        size_t off = 0u;
+        for (const auto& c : chunks)
+        {
+            if (off >= c.End)
+            {
+                continue; // inside a record that started in an earlier chunk
+            }
+
+            auto at = std::lower_bound(c.Records.begin(), c.Records.end(), off);
+            if (at != c.Records.end() && *at == off)
+            {
+                const size_t take = std::min<size_t>(c.Records.end() - at, limit - records.size());
+                records.insert(records.end(), at, at + take);
+                off = c.Exit;
+            }
+            else
+            {
+                off = Impl::Chain(cd, off, c.End, limit, records);
+            }
+
+            if (off < c.End || records.size() == limit)
+            {
+                break; // the chain is broken, or complete
+            }
+        }
+    }
+
+    //
+    // relative to the start of ZipBuf, like ForEachCDFHeader()
+    //
+    for (auto& r : records)
+    {
+        r += eocd.offsetOfCentralDir;
+    }
+
+    return records;
+}
+
+}
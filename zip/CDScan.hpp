@@ -0,0 +1,110 @@
+#pragma once
+
+#include "zip/Archive.hpp"
+#include "utils/RdBuf.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace zip
+{
+
+struct CDScanConfig
+{
+    //
+    // central directories shorter than this are walked on the calling thread
+    //
+    size_t Threshold = 4u * 1024u * 1024u;
+
+    //
+    // number of threads to split across (the caller included), 0 for
+    // std::thread::hardware_concurrency()
+    //
+    unsigned Threads = 0u;
+
+    //
+    // the smallest share of the central directory worth a thread
+    //
+    size_t MinChunk = 256u * 1024u;
+};
+
+//
+// The offsets in ZipBuf of the central directory headers of Cdir, in order:
+// the same records ForEachCDFHeader() visits, but only located - their
+// signature and lengths are checked, nothing is decoded or validated.
+//
+// Where a record starts is only known from the lengths of the one before,
+// so a plain walk is one long dependency chain. Above Config.Threshold the
+// central directory is cut into chunks, and each chunk is searched for
+// signatures and chained from the first one that leads out of it, all
+// chunks at once. The chunks are then stitched front to back: where the
+// true chain enters a chunk at a record of its speculative chain, the rest
+// of that chain is taken as is; where it does not (a signature inside a
+// name or an extra field), that one chunk is walked again from the true
+// entry point.
+//
+std::vector<uint64_t>
+ScanCDFHeaders(
+    const CDir& Cdir,
+    utils::RdBuf_t ZipBuf,
+    const CDScanConfig& Config = {}
+);
+
+namespace Impl
+{
+
+//
+// The number of threads to split Bytes across, at least 1.
+//
+inline size_t
+ScanThreads(
+    const CDScanConfig& Config,
+    size_t Bytes
+)
+{
+    size_t threads = Config.Threads ? Config.Threads : std::max(1u, std::thread::hardware_concurrency());
+    threads        = std::min(threads, std::max<size_t>(1u, Bytes / std::max<size_t>(1u, Config.MinChunk)));
+
+    return Bytes < Config.Threshold ? 1u : threads;
+}
+
+//
+// Func(part) for part in [0, Parts), part 0 on the calling thread.
+//
+template<class FuncT>
+void
+ForEachPart(
+    size_t Parts,
+    FuncT Func
+)
+{
+    std::vector<std::thread> workers;
+    workers.reserve(Parts > 0u ? Parts - 1u : 0u);
+
+    for (size_t p = 1; p < Parts; ++p)
+    {
+        workers.emplace_back(
+            [&Func, p]()
+            {
+                Func(p);
+            }
+        );
+    }
+
+    if (Parts > 0u)
+    {
+        Func(size_t(0u));
+    }
+
+    for (auto& w : workers)
+    {
+        w.join();
+    }
+}
+
+}
+
+}
@@ -0,0 +1,296 @@
+#include "zip/Codec.hpp"
+#include "zip/Extract.hpp"
+#include "zip/Inflate.hpp"
+#include "zip/NativeInflate.hpp"
+#include "zip/ParallelInflate.hpp"
+#include "zip/Stored.hpp"
+#include "zip/Zstd.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace zip
+{
+
+CodecRegistry&
+CodecRegistry::Default(
+    void
+)
+{
+    static CodecRegistry registry = []()
+    {
+        CodecRegistry r;
+
+        Codec stored;
+        stored.Name   = "stored";
+        stored.Method = 0u;
+        stored.Caps   = CodecCaps::OneShot | CodecCaps::Streaming;
+        stored.Decode = [](utils::RdBuf_t Src, utils::WrBuf_t Dst, uint32_t* Crc)
+        {
+            return ExtractInto(0u, Src, Dst, InflateBackend::Zlib, Crc);
+        };
+        stored.Stream = [](utils::RdBuf_t Src, SinkRef Sink)
+        {
+            Stored(Src, Sink);
+            return Err::None;
+        };
+        r.Register(stored);
+
+        Codec zlib;
+        zlib.Name   = "zlib";
+        zlib.Method = 8u;
+        zlib.Caps   = CodecCaps::OneShot | CodecCaps::Streaming;
+        zlib.Decode = [](utils::RdBuf_t Src, utils::WrBuf_t Dst, uint32_t* Crc)
+        {
+            return InflateInto(Src, Dst, InflateBackend::Zlib, Crc);
+        };
+        zlib.Stream = [](utils::RdBuf_t Src, SinkRef Sink)
+        {
+            return Inflate(Src, Sink) == 0 ? Err::None : Err::BadData;
+        };
+        r.Register(zlib);
+
+        Codec native;
+        native.Name   = "native";
+        native.Method = 8u;
+        native.Caps   = CodecCaps::OneShot;
+        native.Decode = [](utils::RdBuf_t Src, utils::WrBuf_t Dst, uint32_t* Crc)
+        {
+            return NativeInflateInto(Src, Dst, Crc);
+        };
+        r.Register(native);
+
+        Codec parallel;
+        parallel.Name   = "parallel";
+        parallel.Method = 8u;
+        parallel.Caps   = CodecCaps::OneShot | CodecCaps::Parallel;
+        parallel.Decode = [](utils::RdBuf_t Src, utils::WrBuf_t Dst, uint32_t* Crc)
+        {
+            return ParallelInflateInto(Src, Dst, Crc);
+        };
+        r.Register(parallel);
+
+        Codec zstd;
+        zstd.Name   = "zstd";
+        zstd.Method = ZSTD_METHOD;
+        zstd.Caps   = CodecCaps::OneShot | CodecCaps::Streaming;
+        zstd.Decode = [](utils::RdBuf_t Src, utils::WrBuf_t Dst, uint32_t* Crc)
+        {
+            return ZstdDecompressInto(Src, Dst, Crc);
+        };
+        zstd.Stream = [](utils::RdBuf_t Src, SinkRef Sink)
+        {
+            return ZstdDecompress(Src, Sink);
+        };
+        r.Register(zstd);
+
+        return r;
+    }();
+
+    return registry;
+}
+
+void
+CodecRegistry::Register(
+    const Codec& C
+)
+{
+    m_Codecs.push_back(C);
+    m_Preferred.emplace(C.Method, m_Codecs.size() - 1u);
+}
+
+const Codec*
+CodecRegistry::Find(
+    uint16_t Method
+) const
+{
+    auto it = m_Preferred.find(Method);
+    return it != m_Preferred.end() ? &m_Codecs[it->second] : nullptr;
+}
+
+const Codec*
+CodecRegistry::Find(
+    uint16_t Method,
+    std::string_view Name
+) const
+{
+    for (const auto& c : m_Codecs)
+    {
+        if (c.Method == Method && c.Name == Name)
+        {
+            return &c;
+        }
+    }
+
+    return nullptr;
+}
+
+std::vector<const Codec*>
+CodecRegistry::ForMethod(
+    uint16_t Method
+) const
+{
+    std::vector<const Codec*> ret;
+    for (const auto& c : m_Codecs)
+    {
+        if (c.Method == Method)
+        {
+            ret.push_back(&c);
+        }
+    }
+
+    return ret;
+}
+
+bool
+CodecRegistry::Prefer(
+    std::string_view Name
+)
+{
+    bool found = false;
+    for (size_t i = 0; i < m_Codecs.size(); ++i)
+    {
+        if (m_Codecs[i].Name == Name)
+        {
+            m_Preferred[m_Codecs[i].Method] = i;
+            found                           = true;
+        }
+    }
+
+    return found;
+}
+
+const Codec*
+CodecRegistry::Calibrate(
+    uint16_t Method,
+    utils::RdBuf_t Sample,
+    size_t OriginalSz,
+    uint32_t Crc,
+    unsigned Rounds
+)
+{
+    //
+    // the same bound as Verify(): a sample whose size cannot be right, or
+    // is beyond the scratch limit, calibrates nothing
+    //
+    if (CheckOriginalSz(Method, Sample, OriginalSz) != Err::None || OriginalSz > VERIFY_SCRATCH_MAX)
+    {
+        return nullptr;
+    }
+
+    std::vector<unsigned char> out(OriginalSz);
+
+    size_t best     = m_Codecs.size();
+    double bestSecs = 0.0;
+
+    for (size_t k = 0; k < m_Codecs.size(); ++k)
+    {
+        const Codec& c = m_Codecs[k];
+        if (c.Method != Method || !Has(c.Caps, CodecCaps::OneShot))
+        {
+            continue;
+        }
+
+        double secs = 0.0;
+        for (unsigned i = 0; i < std::max(Rounds, 1u); ++i)
+        {
+            uint32_t crc = 0u;
+
+            auto t0 = std::chrono::steady_clock::now();
+            Err e   = c.Decode(Sample, { out.data(), out.size() }, &crc);
+            auto t1 = std::chrono::steady_clock::now();
+
+            if (e != Err::None || crc != Crc)
+            {
+                secs = -1.0;
+                break;
+            }
+
+            double s = std::chrono::duration<double>(t1 - t0).count();
+            secs     = i == 0u ? s : std::min(secs, s);
+        }
+
+        if (secs >= 0.0 && (best == m_Codecs.size() || secs < bestSecs))
+        {
+            best     = k;
+            bestSecs = secs;
+        }
+    }
+
+    if (best == m_Codecs.size())
+    {
+        return nullptr;
+    }
+
+    m_Preferred[Method] = best;
+    return &m_Codecs[best];
+}
+
+Err
+Verify(
+    const Codec& C,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz,
+    uint32_t Crc
+)
+{
+    if (C.Method == 0u)
+    {
+        return Verify(0u, FileBuf, OriginalSz, Crc);
+    }
+
+    if (C.Stream)
+    {
+        size_t produced = 0u;
+        auto count      = [&produced](utils::RdBuf_t Chunk)
+        {
+            produced += Chunk.size();
+        };
+        CrcSink<decltype(count)> sink{ count };
+
+        Err e = C.Stream(FileBuf, sink);
+        if (e != Err::None)
+        {
+            return e;
+        }
+
+        if (produced != OriginalSz)
+        {
+            return Err::SizeMismatch;
+        }
+
+        return sink.Crc() == Crc ? Err::None : Err::BadCrc;
+    }
+
+    if (!C.Decode)
+    {
+        return Err::Unsupported;
+    }
+
+    //
+    // OriginalSz comes from the headers: no allocation for what deflate
+    // cannot have produced from FileBuf, nor beyond the scratch limit
+    //
+    if (C.Method == 8u && OriginalSz / DEFLATE_MAX_RATIO > FileBuf.size())
+    {
+        return Err::SizeMismatch;
+    }
+
+    if (OriginalSz > VERIFY_SCRATCH_MAX)
+    {
+        return Err::Unsupported;
+    }
+
+    std::vector<unsigned char> scratch(OriginalSz);
+    uint32_t crc = 0u;
+
+    Err e = C.Decode(FileBuf, { scratch.data(), scratch.size() }, &crc);
+    if (e != Err::None)
+    {
+        return e;
+    }
+
+    return crc == Crc ? Err::None : Err::BadCrc;
+}
+
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "zip/Err.hpp"
+#include "zip/Sink.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/WrBuf.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace zip
+{
+
+enum class CodecCaps : unsigned
+{
+    None      = 0u,
+    OneShot   = 1u << 0, // Decode(): the whole entry into a presized buffer
+    Streaming = 1u << 1, // Stream(): the output handed to a sink in chunks
+    Parallel  = 1u << 2, // Decode() spreads a single entry across threads
+};
+
+constexpr CodecCaps
+operator|(
+    CodecCaps L,
+    CodecCaps R
+)
+{
+    return CodecCaps(unsigned(L) | unsigned(R));
+}
+
+constexpr bool
+Has(
+    CodecCaps Caps,
+    CodecCaps Flag
+)
+{
+    return (unsigned(Caps) & unsigned(Flag)) == unsigned(Flag);
+}
+
+//
+// A decoder backend for one compression method. Either function may be
+// missing, as announced by Caps.
+//
+struct Codec
+{
+    const char* Name = "";
+    uint16_t Method  = 0u;
+    CodecCaps Caps   = CodecCaps::None;
+
+    //
+    // same contract as ExtractInto(): Dst has the original size of the entry,
+    // Crc (if given) receives the CRC-32 of the output
+    //
+    Err (*Decode)(utils::RdBuf_t Src, utils::WrBuf_t Dst, uint32_t* Crc) = nullptr;
+
+    Err (*Stream)(utils::RdBuf_t Src, SinkRef Sink) = nullptr;
+};
+
+//
+// Maps compression methods to the backends that can decode them. Several
+// backends may serve the same method, one of them is the preferred one -
+// the first registered, until changed by Prefer() or Calibrate().
+//
+// Lookups are meant to happen concurrently, changes only during setup.
+//
+class CodecRegistry
+{
+public:
+    //
+    // The built-in backends: stored (0), zlib, native and parallel inflate
+    // for deflate (8), zlib being preferred, and zstd (93).
+    //
+    static CodecRegistry&
+    Default(
+        void
+    );
+
+    void
+    Register(
+        const Codec& C
+    );
+
+    //
+    // the preferred backend for Method, nullptr if there is none
+    //
+    const Codec*
+    Find(
+        uint16_t Method
+    ) const;
+
+    const Codec*
+    Find(
+        uint16_t Method,
+        std::string_view Name
+    ) const;
+
+    std::vector<const Codec*>
+    ForMethod(
+        uint16_t Method
+    ) const;
+
+    //
+    // Makes the backend called Name the preferred one for its method. False
+    // when there is no such backend.
+    //
+    bool
+    Prefer(
+        std::string_view Name
+    );
+
+    //
+    // Micro-benchmark: decodes Sample (an entry of the given original size
+    // and crc) with every one-shot backend for Method, best of Rounds, and
+    // prefers the fastest one that got it right. Returns that backend, or
+    // nullptr (and changes nothing) when none did, or when OriginalSz is
+    // more than Sample can decode to or than VERIFY_SCRATCH_MAX.
+    //
+    const Codec*
+    Calibrate(
+        uint16_t Method,
+        utils::RdBuf_t Sample,
+        size_t OriginalSz,
+        uint32_t Crc,
+        unsigned Rounds = 3u
+    );
+
+private:
+    std::deque<Codec> m_Codecs; // stable addresses, for Find() and ForMethod()
+    std::unordered_map<uint16_t, size_t> m_Preferred;
+};
+
+//
+// The largest entry that Verify() decodes into a scratch buffer, for the
+// backends that cannot stream.
+//
+constexpr size_t VERIFY_SCRATCH_MAX = size_t(1u) << 30;
+
+//
+// Checks an entry with the given backend, see zip::Verify() - stored entries
+// are checksummed straight from FileBuf, and the others streamed through a
+// CrcSink when the backend can. Otherwise they are decoded into a scratch
+// buffer of OriginalSz bytes: SizeMismatch if deflate cannot get there from
+// FileBuf, Unsupported above VERIFY_SCRATCH_MAX.
+//
+Err
+Verify(
+    const Codec& C,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz,
+    uint32_t Crc
+);
+
+template<class HeaderT>
+Err
+Verify(
+    const Codec& C,
+    const HeaderT& Hdr,
+    utils::RdBuf_t FileBuf
+)
+{
+    return Verify(C, FileBuf, Hdr.originalSz, Hdr.crc32);
+}
+
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "msg/Pos.hpp"
+#include "msg/Seg.hpp"
+#include "msg/Fmt.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/Hexed.hpp"
+#include "utils/AsBytes.hpp"
+#include "zip/LFHeader.hpp"
+
+#include <cstring>
+#include <optional>
+#include <ostream>
+#include <utility>
+
+namespace zip
+{
+
+//
+// The sizes and crc of an entry whose local header has general purpose
+// flag bit 3 set, written after its data because they were not known when
+// the header was. The signature in front of it is optional, and its sizes
+// are 64 bits wide when the local header has a zip64 extra field.
+//
+struct DataDescriptor
+{
+    static constexpr auto SIG = AsBytes<uint32_t, unsigned char>(0x08074b50);
+
+    //
+    // general purpose flag bit 3: sizes and crc follow the data
+    //
+    static constexpr uint16_t FLAG = 0x0008u;
+
+    uint32_t crc32;
+    uint64_t compressedSz;
+    uint64_t originalSz;
+
+    using Format = msg::Fmt<
+        msg::Seg<&DataDescriptor::crc32>,
+        msg::Seg<&DataDescriptor::compressedSz, msg::Pos<0u, 32u>>,
+        msg::Seg<&DataDescriptor::originalSz, msg::Pos<0u, 32u>>>;
+
+    using Format64 = msg::Fmt<
+        msg::Seg<&DataDescriptor::crc32>,
+        msg::Seg<&DataDescriptor::compressedSz>,
+        msg::Seg<&DataDescriptor::originalSz>>;
+
+    friend bool
+    operator==(const DataDescriptor& l, const DataDescriptor& r)
+    {
+        return l.crc32 == r.crc32
+            && l.compressedSz == r.compressedSz
+            && l.originalSz == r.originalSz;
+    }
+
+    friend std::ostream&
+    operator<<(std::ostream& os, const DataDescriptor& r)
+    {
+        return os
+            << "{ " << "crc32:" << utils::Hexed{ r.crc32, "0x" }
+            << ", " << "compressedSz:" << r.compressedSz
+            << ", " << "originalSz:" << r.originalSz
+            << " }";
+    }
+
+    //
+    // whether the descriptor after the data of Lfh has 64 bit sizes
+    //
+    static bool
+    IsZip64(const LFHeader& Lfh)
+    {
+        return ExtraField::Find(Lfh.exField, ExtraField::ZIP64).has_value();
+    }
+
+    //
+    // With or without the signature, whichever Buf starts with.
+    //
+    static std::pair<std::optional<DataDescriptor>, utils::RdBuf_t>
+    read(utils::RdBuf_t Buf, bool Zip64)
+    {
+        if (Buf.size() >= SIG.size() && std::memcmp(Buf.data(), SIG.data(), SIG.size()) == 0)
+        {
+            Buf = Buf.subspan(SIG.size());
+        }
+
+        std::optional<DataDescriptor> h = DataDescriptor{};
+
+        auto b = Zip64 ? Format64::read(Buf, *h) : Format::read(Buf, *h);
+        if (!b)
+        {
+            b = Buf;
+            h.reset();
+        }
+
+        return { h, *b };
+    }
+};
+
+}
@@ -0,0 +1,173 @@
+#pragma once
+
+#include "msg/Pos.hpp"
+#include "msg/Seg.hpp"
+#include "msg/Fmt.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/Hexed.hpp"
+#include "utils/AsBytes.hpp"
+
+#include <optional>
+#include <ostream>
+
+namespace zip
+{
+
+//
+// The zip64 end of central directory record, which holds the full width
+// counts and offsets whenever those of the EOCDRec that follows it are
+// saturated. The extensible data sector after it is not read.
+//
+struct EOCD64Rec
+{
+    static constexpr auto SIG = AsBytes<uint32_t, unsigned char>(0x06064b50);
+
+    uint32_t sig;
+    uint64_t sizeOfRecord; // not counting sig and sizeOfRecord
+    uint16_t verMadeBy;
+    uint16_t verNeeded;
+    uint32_t thisDiskNum;
+    uint32_t startDiskNum;
+    uint64_t totalEntriesThisDisk;
+    uint64_t totalEntries;
+    uint64_t sizeOfCentralDir;
+    uint64_t offsetOfCentralDir;
+
+    using Format = msg::Fmt<
+        msg::Seg<&EOCD64Rec::sig>,
+        msg::Seg<&EOCD64Rec::sizeOfRecord>,
+        msg::Seg<&EOCD64Rec::verMadeBy>,
+        msg::Seg<&EOCD64Rec::verNeeded>,
+        msg::Seg<&EOCD64Rec::thisDiskNum>,
+        msg::Seg<&EOCD64Rec::startDiskNum>,
+        msg::Seg<&EOCD64Rec::totalEntriesThisDisk>,
+        msg::Seg<&EOCD64Rec::totalEntries>,
+        msg::Seg<&EOCD64Rec::sizeOfCentralDir>,
+        msg::Seg<&EOCD64Rec::offsetOfCentralDir>>;
+
+    friend bool
+    operator==(const EOCD64Rec& l, const EOCD64Rec& r)
+    {
+        return l.sig == r.sig
+            && l.sizeOfRecord == r.sizeOfRecord
+            && l.verMadeBy == r.verMadeBy
+            && l.verNeeded == r.verNeeded
+            && l.thisDiskNum == r.thisDiskNum
+            && l.startDiskNum == r.startDiskNum
+            && l.totalEntriesThisDisk == r.totalEntriesThisDisk
+            && l.totalEntries == r.totalEntries
+            && l.sizeOfCentralDir == r.sizeOfCentralDir
+            && l.offsetOfCentralDir == r.offsetOfCentralDir;
+    }
+
+    friend std::ostream&
+    operator<<(std::ostream& os, const EOCD64Rec& r)
+    {
+        return os
+            << "{ " << "sig:" << utils::Hexed{ r.sig, "0x", 8 }
+            << ", " << "sizeOfRecord:" << r.sizeOfRecord
+            << ", " << "verMadeBy:" << r.verMadeBy
+            << ", " << "verNeeded:" << r.verNeeded
+            << ", " << "thisDiskNum:" << r.thisDiskNum
+            << ", " << "startDiskNum:" << r.startDiskNum
+            << ", " << "totalEntriesThisDisk:" << r.totalEntriesThisDisk
+            << ", " << "totalEntries:" << r.totalEntries
+            << ", " << "sizeOfCentralDir:" << r.sizeOfCentralDir
+            << ", " << "offsetOfCentralDir:" << r.offsetOfCentralDir
+            << " }";
+    }
+
+    static size_t
+    MinBytes()
+    {
+        return Format::MinBytes();
+    }
+
+    static size_t
+    MaxBytes()
+    {
+        return Format::MaxBytes();
+    }
+
+    static std::optional<EOCD64Rec>
+    read(utils::RdBuf_t Buf)
+    {
+        std::optional<EOCD64Rec> h = EOCD64Rec{};
+
+        auto b = Format::read(Buf, *h);
+        if (!b)
+        {
+            h.reset();
+        }
+
+        return h;
+    }
+};
+
+//
+// Right in front of the EOCDRec of a zip64 archive: where to find the
+// EOCD64Rec.
+//
+struct EOCD64Locator
+{
+    static constexpr auto SIG = AsBytes<uint32_t, unsigned char>(0x07064b50);
+
+    uint32_t sig;
+    uint32_t startDiskNum;
+    uint64_t offsetOfEOCD64;
+    uint32_t totalDisks;
+
+    using Format = msg::Fmt<
+        msg::Seg<&EOCD64Locator::sig>,
+        msg::Seg<&EOCD64Locator::startDiskNum>,
+        msg::Seg<&EOCD64Locator::offsetOfEOCD64>,
+        msg::Seg<&EOCD64Locator::totalDisks>>;
+
+    friend bool
+    operator==(const EOCD64Locator& l, const EOCD64Locator& r)
+    {
+        return l.sig == r.sig
+            && l.startDiskNum == r.startDiskNum
+            && l.offsetOfEOCD64 == r.offsetOfEOCD64
+            && l.totalDisks == r.totalDisks;
+    }
+
+    friend std::ostream&
+    operator<<(std::ostream& os, const EOCD64Locator& r)
+    {
+        return os
+            << "{ " << "sig:" << utils::Hexed{ r.sig, "0x", 8 }
+            << ", " << "startDiskNum:" << r.startDiskNum
+            << ", " << "offsetOfEOCD64:" << r.offsetOfEOCD64
+            << ", " << "totalDisks:" << r.totalDisks
+            << " }";
+    }
+
+    static size_t
+    MinBytes()
+    {
+        return Format::MinBytes();
+    }
+
+    static size_t
+    MaxBytes()
+    {
+        return Format::MaxBytes();
+    }
+
+    static std::optional<EOCD64Locator>
+    read(utils::RdBuf_t Buf)
+    {
+        std::optional<EOCD64Locator> h = EOCD64Locator{};
+
+        auto b = Format::read(Buf, *h);
+        if (!b)
+        {
+            h.reset();
+        }
+
+        return h;
+    }
+};
+
+}
@@ -23,10 +23,10 @@ struct EOCDRec
     uint32_t sig;
     uint16_t thisDiskNum;
     uint16_t startDiskNum;
-    uint16_t totalEntriesThisDisk;
-    uint16_t totalEntries;
-    uint32_t sizeOfCentralDir;
-    uint32_t offsetOfCentralDir;
+    uint64_t totalEntriesThisDisk; // 16 bits, unless from the EOCD64Rec
+    uint64_t totalEntries;         // 16 bits, unless from the EOCD64Rec
+    uint64_t sizeOfCentralDir;     // 32 bits, unless from the EOCD64Rec
+    uint64_t offsetOfCentralDir;   // 32 bits, unless from the EOCD64Rec
     uint16_t commentLen;
     utils::RdBuf_t comment;
 
@@ -34,10 +34,10 @@ struct EOCDRec
         msg::Seg<&EOCDRec::sig>,
         msg::Seg<&EOCDRec::thisDiskNum>,
         msg::Seg<&EOCDRec::startDiskNum>,
-        msg::Seg<&EOCDRec::totalEntriesThisDisk>,
-        msg::Seg<&EOCDRec::totalEntries>,
-        msg::Seg<&EOCDRec::sizeOfCentralDir>,
-        msg::Seg<&EOCDRec::offsetOfCentralDir>,
+        msg::Seg<&EOCDRec::totalEntriesThisDisk, msg::Pos<0u, 16u>>,
+        msg::Seg<&EOCDRec::totalEntries, msg::Pos<0u, 16u>>,
+        msg::Seg<&EOCDRec::sizeOfCentralDir, msg::Pos<0u, 32u>>,
+        msg::Seg<&EOCDRec::offsetOfCentralDir, msg::Pos<0u, 32u>>,
         msg::Seg<&EOCDRec::commentLen>,
         msg::Seg<&EOCDRec::comment, msg::Dyn<&EOCDRec::commentLen>>>;
 
@@ -0,0 +1,180 @@
+#include "zip/EntryReader.hpp"
+#include "utils/Crc32.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace zip
+{
+
+EntryReader::EntryReader(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz,
+    uint32_t Crc,
+    const EntryReaderConfig& Config
+)
+  : m_Method(Method)
+  , m_In(FileBuf)
+  , m_OriginalSz(OriginalSz)
+  , m_ExpectedCrc(Crc)
+  , m_ChunkSize(std::max<size_t>(Config.ChunkSize, 1u))
+{
+    if (Method == 8u)
+    {
+        m_Ctx = std::make_unique<InflateContext>();
+        m_Err = m_Ctx->IsValid() ? m_Ctx->Begin() : Err::BadInit;
+    }
+    else if (Method == 0u)
+    {
+        m_Err = FileBuf.size() == OriginalSz ? Err::None : Err::SizeMismatch;
+    }
+    else
+    {
+        m_Err = Err::Unsupported;
+    }
+}
+
+utils::Expected<size_t, Err>
+EntryReader::Read(
+    utils::WrBuf_t Dst
+)
+{
+    auto fail = [this](Err E)
+    {
+        m_Err = E;
+        return utils::UnExpected{ E };
+    };
+
+    if (m_Err != Err::None)
+    {
+        return fail(m_Err);
+    }
+
+    if (m_Done || Dst.empty())
+    {
+        return size_t(0u);
+    }
+
+    size_t n = 0u;
+    bool end = false;
+
+    if (m_Method == 0u)
+    {
+        n = std::min(Dst.size(), m_In.size());
+        std::memcpy(Dst.data(), m_In.data(), n);
+
+        m_In = m_In.subspan(n);
+        end  = m_In.empty();
+    }
+    else
+    {
+        //
+        // Never more than announced: Dst is cut to what is left, and once
+        // that is reached the stream has to end without producing anything.
+        //
+        utils::WrBuf_t dst = Dst.first(std::min(Dst.size(), m_OriginalSz - m_Produced));
+
+        while (n == 0u && !end)
+        {
+            unsigned char extra[1];
+
+            Err e = m_Ctx->Step(m_In, dst.empty() ? utils::WrBuf_t{ extra, 1u } : dst, n, end);
+            if (e != Err::None)
+            {
+                return fail(e);
+            }
+
+            if (dst.empty() && n != 0u)
+            {
+                return fail(Err::SizeMismatch);
+            }
+        }
+    }
+
+    m_Crc = utils::Crc32(m_Crc, { Dst.data(), n });
+    m_Produced += n;
+
+    if (end)
+    {
+        Err e = Finish();
+        if (e != Err::None)
+        {
+            return fail(e);
+        }
+    }
+
+    return n;
+}
+
+utils::Expected<utils::RdBuf_t, Err>
+EntryReader::Next(
+    void
+)
+{
+    if (m_Err != Err::None)
+    {
+        return utils::UnExpected{ m_Err };
+    }
+
+    if (m_Method != 0u)
+    {
+        m_Buf.resize(m_ChunkSize);
+
+        auto n = Read({ m_Buf.data(), m_Buf.size() });
+        if (n.HasError())
+        {
+            return utils::UnExpected{ n.Error() };
+        }
+
+        return utils::RdBuf_t{ m_Buf.data(), n.Value() };
+    }
+
+    if (m_Done)
+    {
+        return utils::RdBuf_t{};
+    }
+
+    //
+    // stored: the chunk is a piece of the mapping itself
+    //
+    utils::RdBuf_t chunk = m_In.first(std::min(m_ChunkSize, m_In.size()));
+
+    m_In  = m_In.subspan(chunk.size());
+    m_Crc = utils::Crc32(m_Crc, chunk);
+    m_Produced += chunk.size();
+
+    if (m_In.empty())
+    {
+        Err e = Finish();
+        if (e != Err::None)
+        {
+            m_Err = e;
+            return utils::UnExpected{ e };
+        }
+    }
+
+    return chunk;
+}
+
+Err
+EntryReader::Finish(
+    void
+)
+{
+    m_Done = true;
+
+    //
+    // the inflate state is not needed anymore, no point in holding on to it
+    //
+    m_Ctx.reset();
+
+    if (m_Produced != m_OriginalSz)
+    {
+        return Err::SizeMismatch;
+    }
+
+    return m_Crc == m_ExpectedCrc ? Err::None : Err::BadCrc;
+}
+
+}
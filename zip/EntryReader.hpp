@@ -0,0 +1,128 @@
+#pragma once
+
+#include "zip/Err.hpp"
+#include "zip/InflateContext.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/WrBuf.hpp"
+#include "utils/Expected.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace zip
+{
+
+struct EntryReaderConfig
+{
+    //
+    // size of the buffer behind Next() - the only memory a reader holds on
+    // top of the inflate state (an InflateContext, for deflated entries)
+    //
+    size_t ChunkSize = 64u * 1024u;
+};
+
+//
+// Pull-style access to the data of a single entry: the caller asks for the
+// next piece of output when it is ready for it, and the inflate stream stays
+// suspended in between - so many entries can be streamed side by side, e.g.
+// to sockets, without a thread (or the whole output) per entry.
+//
+// Stored and deflated entries are supported. The crc is taken as the output
+// goes by and checked when the end is reached, as are the sizes.
+//
+class EntryReader
+{
+public:
+    EntryReader(
+        uint16_t Method,
+        utils::RdBuf_t FileBuf,
+        size_t OriginalSz,
+        uint32_t Crc,
+        const EntryReaderConfig& Config = {}
+    );
+
+    //
+    // For CDFHeader and LFHeader, see ExtractToVector().
+    //
+    template<class HeaderT>
+    EntryReader(
+        const HeaderT& Hdr,
+        utils::RdBuf_t FileBuf,
+        const EntryReaderConfig& Config = {}
+    )
+      : EntryReader(Hdr.compression, FileBuf, Hdr.originalSz, Hdr.crc32, Config)
+    {
+    }
+
+    //
+    // Fills the front of Dst with the next output, returning how many bytes
+    // were written - 0 only once the entry is done (or Dst is empty). Errors
+    // stick: every call after a failed one fails the same way.
+    //
+    utils::Expected<size_t, Err>
+    Read(
+        utils::WrBuf_t Dst
+    );
+
+    //
+    // Like Read(), but hands out up to Config.ChunkSize bytes without a copy
+    // into caller memory: for stored entries straight from FileBuf, for
+    // deflated ones from the reader's own buffer. The chunk stays valid
+    // until the next call. An empty chunk means the entry is done.
+    //
+    utils::Expected<utils::RdBuf_t, Err>
+    Next(
+        void
+    );
+
+    bool
+    Done(
+        void
+    ) const
+    {
+        return m_Done;
+    }
+
+    //
+    // output handed out so far
+    //
+    size_t
+    Produced(
+        void
+    ) const
+    {
+        return m_Produced;
+    }
+
+    size_t
+    OriginalSz(
+        void
+    ) const
+    {
+        return m_OriginalSz;
+    }
+
+private:
+    Err
+    Finish(
+        void
+    );
+
+    uint16_t m_Method;
+    utils::RdBuf_t m_In;
+    size_t m_OriginalSz;
+    uint32_t m_ExpectedCrc;
+    size_t m_ChunkSize;
+
+    std::unique_ptr<InflateContext> m_Ctx;
+    std::vector<unsigned char> m_Buf;
+
+    size_t m_Produced = 0u;
+    uint32_t m_Crc    = 0u;
+    bool m_Done       = false;
+    Err m_Err         = Err::None;
+};
+
+}
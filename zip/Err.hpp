@@ -0,0 +1,42 @@
+#pragma once
+
+#include <ostream>
+
+namespace zip
+{
+
+enum class Err
+{
+    None,
+    BadInit,      // the decoder could not be set up
+    BadData,      // the compressed data is corrupt or truncated
+    SizeMismatch, // the output size differs from what the headers announced
+    Unsupported,  // the compression method is not implemented
+    BadCrc,       // the output does not match the crc32 from the headers
+    Io,           // a file could not be read or written
+};
+
+inline const char*
+ToString(Err E)
+{
+    switch (E)
+    {
+        case Err::None:         return "none";
+        case Err::BadInit:      return "bad init";
+        case Err::BadData:      return "bad data";
+        case Err::SizeMismatch: return "size mismatch";
+        case Err::Unsupported:  return "unsupported";
+        case Err::BadCrc:       return "bad crc";
+        case Err::Io:           return "io";
+    }
+
+    return "unknown";
+}
+
+inline std::ostream&
+operator<<(std::ostream& Os, Err E)
+{
+    return Os << ToString(E);
+}
+
+}
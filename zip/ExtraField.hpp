@@ -0,0 +1,156 @@
+#pragma once
+
+#include "msg/Pos.hpp"
+#include "msg/Seg.hpp"
+#include "msg/Fmt.hpp"
+#include "msg/Dyn.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/Hexed.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <optional>
+#include <ostream>
+#include <utility>
+
+namespace zip
+{
+
+//
+// One record of the extra field of a local or central directory header.
+//
+struct ExtraField
+{
+    static constexpr uint16_t ZIP64 = 0x0001u;
+
+    uint16_t id;
+    uint16_t dataLen;
+    utils::RdBuf_t data;
+
+    using Format = msg::Fmt<
+        msg::Seg<&ExtraField::id>,
+        msg::Seg<&ExtraField::dataLen>,
+        msg::Seg<&ExtraField::data, msg::Dyn<&ExtraField::dataLen>>>;
+
+    friend bool
+    operator==(const ExtraField& l, const ExtraField& r)
+    {
+        return l.id == r.id
+            && l.dataLen == r.dataLen
+            && l.data == r.data;
+    }
+
+    friend std::ostream&
+    operator<<(std::ostream& os, const ExtraField& r)
+    {
+        return os
+            << "{ " << "id:" << utils::Hexed{ r.id, "0x", 4 }
+            << ", " << "data:" << "[" << r.data.size() << "...]"
+            << " }";
+    }
+
+    static size_t
+    MinBytes()
+    {
+        return Format::MinBytes();
+    }
+
+    static size_t
+    MaxBytes()
+    {
+        return Format::MaxBytes();
+    }
+
+    static std::pair<std::optional<ExtraField>, utils::RdBuf_t>
+    read(utils::RdBuf_t Buf)
+    {
+        std::optional<ExtraField> h = ExtraField{};
+
+        auto b = Format::read(Buf, *h);
+        if (!b)
+        {
+            b = Buf;
+            h.reset();
+        }
+
+        return { h, *b };
+    }
+
+    //
+    // The first record with the given id in ExFields, the whole extra field
+    // of a header.
+    //
+    static std::optional<ExtraField>
+    Find(utils::RdBuf_t ExFields, uint16_t Id)
+    {
+        while (!ExFields.empty())
+        {
+            auto [f, rem] = read(ExFields);
+            if (!f)
+            {
+                break;
+            }
+
+            if (f->id == Id)
+            {
+                return f;
+            }
+
+            ExFields = rem;
+        }
+
+        return std::nullopt;
+    }
+};
+
+//
+// A 32 bit header field that defers to the zip64 extended information extra
+// field.
+//
+constexpr uint64_t ZIP64_SATURATED = 0xffffffffu;
+
+//
+// The zip64 extended information extra field holds 64 bit values for the
+// saturated fields of its header, in a fixed order (original size,
+// compressed size, local header offset) and only for those. Fields lists
+// them in that order, with nullptr for the ones the header has in full;
+// each of the others is overwritten by the next 8 bytes of the record.
+//
+// False (and nothing overwritten) if there is no such record or it is too
+// short.
+//
+inline bool
+ReadZip64(utils::RdBuf_t ExFields, std::initializer_list<uint64_t*> Fields)
+{
+    auto f = ExtraField::Find(ExFields, ExtraField::ZIP64);
+    if (!f)
+    {
+        return false;
+    }
+
+    size_t need = 0u;
+    for (uint64_t* field : Fields)
+    {
+        need += field != nullptr ? sizeof(uint64_t) : 0u;
+    }
+
+    if (f->data.size() < need)
+    {
+        return false;
+    }
+
+    const unsigned char* p = f->data.data();
+    for (uint64_t* field : Fields)
+    {
+        if (field != nullptr)
+        {
+            std::memcpy(field, p, sizeof(uint64_t));
+            p += sizeof(uint64_t);
+        }
+    }
+
+    return true;
+}
+
+}
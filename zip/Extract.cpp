@@ -0,0 +1,335 @@
+#include "zip/Extract.hpp"
+#include "zip/InflateContext.hpp"
+#include "zip/Stored.hpp"
+#include "zip/Zstd.hpp"
+#include "utils/Crc32.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace zip
+{
+
+Err
+ExtractInto(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    utils::WrBuf_t Dst,
+    InflateBackend Backend,
+    uint32_t* Crc
+)
+{
+    if (Method == 8u)
+    {
+        return InflateInto(FileBuf, Dst, Backend, Crc);
+    }
+    else if (Method == ZSTD_METHOD)
+    {
+        return ZstdDecompressInto(FileBuf, Dst, Crc);
+    }
+    else if (Method == 0u)
+    {
+        if (FileBuf.size() != Dst.size())
+        {
+            return Err::SizeMismatch;
+        }
+
+        //
+        // copy in slices, checksumming each one from the freshly written
+        // (cached) destination rather than from the mapping
+        //
+        uint32_t crc = 0u;
+        for (size_t off = 0u; off < Dst.size(); off += STORED_SLICE)
+        {
+            size_t n = std::min(Dst.size() - off, STORED_SLICE);
+            std::memcpy(Dst.data() + off, FileBuf.data() + off, n);
+
+            if (Crc)
+            {
+                crc = utils::Crc32(crc, { Dst.data() + off, n });
+            }
+        }
+
+        if (Crc)
+        {
+            *Crc = crc;
+        }
+
+        return Err::None;
+    }
+
+    return Err::Unsupported;
+}
+
+Err
+CheckOriginalSz(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz
+)
+{
+    if (Method == 0u && OriginalSz != FileBuf.size())
+    {
+        return Err::SizeMismatch;
+    }
+
+    if (Method == 8u && OriginalSz / DEFLATE_MAX_RATIO > FileBuf.size())
+    {
+        return Err::SizeMismatch;
+    }
+
+    return Err::None;
+}
+
+utils::Expected<std::vector<unsigned char>, Err>
+ExtractToVector(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz,
+    InflateBackend Backend,
+    uint32_t* Crc
+)
+{
+    Err e = CheckOriginalSz(Method, FileBuf, OriginalSz);
+    if (e != Err::None)
+    {
+        return utils::UnExpected{ e };
+    }
+
+    std::vector<unsigned char> out(OriginalSz);
+
+    e = ExtractInto(Method, FileBuf, { out.data(), out.size() }, Backend, Crc);
+    if (e != Err::None)
+    {
+        return utils::UnExpected{ e };
+    }
+
+    return out;
+}
+
+Err
+Verify(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz,
+    uint32_t Crc,
+    InflateBackend Backend,
+    const utils::Crc32ParallelConfig& Config
+)
+{
+    uint32_t crc = 0u;
+
+    if (Method == 0u)
+    {
+        if (FileBuf.size() != OriginalSz)
+        {
+            return Err::SizeMismatch;
+        }
+
+        crc = utils::Crc32Parallel(0u, FileBuf, Config);
+    }
+    else if (Method == 8u && Backend == InflateBackend::Zlib)
+    {
+        //
+        // stepped through a pooled context in fixed chunks, none of the
+        // output is kept
+        //
+        auto ctx = InflateContextPool::ThreadLocal().Acquire();
+        Err e    = ctx->Begin();
+        if (e != Err::None)
+        {
+            return e;
+        }
+
+        constexpr size_t CHUNK = 16384u;
+        unsigned char out[CHUNK];
+
+        utils::RdBuf_t src = FileBuf;
+        size_t total       = 0u;
+        bool end           = false;
+        while (!end)
+        {
+            size_t produced = 0u;
+            e               = ctx->Step(src, { out, sizeof out }, produced, end);
+            if (e != Err::None)
+            {
+                return e;
+            }
+
+            total += produced;
+            if (total > OriginalSz)
+            {
+                return Err::SizeMismatch;
+            }
+
+            crc = utils::Crc32(crc, { out, produced });
+        }
+
+        if (total != OriginalSz)
+        {
+            return Err::SizeMismatch;
+        }
+    }
+    else if (Method == ZSTD_METHOD)
+    {
+        size_t total = 0u;
+        auto count   = [&total](utils::RdBuf_t Chunk)
+        {
+            total += Chunk.size();
+        };
+        CrcSink<decltype(count)> sink{ count };
+
+        Err e = ZstdDecompress(FileBuf, sink);
+        if (e != Err::None)
+        {
+            return e;
+        }
+
+        if (total != OriginalSz)
+        {
+            return Err::SizeMismatch;
+        }
+
+        crc = sink.Crc();
+    }
+    else if (Method == 8u)
+    {
+        //
+        // the other backends only decode whole entries, into a scratch
+        // buffer that ExtractToVector() checks the size of first
+        //
+        auto out = ExtractToVector(Method, FileBuf, OriginalSz, Backend, &crc);
+        if (out.HasError())
+        {
+            return out.Error();
+        }
+    }
+    else
+    {
+        return Err::Unsupported;
+    }
+
+    return crc == Crc ? Err::None : Err::BadCrc;
+}
+
+Err
+ReadRange(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz,
+    uint32_t Crc,
+    AccessIndex& Index,
+    uint64_t Offset,
+    utils::WrBuf_t Dst
+)
+{
+    if (Method == 0u)
+    {
+        if (FileBuf.size() != OriginalSz)
+        {
+            return Err::SizeMismatch;
+        }
+
+        if (Offset > OriginalSz || Dst.size() > OriginalSz - Offset)
+        {
+            return Err::SizeMismatch;
+        }
+
+        std::memcpy(Dst.data(), FileBuf.data() + Offset, Dst.size());
+        return Err::None;
+    }
+    else if (Method != 8u)
+    {
+        return Err::Unsupported;
+    }
+
+    if (!Index.Matches(FileBuf.size(), OriginalSz, Crc))
+    {
+        auto built = AccessIndex::Build(FileBuf);
+        if (built.HasError())
+        {
+            return built.Error();
+        }
+
+        if (built.Value().OriginalSz() != OriginalSz)
+        {
+            return Err::SizeMismatch;
+        }
+
+        if (built.Value().Crc() != Crc)
+        {
+            return Err::BadCrc;
+        }
+
+        Index = std::move(built.Value());
+    }
+
+    return Index.ReadRange(FileBuf, Offset, Dst);
+}
+
+utils::Expected<size_t, Err>
+ExtractHead(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz,
+    utils::WrBuf_t Dst
+)
+{
+    utils::WrBuf_t dst = Dst.first(std::min(Dst.size(), OriginalSz));
+
+    if (Method == 0u)
+    {
+        if (FileBuf.size() != OriginalSz)
+        {
+            return utils::UnExpected{ Err::SizeMismatch };
+        }
+
+        std::memcpy(dst.data(), FileBuf.data(), dst.size());
+        return dst.size();
+    }
+    else if (Method == ZSTD_METHOD)
+    {
+        return ZstdDecompressHead(FileBuf, dst);
+    }
+    else if (Method != 8u)
+    {
+        return utils::UnExpected{ Err::Unsupported };
+    }
+
+    auto ctx = InflateContextPool::ThreadLocal().Acquire();
+
+    Err e = ctx->Begin();
+    if (e != Err::None)
+    {
+        return utils::UnExpected{ e };
+    }
+
+    //
+    // zlib stops as soon as the output is full, and only ever reads the
+    // input it needs to get there
+    //
+    size_t produced = 0u;
+    bool end        = false;
+    while (produced < dst.size() && !end)
+    {
+        size_t n = 0u;
+
+        e = ctx->Step(FileBuf, dst.subspan(produced), n, end);
+        if (e != Err::None)
+        {
+            return utils::UnExpected{ e };
+        }
+
+        produced += n;
+    }
+
+    if (produced < dst.size())
+    {
+        return utils::UnExpected{ Err::SizeMismatch };
+    }
+
+    return produced;
+}
+
+}
@@ -0,0 +1,174 @@
+#pragma once
+
+#include "zip/Err.hpp"
+#include "zip/Inflate.hpp"
+#include "zip/AccessIndex.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/WrBuf.hpp"
+#include "utils/Expected.hpp"
+#include "utils/Crc32.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zip
+{
+
+//
+// Decodes the data of an entry stored with the given compression method into
+// Dst, which has to be presized to the original size of the entry. When Crc
+// is given, it receives the CRC-32 of the output, computed while decoding.
+//
+Err
+ExtractInto(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    utils::WrBuf_t Dst,
+    InflateBackend Backend = InflateBackend::Zlib,
+    uint32_t* Crc = nullptr
+);
+
+//
+// Checks an original size from the headers against the data it is to be
+// decoded from, before anything is allocated for it: a stored entry is
+// exactly FileBuf, a deflated one at most DEFLATE_MAX_RATIO times it.
+// Err::SizeMismatch when the size cannot be right.
+//
+Err
+CheckOriginalSz(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz
+);
+
+//
+// ExtractInto() a vector of OriginalSz bytes, once CheckOriginalSz() agrees.
+//
+utils::Expected<std::vector<unsigned char>, Err>
+ExtractToVector(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz,
+    InflateBackend Backend = InflateBackend::Zlib,
+    uint32_t* Crc = nullptr
+);
+
+//
+// Convenience for CDFHeader and LFHeader - prefer passing the central
+// directory header, the local one may not carry sizes or crc (flag bit 3).
+// The output is verified against the crc32 of the header, a mismatch is
+// reported as Err::BadCrc.
+//
+template<class HeaderT>
+utils::Expected<std::vector<unsigned char>, Err>
+ExtractToVector(
+    const HeaderT& Hdr,
+    utils::RdBuf_t FileBuf,
+    InflateBackend Backend = InflateBackend::Zlib
+)
+{
+    uint32_t crc = 0u;
+
+    auto out = ExtractToVector(Hdr.compression, FileBuf, Hdr.originalSz, Backend, &crc);
+    if (out.HasValue() && crc != Hdr.crc32)
+    {
+        return utils::UnExpected{ Err::BadCrc };
+    }
+
+    return out;
+}
+
+//
+// Checks the data of an entry against Crc, without handing the output to
+// anyone. Stored entries are checksummed straight from the mapping - split
+// across threads once they reach Config.Threshold (utils::Crc32Parallel) -
+// compressed ones are decoded in fixed chunks, and the output dropped. The
+// Native and Parallel backends only decode whole entries, into a scratch
+// buffer of OriginalSz bytes once that is a size deflate can reach.
+//
+Err
+Verify(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz,
+    uint32_t Crc,
+    InflateBackend Backend = InflateBackend::Zlib,
+    const utils::Crc32ParallelConfig& Config = {}
+);
+
+template<class HeaderT>
+Err
+Verify(
+    const HeaderT& Hdr,
+    utils::RdBuf_t FileBuf,
+    InflateBackend Backend = InflateBackend::Zlib,
+    const utils::Crc32ParallelConfig& Config = {}
+)
+{
+    return Verify(Hdr.compression, FileBuf, Hdr.originalSz, Hdr.crc32, Backend, Config);
+}
+
+//
+// Reads bytes [Offset, Offset + Dst.size()) of an entry, without decoding
+// everything in front of them. Stored entries are copied straight from
+// FileBuf, deflated ones are read through Index - which is built on first
+// use (a single pass over the member, checked against Crc) and rebuilt when
+// it does not match the entry, e.g. after being deserialized for another
+// one. A range reaching past the end of the entry is Err::SizeMismatch.
+//
+Err
+ReadRange(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz,
+    uint32_t Crc,
+    AccessIndex& Index,
+    uint64_t Offset,
+    utils::WrBuf_t Dst
+);
+
+template<class HeaderT>
+Err
+ReadRange(
+    const HeaderT& Hdr,
+    utils::RdBuf_t FileBuf,
+    AccessIndex& Index,
+    uint64_t Offset,
+    utils::WrBuf_t Dst
+)
+{
+    return ReadRange(Hdr.compression, FileBuf, Hdr.originalSz, Hdr.crc32, Index, Offset, Dst);
+}
+
+//
+// Decodes only the first Dst.size() bytes of an entry (all of it, when the
+// entry is shorter) and stops right there: the rest of the compressed data
+// is never read, so for a large entry only the first few pages of it are
+// faulted in. Meant for sniffing - magic bytes, the header line of a CSV.
+//
+// Returns the number of bytes written to Dst. Since the entry is not decoded
+// to the end, there is no crc to check; a stream that ends before it has
+// produced what is asked for (and announced by OriginalSz) is reported as
+// Err::SizeMismatch.
+//
+utils::Expected<size_t, Err>
+ExtractHead(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz,
+    utils::WrBuf_t Dst
+);
+
+template<class HeaderT>
+utils::Expected<size_t, Err>
+ExtractHead(
+    const HeaderT& Hdr,
+    utils::RdBuf_t FileBuf,
+    utils::WrBuf_t Dst
+)
+{
+    return ExtractHead(Hdr.compression, FileBuf, Hdr.originalSz, Dst);
+}
+
+}
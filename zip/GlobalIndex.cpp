@@ -0,0 +1,603 @@
+#include "zip/GlobalIndex.hpp"
+#include "zip/Archive.hpp"
+#include "zip/CDScan.hpp"
+#include "zip/SidecarIndex.hpp"
+#include "utils/AsPlainStringView.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+namespace zip::Impl
+{
+
+constexpr uint32_t GLOBAL_MAGIC   = 0x5849475au; // "ZGIX"
+constexpr uint32_t GLOBAL_VERSION = 1u;
+constexpr uint32_t GLOBAL_EMPTY   = ~uint32_t(0u);
+
+static_assert(
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+    "the global index format is little endian, and is mapped as is"
+);
+
+//
+// The distinct names of one archive, in central directory order, with
+// where their headers are.
+//
+struct ArchiveNames
+{
+    uint64_t size        = 0u;
+    uint32_t fingerprint = 0u;
+    std::vector<char> nameBytes;
+    std::vector<uint64_t> nameOffset{ 0u };
+    std::vector<uint64_t> cdOffset;
+    std::vector<uint16_t> cdir;
+    std::vector<uint32_t> id; // into the names of the whole index
+
+    size_t
+    Size(
+        void
+    ) const
+    {
+        return cdOffset.size();
+    }
+
+    std::string_view
+    Name(
+        size_t I
+    ) const
+    {
+        return { nameBytes.data() + nameOffset[I], size_t(nameOffset[I + 1u] - nameOffset[I]) };
+    }
+};
+
+//
+// Just the central directories - unlike opening an Archive, without
+// building a name index that would be thrown away right after.
+//
+ArchiveNames
+ReadNames(
+    const char* Path
+)
+{
+    ArchiveNames a;
+
+    utils::MemoryMappedFile file{ Path };
+    if (!file.IsValid())
+    {
+        return a;
+    }
+
+    const utils::RdBuf_t zipBuf   = file.Buffer();
+    const std::vector<CDir> cdirs = GetPotentialCDir(zipBuf);
+    if (cdirs.empty())
+    {
+        return a;
+    }
+
+    a.size        = zipBuf.size();
+    a.fingerprint = SidecarIndex::Fingerprint(zipBuf, cdirs);
+
+    size_t expected = 0u;
+    for (const auto& cdir : cdirs)
+    {
+        expected += cdir.eocd.totalEntries;
+    }
+
+    //
+    // the first of several equal names wins, as in the archive itself
+    //
+    NameIndex seen{ zipBuf, expected };
+    for (size_t k = 0; k < cdirs.size(); ++k)
+    {
+        ForEachCDFHeader(
+            cdirs[k],
+            zipBuf,
+            [&, k](const CDFHeader& Cdfh, uint64_t CdOffset)
+            {
+                if (seen.Insert(utils::AsPlainStringView(Cdfh.name), CdOffset, uint16_t(k)))
+                {
+                    a.nameBytes.insert(a.nameBytes.end(), Cdfh.name.begin(), Cdfh.name.end());
+                    a.nameOffset.push_back(a.nameBytes.size());
+                    a.cdOffset.push_back(CdOffset);
+                    a.cdir.push_back(uint16_t(k));
+                }
+                return true;
+            }
+        );
+    }
+
+    return a;
+}
+
+//
+// Func(bit) for the Hashes bits of a name in a filter of Bits bits (a power
+// of two), by double hashing: the second hash is odd, so that the probes
+// do not repeat.
+//
+template<class FuncT>
+bool
+ForEachBloomBit(
+    uint64_t Hash,
+    uint32_t Hashes,
+    uint64_t Bits,
+    FuncT Func
+)
+{
+    const uint64_t h2 = (Hash >> 32) | 1u;
+    for (uint32_t i = 0; i < Hashes; ++i)
+    {
+        if (!Func((Hash + i * h2) & (Bits - 1u)))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+}
+
+namespace zip
+{
+
+Err
+GlobalIndex::Write(
+    const std::vector<std::string>& ArchivePaths,
+    const char* Path,
+    const GlobalIndexConfig& Config
+)
+{
+    const size_t archives = ArchivePaths.size();
+    if (archives >= Impl::GLOBAL_EMPTY || Config.BloomHashes == 0u || Config.BloomHashes > 64u || Config.BloomBitsPerName == 0u)
+    {
+        return Err::Unsupported;
+    }
+
+    //
+    // the archives are handed out one at a time: their sizes vary a lot
+    //
+    size_t threads = Config.Threads ? Config.Threads : std::max(1u, std::thread::hardware_concurrency());
+    threads        = std::min(threads, std::max<size_t>(1u, archives));
+
+    std::vector<Impl::ArchiveNames> names(archives);
+    std::atomic<size_t> next{ 0u };
+    Impl::ForEachPart(
+        threads,
+        [&](size_t)
+        {
+            for (size_t i = next++; i < archives; i = next++)
+            {
+                names[i] = Impl::ReadNames(ArchivePaths[i].c_str());
+            }
+        }
+    );
+
+    //
+    // the distinct names, and for each the number of archives it is in
+    //
+    std::unordered_map<std::string_view, uint32_t> ids;
+    std::vector<uint64_t> nameOffset{ 0u };
+    std::vector<char> nameData;
+    std::vector<uint64_t> nameEntries{ 0u };
+    uint64_t entries = 0u;
+
+    for (auto& a : names)
+    {
+        a.id.reserve(a.Size());
+        for (size_t j = 0; j < a.Size(); ++j)
+        {
+            auto [it, added] = ids.emplace(a.Name(j), uint32_t(ids.size()));
+            if (added)
+            {
+                if (ids.size() >= Impl::GLOBAL_EMPTY)
+                {
+                    return Err::Unsupported;
+                }
+
+                nameData.insert(nameData.end(), it->first.begin(), it->first.end());
+                nameOffset.push_back(nameData.size());
+                nameEntries.push_back(0u);
+            }
+
+            a.id.push_back(it->second);
+            nameEntries[it->second + 1u] += 1u;
+        }
+
+        entries += a.Size();
+    }
+
+    const size_t n = ids.size();
+    for (size_t i = 0; i < n; ++i)
+    {
+        nameEntries[i + 1u] += nameEntries[i];
+    }
+
+    //
+    // the entries grouped by name, in archive order within each
+    //
+    std::vector<uint32_t> entryArchive(entries);
+    std::vector<uint64_t> cdOffset(entries);
+    std::vector<uint16_t> cdir(entries);
+    {
+        std::vector<uint64_t> at(nameEntries.begin(), nameEntries.end() - 1);
+        for (size_t k = 0; k < archives; ++k)
+        {
+            const auto& a = names[k];
+            for (size_t j = 0; j < a.Size(); ++j)
+            {
+                const uint64_t e = at[a.id[j]]++;
+                entryArchive[e]  = uint32_t(k);
+                cdOffset[e]      = a.cdOffset[j];
+                cdir[e]          = a.cdir[j];
+            }
+        }
+    }
+
+    //
+    // a filter per archive, a power of two of 64 bit words
+    //
+    std::vector<uint64_t> bloomOffset{ 0u };
+    std::vector<uint64_t> bloom;
+    for (const auto& a : names)
+    {
+        uint64_t bits = 64u;
+        while (bits < a.Size() * uint64_t(Config.BloomBitsPerName))
+        {
+            bits *= 2u;
+        }
+
+        const size_t base = bloom.size();
+        bloom.resize(base + bits / 64u, 0u);
+        for (size_t j = 0; j < a.Size(); ++j)
+        {
+            Impl::ForEachBloomBit(
+                NameIndex::Hash(a.Name(j)),
+                Config.BloomHashes,
+                bits,
+                [&](uint64_t Bit)
+                {
+                    bloom[base + Bit / 64u] |= uint64_t(1u) << (Bit % 64u);
+                    return true;
+                }
+            );
+        }
+
+        bloomOffset.push_back(bloom.size());
+    }
+
+    //
+    // linear probing over the distinct names, at most half full
+    //
+    size_t slots = 16u;
+    while (slots < n * 2u)
+    {
+        slots *= 2u;
+    }
+
+    std::vector<Impl::GlobalSlot> table(slots, { 0u, Impl::GLOBAL_EMPTY });
+    for (size_t id = 0; id < n; ++id)
+    {
+        const std::string_view name{ nameData.data() + nameOffset[id], size_t(nameOffset[id + 1u] - nameOffset[id]) };
+        const uint64_t h = NameIndex::Hash(name);
+
+        size_t i = h & (slots - 1u);
+        while (table[i].Name != Impl::GLOBAL_EMPTY)
+        {
+            i = (i + 1u) & (slots - 1u);
+        }
+
+        table[i] = { uint32_t(h >> 32), uint32_t(id) };
+    }
+
+    std::vector<uint64_t> archiveSz;
+    std::vector<uint32_t> fingerprint;
+    std::vector<uint64_t> pathOffset{ 0u };
+    std::vector<char> paths;
+    for (size_t k = 0; k < archives; ++k)
+    {
+        archiveSz.push_back(names[k].size);
+        fingerprint.push_back(names[k].fingerprint);
+        paths.insert(paths.end(), ArchivePaths[k].begin(), ArchivePaths[k].end());
+        pathOffset.push_back(paths.size());
+    }
+
+    Impl::GlobalIndexHeader hdr{};
+    hdr.Magic        = Impl::GLOBAL_MAGIC;
+    hdr.Version      = Impl::GLOBAL_VERSION;
+    hdr.Archives     = uint32_t(archives);
+    hdr.BloomHashes  = Config.BloomHashes;
+    hdr.Names        = n;
+    hdr.Entries      = entries;
+    hdr.Slots        = slots;
+    hdr.PathsBytes   = paths.size();
+    hdr.NamesBytes   = nameData.size();
+    hdr.BloomWords   = bloom.size();
+    hdr.ArchiveSz    = sizeof(hdr);
+    hdr.Fingerprint  = Impl::Align8(hdr.ArchiveSz + archives * sizeof(uint64_t));
+    hdr.PathOffset   = Impl::Align8(hdr.Fingerprint + archives * sizeof(uint32_t));
+    hdr.Paths        = Impl::Align8(hdr.PathOffset + (archives + 1u) * sizeof(uint64_t));
+    hdr.BloomOffset  = Impl::Align8(hdr.Paths + paths.size());
+    hdr.Bloom        = Impl::Align8(hdr.BloomOffset + (archives + 1u) * sizeof(uint64_t));
+    hdr.NameOffset   = Impl::Align8(hdr.Bloom + bloom.size() * sizeof(uint64_t));
+    hdr.NameData     = Impl::Align8(hdr.NameOffset + (n + 1u) * sizeof(uint64_t));
+    hdr.NameEntries  = Impl::Align8(hdr.NameData + nameData.size());
+    hdr.EntryArchive = Impl::Align8(hdr.NameEntries + (n + 1u) * sizeof(uint64_t));
+    hdr.CdOffset     = Impl::Align8(hdr.EntryArchive + entries * sizeof(uint32_t));
+    hdr.CDir         = Impl::Align8(hdr.CdOffset + entries * sizeof(uint64_t));
+    hdr.Table        = Impl::Align8(hdr.CDir + entries * sizeof(uint16_t));
+
+    std::vector<unsigned char> buf;
+    buf.reserve(hdr.Table + slots * sizeof(Impl::GlobalSlot));
+    Impl::Append(buf, 0u, &hdr, sizeof(hdr));
+    Impl::Append(buf, hdr.ArchiveSz, archiveSz.data(), archives * sizeof(uint64_t));
+    Impl::Append(buf, hdr.Fingerprint, fingerprint.data(), archives * sizeof(uint32_t));
+    Impl::Append(buf, hdr.PathOffset, pathOffset.data(), (archives + 1u) * sizeof(uint64_t));
+    Impl::Append(buf, hdr.Paths, paths.data(), paths.size());
+    Impl::Append(buf, hdr.BloomOffset, bloomOffset.data(), (archives + 1u) * sizeof(uint64_t));
+    Impl::Append(buf, hdr.Bloom, bloom.data(), bloom.size() * sizeof(uint64_t));
+    Impl::Append(buf, hdr.NameOffset, nameOffset.data(), (n + 1u) * sizeof(uint64_t));
+    Impl::Append(buf, hdr.NameData, nameData.data(), nameData.size());
+    Impl::Append(buf, hdr.NameEntries, nameEntries.data(), (n + 1u) * sizeof(uint64_t));
+    Impl::Append(buf, hdr.EntryArchive, entryArchive.data(), entries * sizeof(uint32_t));
+    Impl::Append(buf, hdr.CdOffset, cdOffset.data(), entries * sizeof(uint64_t));
+    Impl::Append(buf, hdr.CDir, cdir.data(), entries * sizeof(uint16_t));
+    Impl::Append(buf, hdr.Table, table.data(), slots * sizeof(Impl::GlobalSlot));
+
+    return Impl::WriteAtomically(buf, Path);
+}
+
+utils::Expected<GlobalIndex, Err>
+GlobalIndex::Open(
+    const char* Path
+)
+{
+    GlobalIndex g;
+    g.m_File = utils::MemoryMappedFile{ Path };
+    if (!g.m_File.IsValid())
+    {
+        return utils::UnExpected{ Err::Io };
+    }
+
+    const utils::RdBuf_t buf = g.m_File.Buffer();
+    if (buf.size() < sizeof(Impl::GlobalIndexHeader))
+    {
+        return utils::UnExpected{ Err::BadData };
+    }
+
+    const auto* hdr  = reinterpret_cast<const Impl::GlobalIndexHeader*>(buf.data());
+    const uint64_t a = hdr->Archives;
+    const uint64_t n = hdr->Names;
+    const uint64_t e = hdr->Entries;
+    const uint64_t z = buf.size();
+
+    if (hdr->Magic != Impl::GLOBAL_MAGIC || hdr->Version != Impl::GLOBAL_VERSION)
+    {
+        return utils::UnExpected{ Err::BadData };
+    }
+
+    //
+    // the table needs an empty slot for lookups to stop at, and name
+    // numbers must fit its slots
+    //
+    const bool ok = n < Impl::GLOBAL_EMPTY
+        && hdr->Slots > n
+        && (hdr->Slots & (hdr->Slots - 1u)) == 0u
+        && hdr->BloomHashes > 0u
+        && hdr->BloomHashes <= 64u
+        && Impl::InBounds(hdr->ArchiveSz, a, sizeof(uint64_t), z)
+        && Impl::InBounds(hdr->Fingerprint, a, sizeof(uint32_t), z)
+        && Impl::InBounds(hdr->PathOffset, a + 1u, sizeof(uint64_t), z)
+        && Impl::InBounds(hdr->Paths, hdr->PathsBytes, 1u, z)
+        && Impl::InBounds(hdr->BloomOffset, a + 1u, sizeof(uint64_t), z)
+        && Impl::InBounds(hdr->Bloom, hdr->BloomWords, sizeof(uint64_t), z)
+        && Impl::InBounds(hdr->NameOffset, n + 1u, sizeof(uint64_t), z)
+        && Impl::InBounds(hdr->NameData, hdr->NamesBytes, 1u, z)
+        && Impl::InBounds(hdr->NameEntries, n + 1u, sizeof(uint64_t), z)
+        && Impl::InBounds(hdr->EntryArchive, e, sizeof(uint32_t), z)
+        && Impl::InBounds(hdr->CdOffset, e, sizeof(uint64_t), z)
+        && Impl::InBounds(hdr->CDir, e, sizeof(uint16_t), z)
+        && Impl::InBounds(hdr->Table, hdr->Slots, sizeof(Impl::GlobalSlot), z);
+    if (!ok)
+    {
+        return utils::UnExpected{ Err::BadData };
+    }
+
+    auto at = [&buf](uint64_t Off)
+    {
+        return buf.data() + Off;
+    };
+
+    g.m_Hdr          = hdr;
+    g.m_ArchiveSz    = reinterpret_cast<const uint64_t*>(at(hdr->ArchiveSz));
+    g.m_Fingerprint  = reinterpret_cast<const uint32_t*>(at(hdr->Fingerprint));
+    g.m_PathOffset   = reinterpret_cast<const uint64_t*>(at(hdr->PathOffset));
+    g.m_Paths        = reinterpret_cast<const char*>(at(hdr->Paths));
+    g.m_BloomOffset  = reinterpret_cast<const uint64_t*>(at(hdr->BloomOffset));
+    g.m_Bloom        = reinterpret_cast<const uint64_t*>(at(hdr->Bloom));
+    g.m_NameOffset   = reinterpret_cast<const uint64_t*>(at(hdr->NameOffset));
+    g.m_NameData     = reinterpret_cast<const char*>(at(hdr->NameData));
+    g.m_NameEntries  = reinterpret_cast<const uint64_t*>(at(hdr->NameEntries));
+    g.m_EntryArchive = reinterpret_cast<const uint32_t*>(at(hdr->EntryArchive));
+    g.m_CdOffset     = reinterpret_cast<const uint64_t*>(at(hdr->CdOffset));
+    g.m_CDir         = reinterpret_cast<const uint16_t*>(at(hdr->CDir));
+    g.m_Table        = reinterpret_cast<const Impl::GlobalSlot*>(at(hdr->Table));
+
+    return g;
+}
+
+std::string_view
+GlobalIndex::Path(
+    size_t I
+) const
+{
+    if (I >= Archives())
+    {
+        return {};
+    }
+
+    const uint64_t b = m_PathOffset[I];
+    const uint64_t e = m_PathOffset[I + 1u];
+    if (b > e || e > m_Hdr->PathsBytes)
+    {
+        return {};
+    }
+
+    return { m_Paths + b, size_t(e - b) };
+}
+
+bool
+GlobalIndex::Matches(
+    size_t I,
+    const Archive& A
+) const
+{
+    return I < Archives()
+        && m_ArchiveSz[I] != 0u
+        && m_ArchiveSz[I] == A.Buffer().size()
+        && m_Fingerprint[I] == SidecarIndex::Fingerprint(A);
+}
+
+std::string_view
+GlobalIndex::NameAt(
+    uint64_t N
+) const
+{
+    //
+    // the offsets come from the file - an inconsistent pair reads as an
+    // empty name rather than out of the mapping
+    //
+    const uint64_t b = m_NameOffset[N];
+    const uint64_t e = m_NameOffset[N + 1u];
+    if (b > e || e > m_Hdr->NamesBytes)
+    {
+        return {};
+    }
+
+    return { m_NameData + b, size_t(e - b) };
+}
+
+uint64_t
+GlobalIndex::FindName(
+    std::string_view Name
+) const
+{
+    if (m_Hdr == nullptr)
+    {
+        return NOT_FOUND;
+    }
+
+    const uint64_t h   = NameIndex::Hash(Name);
+    const uint32_t tag = uint32_t(h >> 32);
+    const size_t mask  = size_t(m_Hdr->Slots - 1u);
+
+    for (size_t i = h & mask, probes = 0; probes <= mask; i = (i + 1u) & mask, ++probes)
+    {
+        const Impl::GlobalSlot& s = m_Table[i];
+        if (s.Name >= m_Hdr->Names)
+        {
+            return NOT_FOUND;
+        }
+
+        if (s.Tag == tag && NameAt(s.Name) == Name)
+        {
+            return s.Name;
+        }
+    }
+
+    return NOT_FOUND;
+}
+
+bool
+GlobalIndex::MayContain(
+    size_t I,
+    std::string_view Name
+) const
+{
+    if (I >= Archives())
+    {
+        return false;
+    }
+
+    //
+    // a filter that is not a power of two of words is not one this code
+    // wrote: it cannot rule anything out
+    //
+    const uint64_t b     = m_BloomOffset[I];
+    const uint64_t e     = m_BloomOffset[I + 1u];
+    const uint64_t words = e - b;
+    if (b >= e || e > m_Hdr->BloomWords || (words & (words - 1u)) != 0u)
+    {
+        return true;
+    }
+
+    const uint64_t* filter = m_Bloom + b;
+    return Impl::ForEachBloomBit(
+        NameIndex::Hash(Name),
+        m_Hdr->BloomHashes,
+        words * 64u,
+        [filter](uint64_t Bit)
+        {
+            return (filter[Bit / 64u] >> (Bit % 64u) & 1u) != 0u;
+        }
+    );
+}
+
+std::optional<GlobalIndex::Hit>
+GlobalIndex::Find(
+    std::string_view Name
+) const
+{
+    std::optional<Hit> first;
+    ForEach(
+        Name,
+        [&first](const Hit& H)
+        {
+            first = H;
+            return false;
+        }
+    );
+
+    return first;
+}
+
+std::optional<NameIndex::Hit>
+GlobalIndex::Find(
+    std::string_view Name,
+    size_t I
+) const
+{
+    if (!MayContain(I, Name))
+    {
+        return std::nullopt;
+    }
+
+    const uint64_t n = FindName(Name);
+    if (n == NOT_FOUND)
+    {
+        return std::nullopt;
+    }
+
+    //
+    // a name common to all the archives (a manifest, say) has as many
+    // entries: they are in archive order
+    //
+    const uint64_t b = m_NameEntries[n];
+    const uint64_t e = m_NameEntries[n + 1u];
+    if (b > e || e > m_Hdr->Entries)
+    {
+        return std::nullopt;
+    }
+
+    const uint32_t* it = std::lower_bound(m_EntryArchive + b, m_EntryArchive + e, uint32_t(I));
+    if (it == m_EntryArchive + e || *it != I)
+    {
+        return std::nullopt;
+    }
+
+    const size_t at = size_t(it - m_EntryArchive);
+    return NameIndex::Hit{ m_CdOffset[at], m_CDir[at] };
+}
+
+}
@@ -0,0 +1,270 @@
+#pragma once
+
+#include "zip/Err.hpp"
+#include "zip/NameIndex.hpp"
+#include "utils/Expected.hpp"
+#include "utils/MemoryMappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace zip
+{
+
+class Archive;
+
+namespace Impl
+{
+
+//
+// The fixed part of a global index file, laid out like SidecarHeader:
+// sections at 8 byte aligned offsets from the start of the file.
+//
+struct GlobalIndexHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint32_t Archives;
+    uint32_t BloomHashes;
+    uint64_t Names;      // distinct names
+    uint64_t Entries;    // (archive, entry) pairs
+    uint64_t Slots;      // power of two, more than Names
+    uint64_t PathsBytes;
+    uint64_t NamesBytes;
+    uint64_t BloomWords;
+
+    //
+    // section offsets
+    //
+    uint64_t ArchiveSz;    // u64 x Archives
+    uint64_t Fingerprint;  // u32 x Archives, see SidecarIndex::Fingerprint()
+    uint64_t PathOffset;   // u64 x (Archives + 1), into Paths
+    uint64_t Paths;        // PathsBytes
+    uint64_t BloomOffset;  // u64 x (Archives + 1), into Bloom
+    uint64_t Bloom;        // u64 x BloomWords
+    uint64_t NameOffset;   // u64 x (Names + 1), into NameData
+    uint64_t NameData;     // NamesBytes
+    uint64_t NameEntries;  // u64 x (Names + 1), into the entry columns
+    uint64_t EntryArchive; // u32 x Entries
+    uint64_t CdOffset;     // u64 x Entries
+    uint64_t CDir;         // u16 x Entries
+    uint64_t Table;        // GlobalSlot x Slots
+};
+
+static_assert(sizeof(GlobalIndexHeader) == 168u);
+
+struct GlobalSlot
+{
+    uint32_t Tag;  // upper half of NameIndex::Hash()
+    uint32_t Name; // ~0u when empty
+};
+
+}
+
+struct GlobalIndexConfig
+{
+    //
+    // number of threads reading central directories (the caller included),
+    // 0 for std::thread::hardware_concurrency()
+    //
+    unsigned Threads = 0u;
+
+    //
+    // the size of the filter of each archive, and the bits set per name -
+    // 10 and 7 give about 1% false positives
+    //
+    unsigned BloomBitsPerName = 10u;
+    unsigned BloomHashes      = 7u;
+};
+
+//
+// Which of many archives have an entry of a given name - the question a
+// classpath resolver asks - answered from one file, without opening any of
+// the archives. Like SidecarIndex, the file is used straight from its
+// mapping.
+//
+// It has a hash table over the distinct names of all the archives, each
+// name leading to the (archive, entry) pairs it occurs in, in archive
+// order. Next to it, every archive has a Bloom filter of its names: asking
+// about one archive (or a few, say the ones ahead of some other archive on
+// a search path) is a couple of cache lines of its filter, and only goes to
+// the table for the names the filter lets through.
+//
+// The archive sizes and fingerprints are recorded, so that an archive that
+// changed since can be told with Matches(). Archives that could not be
+// opened are recorded with no entries and a size of 0.
+//
+class GlobalIndex
+{
+public:
+    //
+    // An entry of archive Archive, the index into the paths the file was
+    // written with. Entry is for Archive::At().
+    //
+    struct Hit
+    {
+        uint32_t Archive;
+        NameIndex::Hit Entry;
+    };
+
+    GlobalIndex(
+        void
+    ) = default;
+
+    //
+    // Maps Path and checks that its sections are in bounds. BadData for a
+    // file that is not a global index of this version, Io if it cannot be
+    // mapped.
+    //
+    static utils::Expected<GlobalIndex, Err>
+    Open(
+        const char* Path
+    );
+
+    //
+    // Reads the central directories of ArchivePaths (a few at a time, see
+    // Config.Threads) and writes their index to Path, through a temporary
+    // file that is renamed over Path once complete.
+    //
+    static Err
+    Write(
+        const std::vector<std::string>& ArchivePaths,
+        const char* Path,
+        const GlobalIndexConfig& Config = {}
+    );
+
+    size_t
+    Archives(
+        void
+    ) const
+    {
+        return m_Hdr ? size_t(m_Hdr->Archives) : 0u;
+    }
+
+    std::string_view
+    Path(
+        size_t I
+    ) const;
+
+    //
+    // A is still what archive I was when the index was written.
+    //
+    bool
+    Matches(
+        size_t I,
+        const Archive& A
+    ) const;
+
+    //
+    // Calls Func(hit) for every archive with an entry called Name (the
+    // first one, if it has several), in archive order, until Func returns
+    // false. False if it was stopped.
+    //
+    template<class FuncT>
+    bool
+    ForEach(
+        std::string_view Name,
+        FuncT Func
+    ) const
+    {
+        const uint64_t n = FindName(Name);
+        if (n == NOT_FOUND)
+        {
+            return true;
+        }
+
+        //
+        // the range comes from the file, an inconsistent one reads as empty
+        //
+        const uint64_t b = m_NameEntries[n];
+        const uint64_t e = m_NameEntries[n + 1u];
+        if (b > e || e > m_Hdr->Entries)
+        {
+            return true;
+        }
+
+        for (uint64_t i = b; i < e; ++i)
+        {
+            if (!Func(Hit{ m_EntryArchive[i], NameIndex::Hit{ m_CdOffset[i], m_CDir[i] } }))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //
+    // The first archive with an entry called Name, like a search path
+    // would resolve it.
+    //
+    std::optional<Hit>
+    Find(
+        std::string_view Name
+    ) const;
+
+    //
+    // The entry called Name in archive I, if it has one.
+    //
+    std::optional<NameIndex::Hit>
+    Find(
+        std::string_view Name,
+        size_t I
+    ) const;
+
+    //
+    // The Bloom filter of archive I: false means it has no entry called
+    // Name, true that it probably has.
+    //
+    bool
+    MayContain(
+        size_t I,
+        std::string_view Name
+    ) const;
+
+    const utils::MemoryMappedFile&
+    File(
+        void
+    ) const
+    {
+        return m_File;
+    }
+
+private:
+    static constexpr uint64_t NOT_FOUND = ~uint64_t(0u);
+
+    //
+    // the number of Name in the table, NOT_FOUND if it is not there
+    //
+    uint64_t
+    FindName(
+        std::string_view Name
+    ) const;
+
+    std::string_view
+    NameAt(
+        uint64_t N
+    ) const;
+
+    utils::MemoryMappedFile m_File;
+    const Impl::GlobalIndexHeader* m_Hdr = nullptr;
+    const uint64_t* m_ArchiveSz          = nullptr;
+    const uint32_t* m_Fingerprint        = nullptr;
+    const uint64_t* m_PathOffset         = nullptr;
+    const char* m_Paths                  = nullptr;
+    const uint64_t* m_BloomOffset        = nullptr;
+    const uint64_t* m_Bloom              = nullptr;
+    const uint64_t* m_NameOffset         = nullptr;
+    const char* m_NameData               = nullptr;
+    const uint64_t* m_NameEntries        = nullptr;
+    const uint32_t* m_EntryArchive       = nullptr;
+    const uint64_t* m_CdOffset           = nullptr;
+    const uint16_t* m_CDir               = nullptr;
+    const Impl::GlobalSlot* m_Table      = nullptr;
+};
+
+}
@@ -1,9 +1,7 @@
 #include "zip/Inflate.hpp"
-#include "utils/ScopeExit.hpp"
-
-#include <zlib.h>
-
-#include <iostream> // temp, std::cerr
+#include "zip/InflateContext.hpp"
+#include "zip/NativeInflate.hpp"
+#include "zip/ParallelInflate.hpp"
 
 namespace zip
 {
@@ -11,71 +9,52 @@ namespace zip
 int
 Inflate(
     utils::RdBuf_t Buf,
-    std::function<void(unsigned char)> Cb
+    SinkRef Sink
 )
 {
-    //
-    // https://www.zlib.net/zlib_how.html
-    //
-
-    z_stream strm{};
-    strm.zalloc = Z_NULL;
-    strm.zfree  = Z_NULL;
-    strm.opaque = Z_NULL;
-
-    strm.avail_in = 0;
-    strm.next_in  = Z_NULL;
-
-    constexpr int CHUNK = 1024;
-    unsigned char out[CHUNK];
-
-    int ret = inflateInit2(&strm, -MAX_WBITS);
-    if (ret != Z_OK)
-    {
-        std::cerr << "bad inflateInit2\n";
-        return -1;
-    }
+    auto ctx = InflateContextPool::ThreadLocal().Acquire();
 
-    utils::ScopeExit cleanup{ [&strm]()
-                              { inflateEnd(&strm); } };
+    return ctx->Inflate(Buf, Sink);
+}
 
-    /* decompress until deflate stream ends or end of file */
-    do
-    {
-        strm.avail_in = Buf.size();
-        strm.next_in  = (decltype(strm.next_in))Buf.data();
-        do
+int
+Inflate(
+    utils::RdBuf_t Buf,
+    std::function<void(unsigned char)> Cb
+)
+{
+    return Inflate(
+        Buf,
+        [&Cb](utils::RdBuf_t Chunk)
         {
-            strm.avail_out = CHUNK;
-            strm.next_out  = out;
-            ret            = inflate(&strm, Z_NO_FLUSH);
-            switch (ret)
+            for (auto c : Chunk)
             {
-                case Z_STREAM_ERROR:
-                    // assert(false);
-                    return -1;
-                case Z_NEED_DICT:
-                    ret = Z_DATA_ERROR; /* and fall through */
-                    [[fallthrough]];
-                case Z_DATA_ERROR:
-                    [[fallthrough]];
-                case Z_MEM_ERROR:
-                    return -1;
+                Cb(c);
             }
-            unsigned have = CHUNK - strm.avail_out;
-            for (size_t i = 0; i < have; ++i)
-            {
-                Cb(static_cast<unsigned char>(out[i]));
-            }
-
-        } while (strm.avail_out == 0);
+        }
+    );
+}
 
-        break;
+Err
+InflateInto(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst,
+    InflateBackend Backend,
+    uint32_t* Crc
+)
+{
+    if (Backend == InflateBackend::Native)
+    {
+        return NativeInflateInto(Src, Dst, Crc);
+    }
+    else if (Backend == InflateBackend::Parallel)
+    {
+        return ParallelInflateInto(Src, Dst, Crc);
+    }
 
-        /* done when inflate() says it's done */
-    } while (ret != Z_STREAM_END);
+    auto ctx = InflateContextPool::ThreadLocal().Acquire();
 
-    return 0;
+    return ctx->InflateInto(Src, Dst, Crc);
 }
 
 }
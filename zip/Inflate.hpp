@@ -1,16 +1,77 @@
 #pragma once
 
+#include "zip/Err.hpp"
+#include "zip/Sink.hpp"
 #include "utils/RdBuf.hpp"
+#include "utils/WrBuf.hpp"
 
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <type_traits>
 
 namespace zip
 {
 
+//
+// Inflates the raw deflate stream in Buf, handing the output to Sink in
+// chunks as it is produced. 0 once the stream ends, -1 when it is damaged
+// or Buf ends first.
+//
+int
+Inflate(
+    utils::RdBuf_t Buf,
+    SinkRef Sink
+);
+
+template<
+    class SinkT,
+    class = std::enable_if_t<!std::is_same_v<std::decay_t<SinkT>, SinkRef> && IsSink_v<SinkT>>>
+int
+Inflate(
+    utils::RdBuf_t Buf,
+    SinkT&& Sink
+)
+{
+    return Inflate(Buf, SinkRef{ Sink });
+}
+
+//
+// Per byte variant, kept for existing callers - prefer the sink overload.
+//
 int
 Inflate(
     utils::RdBuf_t Buf,
     std::function<void(unsigned char)> Cb
 );
 
+//
+// The most a deflate stream expands: at best 258 bytes per 2-bit
+// length+distance code, which is 1032 output bytes per input byte.
+//
+constexpr size_t DEFLATE_MAX_RATIO = 1032u;
+
+enum class InflateBackend
+{
+    Zlib,
+    Native,   // zip/NativeInflate.hpp
+    Parallel, // zip/ParallelInflate.hpp, with the default configuration
+};
+
+//
+// Inflates Src straight into Dst in one go. Dst is expected to be presized to
+// the original size from the headers, and a stream that inflates to anything
+// else is reported as Err::SizeMismatch.
+//
+// When Crc is given, it receives the CRC-32 of the output, computed slice by
+// slice as the output is produced rather than in a second pass.
+//
+Err
+InflateInto(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst,
+    InflateBackend Backend = InflateBackend::Zlib,
+    uint32_t* Crc = nullptr
+);
+
 }
@@ -0,0 +1,348 @@
+#include "zip/InflateContext.hpp"
+#include "utils/Crc32.hpp"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+
+namespace zip
+{
+
+InflateContext::InflateContext(
+    void
+)
+  : m_Strm(std::make_unique<z_stream>())
+{
+    m_Strm->zalloc = &InflateContext::Alloc;
+    m_Strm->zfree  = &InflateContext::Free;
+    m_Strm->opaque = this;
+
+    m_Strm->avail_in = 0;
+    m_Strm->next_in  = Z_NULL;
+
+    int ret = inflateInit2(m_Strm.get(), -MAX_WBITS);
+    if (ret != Z_OK)
+    {
+        return;
+    }
+
+    m_Valid = true;
+}
+
+InflateContext::~InflateContext(
+    void
+)
+{
+    if (m_Valid)
+    {
+        inflateEnd(m_Strm.get());
+    }
+}
+
+void*
+InflateContext::Alloc(
+    void* Opaque,
+    unsigned Items,
+    unsigned Size
+)
+{
+    auto* self = static_cast<InflateContext*>(Opaque);
+
+    size_t bytes = (size_t(Items) * Size + 15u) & ~size_t(15u);
+    if (bytes <= ARENA_BYTES - self->m_ArenaUsed)
+    {
+        void* ptr = self->m_Arena + self->m_ArenaUsed;
+        self->m_ArenaUsed += bytes;
+        self->m_ArenaLive += 1u;
+        return ptr;
+    }
+
+    self->m_HeapAllocs += 1u;
+    return std::malloc(size_t(Items) * Size);
+}
+
+void
+InflateContext::Free(
+    void* Opaque,
+    void* Ptr
+)
+{
+    auto* self = static_cast<InflateContext*>(Opaque);
+
+    auto* p = static_cast<unsigned char*>(Ptr);
+    if (p >= self->m_Arena && p < self->m_Arena + ARENA_BYTES)
+    {
+        //
+        // bump allocator: space is only reclaimed once everything is freed
+        //
+        self->m_ArenaLive -= 1u;
+        if (self->m_ArenaLive == 0u)
+        {
+            self->m_ArenaUsed = 0u;
+        }
+        return;
+    }
+
+    std::free(Ptr);
+}
+
+int
+InflateContext::Inflate(
+    utils::RdBuf_t Buf,
+    SinkRef Sink
+)
+{
+    //
+    // https://www.zlib.net/zlib_how.html
+    //
+
+    if (!m_Valid)
+    {
+        return -1;
+    }
+
+    z_stream& strm = *m_Strm;
+
+    //
+    // keeps the state and window allocations, only forgets the previous stream
+    //
+    int ret = inflateReset(&strm);
+    if (ret != Z_OK)
+    {
+        return -1;
+    }
+
+    //
+    // avail_in is only 32 bits wide, so the input goes in in slices; it has
+    // to hold the whole stream, up to its end
+    //
+    constexpr size_t MAX_AVAIL = std::numeric_limits<uInt>::max();
+    constexpr size_t CHUNK     = 16384u;
+    unsigned char out[CHUNK];
+
+    const unsigned char* in = Buf.data();
+    size_t inLeft           = Buf.size();
+
+    do
+    {
+        uInt inChunk = std::min(inLeft, MAX_AVAIL);
+
+        strm.avail_in = inChunk;
+        strm.next_in  = (decltype(strm.next_in))in;
+        do
+        {
+            strm.avail_out = CHUNK;
+            strm.next_out  = out;
+            ret            = inflate(&strm, Z_NO_FLUSH);
+            switch (ret)
+            {
+                case Z_STREAM_ERROR:
+                    [[fallthrough]];
+                case Z_NEED_DICT:
+                    [[fallthrough]];
+                case Z_DATA_ERROR:
+                    [[fallthrough]];
+                case Z_MEM_ERROR:
+                    return -1;
+            }
+            size_t have = CHUNK - strm.avail_out;
+            if (have > 0)
+            {
+                Sink({ out, have });
+            }
+
+        } while (strm.avail_out == 0 && ret != Z_STREAM_END);
+
+        in += inChunk - strm.avail_in;
+        inLeft -= inChunk - strm.avail_in;
+
+        /* done when inflate() says it's done */
+    } while (ret != Z_STREAM_END && inLeft != 0u);
+
+    return ret == Z_STREAM_END ? 0 : -1;
+}
+
+Err
+InflateContext::InflateInto(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst,
+    uint32_t* Crc
+)
+{
+    if (!m_Valid)
+    {
+        return Err::BadInit;
+    }
+
+    z_stream& strm = *m_Strm;
+
+    int ret = inflateReset(&strm);
+    if (ret != Z_OK)
+    {
+        return Err::BadInit;
+    }
+
+    //
+    // avail_in/avail_out are only 32 bits wide, so members beyond 4 GiB are
+    // fed in windows - everything else is done with a single Z_FINISH call.
+    // With a crc requested, the output is instead produced in slices that are
+    // checksummed right after being written, while they are still in cache.
+    //
+    constexpr size_t MAX_AVAIL = std::numeric_limits<uInt>::max();
+    constexpr size_t CRC_SLICE = 256u * 1024u;
+
+    const size_t maxOut = Crc ? CRC_SLICE : MAX_AVAIL;
+
+    size_t inLeft  = Src.size();
+    size_t outLeft = Dst.size();
+    uint32_t crc   = 0u;
+
+    //
+    // zlib rejects a null next_out even when there is no room to write to
+    //
+    unsigned char empty[1];
+
+    strm.next_in  = (decltype(strm.next_in))Src.data();
+    strm.next_out = Dst.empty() ? empty : Dst.data();
+
+    while (true)
+    {
+        uInt inChunk  = std::min(inLeft, MAX_AVAIL);
+        uInt outChunk = std::min(outLeft, maxOut);
+
+        strm.avail_in  = inChunk;
+        strm.avail_out = outChunk;
+
+        bool last = inChunk == inLeft && outChunk == outLeft;
+
+        unsigned char* sliceBeg = strm.next_out;
+
+        ret = inflate(&strm, last ? Z_FINISH : Z_NO_FLUSH);
+
+        inLeft -= inChunk - strm.avail_in;
+        outLeft -= outChunk - strm.avail_out;
+
+        if (Crc)
+        {
+            crc = utils::Crc32(crc, { sliceBeg, size_t(strm.next_out - sliceBeg) });
+        }
+
+        if (ret == Z_STREAM_END)
+        {
+            if (outLeft != 0u)
+            {
+                return Err::SizeMismatch;
+            }
+
+            if (Crc)
+            {
+                *Crc = crc;
+            }
+
+            return Err::None;
+        }
+
+        if (ret != Z_OK && ret != Z_BUF_ERROR)
+        {
+            return Err::BadData;
+        }
+
+        if (outLeft == 0u)
+        {
+            // the stream wants to produce more than was announced
+            return Err::SizeMismatch;
+        }
+
+        if (inLeft == 0u && strm.avail_out != 0u)
+        {
+            // truncated stream
+            return Err::BadData;
+        }
+    }
+}
+
+Err
+InflateContext::Begin(
+    void
+)
+{
+    if (!m_Valid || inflateReset(m_Strm.get()) != Z_OK)
+    {
+        return Err::BadInit;
+    }
+
+    return Err::None;
+}
+
+Err
+InflateContext::Step(
+    utils::RdBuf_t& Src,
+    utils::WrBuf_t Dst,
+    size_t& Produced,
+    bool& End
+)
+{
+    constexpr size_t MAX_AVAIL = std::numeric_limits<uInt>::max();
+
+    z_stream& strm = *m_Strm;
+
+    uInt inChunk  = std::min(Src.size(), MAX_AVAIL);
+    uInt outChunk = std::min(Dst.size(), MAX_AVAIL);
+
+    unsigned char empty[1];
+
+    strm.next_in   = (decltype(strm.next_in))Src.data();
+    strm.avail_in  = inChunk;
+    strm.next_out  = Dst.empty() ? empty : Dst.data();
+    strm.avail_out = outChunk;
+
+    int ret = inflate(&strm, Z_NO_FLUSH);
+
+    Src      = Src.subspan(inChunk - strm.avail_in);
+    Produced = outChunk - strm.avail_out;
+    End      = ret == Z_STREAM_END;
+
+    if (ret == Z_STREAM_END || ret == Z_OK || (ret == Z_BUF_ERROR && outChunk == 0u))
+    {
+        return Err::None;
+    }
+
+    return ret == Z_MEM_ERROR ? Err::BadInit : Err::BadData;
+}
+
+InflateContextPool::Lease
+InflateContextPool::Acquire(
+    void
+)
+{
+    if (m_Free.empty())
+    {
+        return { *this, std::make_unique<InflateContext>() };
+    }
+
+    std::unique_ptr<InflateContext> ctx = std::move(m_Free.back());
+    m_Free.pop_back();
+
+    return { *this, std::move(ctx) };
+}
+
+void
+InflateContextPool::Release(
+    std::unique_ptr<InflateContext> Ctx
+)
+{
+    m_Free.push_back(std::move(Ctx));
+}
+
+InflateContextPool&
+InflateContextPool::ThreadLocal(
+    void
+)
+{
+    thread_local InflateContextPool pool;
+    return pool;
+}
+
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+#include "zip/Err.hpp"
+#include "zip/Sink.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/WrBuf.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct z_stream_s;
+
+namespace zip
+{
+
+//
+// A raw inflate stream that is initialised once and then only reset
+// (inflateReset) between entries. zlib's own allocations - the inflate state
+// and the 32 KB window - are served from an arena inside the context, so once
+// a context exists, inflating further entries does not touch the heap.
+//
+class InflateContext
+{
+public:
+    InflateContext(
+        void
+    );
+
+    InflateContext(
+        const InflateContext&
+    ) = delete;
+
+    InflateContext&
+    operator=(
+        const InflateContext&
+    ) = delete;
+
+    ~InflateContext(
+        void
+    );
+
+    bool
+    IsValid(
+        void
+    ) const
+    {
+        return m_Valid;
+    }
+
+    int
+    Inflate(
+        utils::RdBuf_t Buf,
+        SinkRef Sink
+    );
+
+    //
+    // One-shot inflate of Src into Dst, which has to be exactly as large as
+    // the inflated data - any difference is reported as Err::SizeMismatch.
+    // When Crc is given it receives the CRC-32 of the output.
+    //
+    Err
+    InflateInto(
+        utils::RdBuf_t Src,
+        utils::WrBuf_t Dst,
+        uint32_t* Crc = nullptr
+    );
+
+    //
+    // Step-wise inflate, for readers that pull the output in pieces: Begin()
+    // starts a new stream, each Step() continues where the previous one left
+    // off. Src is advanced past the input that was used, Produced is set to
+    // the bytes written to the front of Dst and End once the stream is done.
+    // A step that cannot make progress (no input left) is Err::BadData.
+    //
+    Err
+    Begin(
+        void
+    );
+
+    Err
+    Step(
+        utils::RdBuf_t& Src,
+        utils::WrBuf_t Dst,
+        size_t& Produced,
+        bool& End
+    );
+
+    //
+    // Number of zlib allocations that did not fit the arena and had to go to
+    // the heap, meant for tests and diagnostics.
+    //
+    size_t
+    HeapAllocs(
+        void
+    ) const
+    {
+        return m_HeapAllocs;
+    }
+
+private:
+    static void*
+    Alloc(
+        void* Opaque,
+        unsigned Items,
+        unsigned Size
+    );
+
+    static void
+    Free(
+        void* Opaque,
+        void* Ptr
+    );
+
+    static constexpr size_t ARENA_BYTES = 48u * 1024u;
+
+    alignas(16) unsigned char m_Arena[ARENA_BYTES];
+    size_t m_ArenaUsed  = 0u;
+    size_t m_ArenaLive  = 0u;
+    size_t m_HeapAllocs = 0u;
+    std::unique_ptr<z_stream_s> m_Strm;
+    bool m_Valid = false;
+};
+
+//
+// Free list of InflateContext's. Contexts are handed out as leases, which
+// put them back on the list when they go out of scope.
+//
+class InflateContextPool
+{
+public:
+    class Lease
+    {
+    public:
+        Lease(
+            InflateContextPool& Pool,
+            std::unique_ptr<InflateContext> Ctx
+        )
+          : m_Pool(Pool)
+          , m_Ctx(std::move(Ctx))
+        {
+        }
+
+        Lease(
+            Lease&&
+        ) = default;
+
+        Lease(
+            const Lease&
+        ) = delete;
+
+        Lease&
+        operator=(
+            const Lease&
+        ) = delete;
+
+        ~Lease(
+            void
+        )
+        {
+            if (m_Ctx)
+            {
+                m_Pool.Release(std::move(m_Ctx));
+            }
+        }
+
+        InflateContext&
+        operator*(
+            void
+        ) const
+        {
+            return *m_Ctx;
+        }
+
+        InflateContext*
+        operator->(
+            void
+        ) const
+        {
+            return m_Ctx.get();
+        }
+
+    private:
+        InflateContextPool& m_Pool;
+        std::unique_ptr<InflateContext> m_Ctx;
+    };
+
+    Lease
+    Acquire(
+        void
+    );
+
+    size_t
+    Available(
+        void
+    ) const
+    {
+        return m_Free.size();
+    }
+
+    //
+    // One pool per thread, so leasing needs no locking.
+    //
+    static InflateContextPool&
+    ThreadLocal(
+        void
+    );
+
+private:
+    void
+    Release(
+        std::unique_ptr<InflateContext> Ctx
+    );
+
+    std::vector<std::unique_ptr<InflateContext>> m_Free;
+};
+
+}
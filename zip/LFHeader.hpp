@@ -8,6 +8,7 @@
 #include "utils/Hexed.hpp"
 #include "utils/AsBytes.hpp"
 #include "utils/AsPlainStringView.hpp"
+#include "zip/ExtraField.hpp"
 
 #include <optional>
 #include <ostream>
@@ -28,8 +29,8 @@ struct LFHeader
     uint16_t lastModTime;
     uint16_t lastModDate;
     uint32_t crc32;
-    uint32_t compressedSz;
-    uint32_t originalSz;
+    uint64_t compressedSz; // 32 bits, unless in the zip64 extra field
+    uint64_t originalSz;   // 32 bits, unless in the zip64 extra field
     uint16_t nameLen;
     uint16_t exFieldLen;
     utils::RdBuf_t name;
@@ -43,8 +44,8 @@ struct LFHeader
         msg::Seg<&LFHeader::lastModTime>,
         msg::Seg<&LFHeader::lastModDate>,
         msg::Seg<&LFHeader::crc32>,
-        msg::Seg<&LFHeader::compressedSz>,
-        msg::Seg<&LFHeader::originalSz>,
+        msg::Seg<&LFHeader::compressedSz, msg::Pos<0u, 32u>>,
+        msg::Seg<&LFHeader::originalSz, msg::Pos<0u, 32u>>,
         msg::Seg<&LFHeader::nameLen>,
         msg::Seg<&LFHeader::exFieldLen>,
         msg::Seg<&LFHeader::name, msg::Dyn<&LFHeader::nameLen>>,
@@ -109,6 +110,14 @@ struct LFHeader
             b = Buf;
             h.reset();
         }
+        else if (h->originalSz == ZIP64_SATURATED || h->compressedSz == ZIP64_SATURATED)
+        {
+            //
+            // unlike in the central directory, both sizes are in the zip64
+            // extra field as soon as one of them is
+            //
+            ReadZip64(h->exField, { &h->originalSz, &h->compressedSz });
+        }
 
         return { h, *b };
     }
@@ -0,0 +1,211 @@
+#include "zip/MemberStreamBuf.hpp"
+#include "utils/Crc32.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace zip
+{
+
+MemberStreamBuf::MemberStreamBuf(
+    uint16_t Method,
+    utils::RdBuf_t FileBuf,
+    size_t OriginalSz,
+    uint32_t Crc,
+    const EntryReaderConfig& Config
+)
+  : m_Method(Method)
+  , m_FileBuf(FileBuf)
+  , m_Crc(Crc)
+  , m_ChunkSize(std::max<size_t>(Config.ChunkSize, 1u))
+  , m_Reader(Method, FileBuf, OriginalSz, Crc, Config)
+{
+    //
+    // an empty read only reports what the reader found wrong up front
+    //
+    auto probe = m_Reader.Read({});
+    if (probe.HasError())
+    {
+        m_Err = probe.Error();
+        return;
+    }
+
+    if (Stored())
+    {
+        char* beg = reinterpret_cast<char*>(const_cast<unsigned char*>(FileBuf.data()));
+        setg(beg, beg, beg + FileBuf.size());
+    }
+}
+
+MemberStreamBuf::int_type
+MemberStreamBuf::underflow(
+    void
+)
+{
+    if (gptr() < egptr())
+    {
+        return traits_type::to_int_type(*gptr());
+    }
+
+    if (m_Err != Err::None)
+    {
+        return traits_type::eof();
+    }
+
+    if (Stored())
+    {
+        //
+        // the whole entry went by, so this is the time to check it
+        //
+        if (!m_CrcTaken)
+        {
+            m_CrcTaken = true;
+            m_Err      = utils::Crc32(0u, m_FileBuf) == m_Crc ? Err::None : Err::BadCrc;
+        }
+
+        return traits_type::eof();
+    }
+
+    m_Base += size_t(egptr() - eback());
+    setg(nullptr, nullptr, nullptr);
+
+    auto chunk = m_Reader.Next();
+    if (chunk.HasError())
+    {
+        m_Err = chunk.Error();
+        return traits_type::eof();
+    }
+
+    if (chunk.Value().empty())
+    {
+        return traits_type::eof();
+    }
+
+    char* beg = reinterpret_cast<char*>(const_cast<unsigned char*>(chunk.Value().data()));
+    setg(beg, beg, beg + chunk.Value().size());
+
+    return traits_type::to_int_type(*gptr());
+}
+
+std::streamsize
+MemberStreamBuf::xsgetn(
+    char_type* S,
+    std::streamsize N
+)
+{
+    size_t done = 0u;
+    size_t want = size_t(std::max<std::streamsize>(N, 0));
+
+    while (done < want)
+    {
+        size_t avail = size_t(egptr() - gptr());
+        if (avail != 0u)
+        {
+            size_t n = std::min(avail, want - done);
+            std::memcpy(S + done, gptr(), n);
+            setg(eback(), gptr() + n, egptr());
+            done += n;
+            continue;
+        }
+
+        //
+        // Reads of a chunk or more are decoded right into S, rather than
+        // into the chunk buffer and copied from there.
+        //
+        if (!Stored() && m_Err == Err::None && want - done >= m_ChunkSize)
+        {
+            m_Base += size_t(egptr() - eback());
+            setg(nullptr, nullptr, nullptr);
+
+            auto n = m_Reader.Read({ reinterpret_cast<unsigned char*>(S + done), want - done });
+            if (n.HasError())
+            {
+                m_Err = n.Error();
+                break;
+            }
+
+            if (n.Value() == 0u)
+            {
+                break;
+            }
+
+            m_Base += n.Value();
+            done += n.Value();
+            continue;
+        }
+
+        if (traits_type::eq_int_type(underflow(), traits_type::eof()))
+        {
+            break;
+        }
+    }
+
+    return std::streamsize(done);
+}
+
+std::streamsize
+MemberStreamBuf::showmanyc(
+    void
+)
+{
+    if (gptr() < egptr())
+    {
+        return egptr() - gptr();
+    }
+
+    return m_Err != Err::None || Stored() || m_Reader.Done() ? -1 : 0;
+}
+
+MemberStreamBuf::pos_type
+MemberStreamBuf::seekoff(
+    off_type Off,
+    std::ios_base::seekdir Dir,
+    std::ios_base::openmode Which
+)
+{
+    const pos_type bad = pos_type(off_type(-1));
+
+    if (!(Which & std::ios_base::in))
+    {
+        return bad;
+    }
+
+    const off_type cur = off_type(m_Base) + (gptr() - eback());
+
+    //
+    // deflated entries can only tell where they are
+    //
+    if (!Stored())
+    {
+        return Off == 0 && Dir == std::ios_base::cur ? pos_type(cur) : bad;
+    }
+
+    off_type pos = Off;
+    if (Dir == std::ios_base::cur)
+    {
+        pos += cur;
+    }
+    else if (Dir == std::ios_base::end)
+    {
+        pos += off_type(egptr() - eback());
+    }
+
+    if (pos < 0 || pos > egptr() - eback())
+    {
+        return bad;
+    }
+
+    setg(eback(), eback() + pos, egptr());
+    return pos_type(pos);
+}
+
+MemberStreamBuf::pos_type
+MemberStreamBuf::seekpos(
+    pos_type Pos,
+    std::ios_base::openmode Which
+)
+{
+    return seekoff(off_type(Pos), std::ios_base::beg, Which);
+}
+
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "zip/Err.hpp"
+#include "zip/EntryReader.hpp"
+#include "utils/RdBuf.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <streambuf>
+
+namespace zip
+{
+
+//
+// Exposes the data of an entry as a std::streambuf, for code that consumes
+// a std::istream:
+//
+//     zip::MemberStreamBuf buf{ cdfh, fileBuf };
+//     std::istream in{ &buf };
+//
+// Stored entries are not copied at all, the get area is the mapping itself
+// (and seeking works anywhere in it). Deflated entries are decoded through
+// an EntryReader into its reusable chunk buffer, large reads go straight to
+// the caller's memory; they can only be read front to back.
+//
+// The crc and sizes are checked once the end is reached. A failure there or
+// in the compressed data ends the stream early, the istream sees an eof
+// before the end of the entry and Error() tells why.
+//
+class MemberStreamBuf : public std::streambuf
+{
+public:
+    MemberStreamBuf(
+        uint16_t Method,
+        utils::RdBuf_t FileBuf,
+        size_t OriginalSz,
+        uint32_t Crc,
+        const EntryReaderConfig& Config = { 256u * 1024u }
+    );
+
+    template<class HeaderT>
+    MemberStreamBuf(
+        const HeaderT& Hdr,
+        utils::RdBuf_t FileBuf,
+        const EntryReaderConfig& Config = { 256u * 1024u }
+    )
+      : MemberStreamBuf(Hdr.compression, FileBuf, Hdr.originalSz, Hdr.crc32, Config)
+    {
+    }
+
+    Err
+    Error(
+        void
+    ) const
+    {
+        return m_Err;
+    }
+
+protected:
+    int_type
+    underflow(
+        void
+    ) override;
+
+    std::streamsize
+    xsgetn(
+        char_type* S,
+        std::streamsize N
+    ) override;
+
+    std::streamsize
+    showmanyc(
+        void
+    ) override;
+
+    pos_type
+    seekoff(
+        off_type Off,
+        std::ios_base::seekdir Dir,
+        std::ios_base::openmode Which
+    ) override;
+
+    pos_type
+    seekpos(
+        pos_type Pos,
+        std::ios_base::openmode Which
+    ) override;
+
+private:
+    bool
+    Stored(
+        void
+    ) const
+    {
+        return m_Method == 0u;
+    }
+
+    uint16_t m_Method;
+    utils::RdBuf_t m_FileBuf;
+    uint32_t m_Crc;
+
+    size_t m_ChunkSize;
+
+    EntryReader m_Reader;
+
+    size_t m_Base   = 0u; // output offset of eback()
+    bool m_CrcTaken = false;
+    Err m_Err       = Err::None;
+};
+
+}
@@ -0,0 +1,155 @@
+#include "zip/NameIndex.hpp"
+#include "zip/CDFHeader.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace zip
+{
+
+NameIndex::NameIndex(
+    utils::RdBuf_t ZipBuf,
+    size_t Expected
+)
+  : m_Buf(ZipBuf)
+{
+    size_t cap = 16u;
+    while (cap < Expected * 2u)
+    {
+        cap *= 2u;
+    }
+
+    m_Slots.resize(cap);
+}
+
+uint64_t
+NameIndex::Hash(
+    std::string_view Name
+)
+{
+    //
+    // FNV-1a, then a final mix so that the low bits (the bucket) depend on
+    // every byte - entry names tend to differ only in their last few bytes
+    //
+    uint64_t h = 0xcbf29ce484222325u;
+    for (unsigned char c : Name)
+    {
+        h = (h ^ c) * 0x100000001b3u;
+    }
+
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdu;
+    h ^= h >> 33;
+    return h;
+}
+
+bool
+NameIndex::Matches(
+    const Slot& S,
+    std::string_view Name,
+    uint32_t Tag
+) const
+{
+    if (S.Tag != Tag || S.NameLen != Name.size())
+    {
+        return false;
+    }
+
+    return std::memcmp(m_Buf.data() + S.CdOffset + CDFHeader::MinBytes(), Name.data(), Name.size()) == 0;
+}
+
+bool
+NameIndex::Insert(
+    std::string_view Name,
+    uint64_t CdOffset,
+    uint16_t CDir
+)
+{
+    if (m_Slots.empty() || (m_Size + 1u) * 2u > m_Slots.size())
+    {
+        Grow();
+    }
+
+    const uint64_t h   = Hash(Name);
+    const uint32_t tag = uint32_t(h >> 32);
+    const size_t mask  = m_Slots.size() - 1u;
+
+    for (size_t i = h & mask;; i = (i + 1u) & mask)
+    {
+        Slot& s = m_Slots[i];
+        if (s.CdOffset == EMPTY)
+        {
+            s = { CdOffset, tag, uint16_t(Name.size()), CDir };
+            ++m_Size;
+            return true;
+        }
+
+        if (Matches(s, Name, tag))
+        {
+            return false;
+        }
+    }
+}
+
+std::optional<NameIndex::Hit>
+NameIndex::Find(
+    std::string_view Name
+) const
+{
+    if (m_Size == 0u || Name.size() > UINT16_MAX)
+    {
+        return std::nullopt;
+    }
+
+    const uint64_t h   = Hash(Name);
+    const uint32_t tag = uint32_t(h >> 32);
+    const size_t mask  = m_Slots.size() - 1u;
+
+    for (size_t i = h & mask;; i = (i + 1u) & mask)
+    {
+        const Slot& s = m_Slots[i];
+        if (s.CdOffset == EMPTY)
+        {
+            return std::nullopt;
+        }
+
+        if (Matches(s, Name, tag))
+        {
+            return Hit{ s.CdOffset, s.CDir };
+        }
+    }
+}
+
+void
+NameIndex::Grow(
+    void
+)
+{
+    std::vector<Slot> old = std::exchange(m_Slots, std::vector<Slot>(std::max<size_t>(m_Slots.size() * 2u, 16u)));
+
+    const size_t mask = m_Slots.size() - 1u;
+    for (const Slot& s : old)
+    {
+        if (s.CdOffset == EMPTY)
+        {
+            continue;
+        }
+
+        //
+        // only the upper half of the hash is kept, the bucket comes from the
+        // lower one - so the name is hashed again, from the mapping
+        //
+        std::string_view name{ (const char*)m_Buf.data() + s.CdOffset + CDFHeader::MinBytes(), s.NameLen };
+        for (size_t i = Hash(name) & mask;; i = (i + 1u) & mask)
+        {
+            if (m_Slots[i].CdOffset == EMPTY)
+            {
+                m_Slots[i] = s;
+                break;
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "utils/RdBuf.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace zip
+{
+
+//
+// Open-addressing (linear probing) hash table from entry names to the
+// offsets of their central directory headers. The names are not copied: a
+// slot holds the header offset, and the name is compared in place, right
+// behind the fixed part of the header in the mapping. Lookups neither
+// allocate nor decode any header but the one they land on.
+//
+// When a name occurs more than once, the first one inserted wins.
+//
+class NameIndex
+{
+public:
+    struct Hit
+    {
+        uint64_t CdOffset;
+        uint16_t CDir; // as passed to Insert()
+    };
+
+    NameIndex(
+        void
+    ) = default;
+
+    explicit NameIndex(
+        utils::RdBuf_t ZipBuf,
+        size_t Expected = 0u
+    );
+
+    //
+    // CdOffset is the offset of a (validated) central directory header in
+    // ZipBuf, Name its name. False for a duplicate.
+    //
+    bool
+    Insert(
+        std::string_view Name,
+        uint64_t CdOffset,
+        uint16_t CDir = 0u
+    );
+
+    std::optional<Hit>
+    Find(
+        std::string_view Name
+    ) const;
+
+    size_t
+    Size(
+        void
+    ) const
+    {
+        return m_Size;
+    }
+
+    size_t
+    Bytes(
+        void
+    ) const
+    {
+        return m_Slots.size() * sizeof(Slot);
+    }
+
+    static uint64_t
+    Hash(
+        std::string_view Name
+    );
+
+private:
+    struct Slot
+    {
+        uint64_t CdOffset = EMPTY;
+        uint32_t Tag      = 0u; // upper half of the hash
+        uint16_t NameLen  = 0u;
+        uint16_t CDir     = 0u;
+    };
+
+    static constexpr uint64_t EMPTY = ~uint64_t(0u);
+
+    bool
+    Matches(
+        const Slot& S,
+        std::string_view Name,
+        uint32_t Tag
+    ) const;
+
+    void
+    Grow(
+        void
+    );
+
+    utils::RdBuf_t m_Buf;
+    std::vector<Slot> m_Slots; // power of two, at most half full
+    size_t m_Size = 0u;
+};
+
+}
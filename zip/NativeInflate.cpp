@@ -0,0 +1,54 @@
+#include "zip/NativeInflate.hpp"
+#include "zip/NativeInflateImpl.hpp"
+
+namespace zip
+{
+
+Err
+NativeInflate(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst,
+    size_t& Produced,
+    size_t& Consumed,
+    uint32_t* Crc
+)
+{
+    Impl::Decoder<unsigned char> dec{ Src, Dst, Crc != nullptr };
+
+    Err e = dec.Run();
+    if (e != Err::None)
+    {
+        return e;
+    }
+
+    Produced = dec.Produced();
+    Consumed = dec.Consumed();
+
+    if (Crc)
+    {
+        *Crc = dec.Crc();
+    }
+
+    return Err::None;
+}
+
+Err
+NativeInflateInto(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst,
+    uint32_t* Crc
+)
+{
+    size_t produced = 0u;
+    size_t consumed = 0u;
+
+    Err e = NativeInflate(Src, Dst, produced, consumed, Crc);
+    if (e != Err::None)
+    {
+        return e;
+    }
+
+    return produced == Dst.size() ? Err::None : Err::SizeMismatch;
+}
+
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "zip/Err.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/WrBuf.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace zip
+{
+
+//
+// In-tree, whole-buffer decoder for raw deflate streams - an alternative to
+// zlib for when the input is fully mapped and the output size is known up
+// front (which is the case for every zip entry).
+//
+// Decodes Src into Dst, failing with Err::SizeMismatch as soon as the
+// stream wants to produce more than Dst holds. On success Produced and
+// Consumed are set to the number of bytes written and read, and Crc (when
+// given) to the CRC-32 of the output - which is computed by the decoder as
+// it goes, a window or so behind the write position.
+//
+Err
+NativeInflate(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst,
+    size_t& Produced,
+    size_t& Consumed,
+    uint32_t* Crc = nullptr
+);
+
+//
+// Same contract as zip::InflateInto: Dst has to be exactly the inflated size.
+//
+Err
+NativeInflateInto(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst,
+    uint32_t* Crc = nullptr
+);
+
+}
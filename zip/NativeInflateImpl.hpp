@@ -0,0 +1,1003 @@
+#pragma once
+
+#include "zip/Err.hpp"
+#include "utils/Crc32.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/Span.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace zip::Impl
+{
+
+//
+// https://www.rfc-editor.org/rfc/rfc1951
+//
+// The decoder follows the same broad design as libdeflate: a 64 bit bit
+// buffer that is topped up with one unaligned load, table lookups that
+// resolve a whole code (plus, for literals, possibly the next one) at once,
+// and match copies done in words rather than bytes.
+//
+// The internals live here rather than in NativeInflate.cpp, as the parallel
+// decoder (zip/ParallelInflate.cpp) drives the same Decoder block by block.
+//
+
+inline constexpr unsigned MAX_CODE_BITS = 15u;
+
+inline constexpr unsigned LITLEN_BITS  = 11u;
+inline constexpr unsigned DIST_BITS    = 8u;
+inline constexpr unsigned PRECODE_BITS = 7u;
+
+//
+// main table plus room for the subtables of codes longer than the main
+// table index - generous upper bounds for complete codes, BuildTable()
+// refuses anything that does not fit
+//
+inline constexpr size_t LITLEN_SIZE  = (1u << LITLEN_BITS) + 1024u;
+inline constexpr size_t DIST_SIZE    = (1u << DIST_BITS) + 768u;
+inline constexpr size_t PRECODE_SIZE = 1u << PRECODE_BITS;
+
+inline constexpr uint16_t LEN_BASE[] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27,
+    31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+inline constexpr uint8_t LEN_EXTRA[] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+    2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+inline constexpr uint16_t DIST_BASE[] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129,
+    193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+
+inline constexpr uint8_t DIST_EXTRA[] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6,
+    6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+inline constexpr uint8_t PRECODE_ORDER[] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+//
+// Decode table entries are packed into 32 bits:
+//
+//   bits  0..4  - input bits the entry consumes
+//   bits  5..7  - Kind
+//   bits  8..11 - extra bits that follow (lengths, distances), or the index
+//                 width of the subtable for Kind::SubTable
+//   bits 16..31 - literal(s), base value, symbol or subtable offset
+//
+enum class Kind : uint32_t
+{
+    Invalid,
+    Literal,
+    Literal2, // two literals resolved by a single lookup
+    Length,
+    EndOfBlock,
+    SubTable,
+    Distance,
+    Symbol, // code length alphabet
+};
+
+constexpr uint32_t
+MakeEntry(Kind K, uint32_t Payload, uint32_t Extra = 0u, uint32_t Bits = 0u)
+{
+    return Bits | (uint32_t(K) << 5) | (Extra << 8) | (Payload << 16);
+}
+
+constexpr unsigned
+BitsOf(uint32_t E)
+{
+    return E & 31u;
+}
+
+constexpr Kind
+KindOf(uint32_t E)
+{
+    return Kind((E >> 5) & 7u);
+}
+
+constexpr unsigned
+ExtraOf(uint32_t E)
+{
+    return (E >> 8) & 15u;
+}
+
+constexpr uint32_t
+PayloadOf(uint32_t E)
+{
+    return E >> 16;
+}
+
+constexpr uint64_t
+LowBits(unsigned N)
+{
+    return (uint64_t(1) << N) - 1u;
+}
+
+constexpr uint32_t
+ReverseBits(uint32_t Code, unsigned Len)
+{
+    uint32_t r = 0u;
+    for (unsigned i = 0; i < Len; ++i)
+    {
+        r = (r << 1) | ((Code >> i) & 1u);
+    }
+    return r;
+}
+
+constexpr uint32_t
+LitLenEntry(size_t Sym)
+{
+    if (Sym < 256u)
+    {
+        return MakeEntry(Kind::Literal, uint32_t(Sym));
+    }
+    else if (Sym == 256u)
+    {
+        return MakeEntry(Kind::EndOfBlock, 0u);
+    }
+    else if (Sym < 286u)
+    {
+        return MakeEntry(Kind::Length, LEN_BASE[Sym - 257u], LEN_EXTRA[Sym - 257u]);
+    }
+
+    return MakeEntry(Kind::Invalid, 0u);
+}
+
+constexpr uint32_t
+DistEntry(size_t Sym)
+{
+    if (Sym < 30u)
+    {
+        return MakeEntry(Kind::Distance, DIST_BASE[Sym], DIST_EXTRA[Sym]);
+    }
+
+    return MakeEntry(Kind::Invalid, 0u);
+}
+
+constexpr uint32_t
+PrecodeEntry(size_t Sym)
+{
+    return MakeEntry(Kind::Symbol, uint32_t(Sym));
+}
+
+//
+// Builds a canonical Huffman decode table from code lengths. Codes up to
+// TableBitsV long are resolved by the main table directly, longer ones get
+// a subtable per main table slot, sized for the longest code under it.
+//
+// Like zlib, over-subscribed codes are rejected, and incomplete ones are only
+// tolerated when they consist of a single one bit code (and AllowIncomplete).
+//
+template<unsigned TableBitsV, size_t SizeV, class SymEntryT>
+constexpr bool
+BuildTable(
+    uint32_t (&Tbl)[SizeV],
+    const uint8_t* Lens,
+    size_t NumSyms,
+    SymEntryT SymEntry,
+    bool AllowIncomplete = true
+)
+{
+    static_assert(SizeV >= (1u << TableBitsV));
+
+    constexpr uint32_t MAIN_SIZE = 1u << TableBitsV;
+
+    uint16_t count[MAX_CODE_BITS + 1] = {};
+    for (size_t s = 0; s < NumSyms; ++s)
+    {
+        count[Lens[s]] += 1u;
+    }
+    count[0] = 0u;
+
+    int left        = 1;
+    unsigned maxLen = 0u;
+    for (unsigned len = 1; len <= MAX_CODE_BITS; ++len)
+    {
+        left <<= 1;
+        left -= count[len];
+        if (left < 0)
+        {
+            return false;
+        }
+
+        if (count[len] != 0u)
+        {
+            maxLen = len;
+        }
+    }
+
+    if (maxLen == 0u || left > 0)
+    {
+        if (maxLen > 1u || (maxLen == 1u && !AllowIncomplete))
+        {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < MAIN_SIZE; ++i)
+        {
+            Tbl[i] = MakeEntry(Kind::Invalid, 0u);
+        }
+    }
+
+    uint32_t next[MAX_CODE_BITS + 1] = {};
+    uint32_t code = 0u;
+    for (unsigned len = 1; len <= MAX_CODE_BITS; ++len)
+    {
+        code      = (code + count[len - 1]) << 1;
+        next[len] = code;
+    }
+
+    //
+    // subtables: the main table slot of each one records its offset and
+    // index width, which the fill loop below picks up again
+    //
+    if (maxLen > TableBitsV)
+    {
+        uint8_t subBits[MAIN_SIZE] = {};
+
+        uint32_t nextLong[MAX_CODE_BITS + 1] = {};
+        for (unsigned len = TableBitsV + 1u; len <= MAX_CODE_BITS; ++len)
+        {
+            nextLong[len] = next[len];
+        }
+
+        for (size_t s = 0; s < NumSyms; ++s)
+        {
+            unsigned len = Lens[s];
+            if (len > TableBitsV)
+            {
+                uint32_t rev    = ReverseBits(nextLong[len]++, len);
+                uint32_t prefix = rev & (MAIN_SIZE - 1u);
+                if (subBits[prefix] < len - TableBitsV)
+                {
+                    subBits[prefix] = uint8_t(len - TableBitsV);
+                }
+            }
+        }
+
+        size_t off = MAIN_SIZE;
+        for (uint32_t prefix = 0; prefix < MAIN_SIZE; ++prefix)
+        {
+            if (subBits[prefix] != 0u)
+            {
+                if (off + (size_t(1) << subBits[prefix]) > SizeV)
+                {
+                    return false;
+                }
+
+                Tbl[prefix] = MakeEntry(Kind::SubTable, uint32_t(off), subBits[prefix], TableBitsV);
+                off += size_t(1) << subBits[prefix];
+            }
+        }
+    }
+
+    for (size_t s = 0; s < NumSyms; ++s)
+    {
+        unsigned len = Lens[s];
+        if (len == 0u)
+        {
+            continue;
+        }
+
+        uint32_t rev = ReverseBits(next[len]++, len);
+        uint32_t e   = SymEntry(s);
+
+        if (len <= TableBitsV)
+        {
+            for (uint32_t i = rev; i < MAIN_SIZE; i += 1u << len)
+            {
+                Tbl[i] = e | len;
+            }
+        }
+        else
+        {
+            uint32_t sub     = Tbl[rev & (MAIN_SIZE - 1u)];
+            uint32_t subOff  = PayloadOf(sub);
+            uint32_t subSize = 1u << ExtraOf(sub);
+            unsigned subLen  = len - TableBitsV;
+            for (uint32_t i = rev >> TableBitsV; i < subSize; i += 1u << subLen)
+            {
+                Tbl[subOff + i] = e | subLen;
+            }
+        }
+    }
+
+    return true;
+}
+
+//
+// Turns main table slots whose bits hold two complete literal codes into a
+// single Kind::Literal2 entry. Walking downwards means Tbl[i >> bits] is
+// always still a plain entry when it is looked at.
+//
+template<unsigned TableBitsV, size_t SizeV>
+constexpr void
+PairLiterals(
+    uint32_t (&Tbl)[SizeV]
+)
+{
+    for (uint32_t i = 1u << TableBitsV; i-- > 0u;)
+    {
+        uint32_t e1 = Tbl[i];
+        if (KindOf(e1) != Kind::Literal || BitsOf(e1) >= TableBitsV)
+        {
+            continue;
+        }
+
+        uint32_t e2 = Tbl[i >> BitsOf(e1)];
+        if (KindOf(e2) != Kind::Literal || BitsOf(e1) + BitsOf(e2) > TableBitsV)
+        {
+            continue;
+        }
+
+        Tbl[i] = MakeEntry(
+            Kind::Literal2,
+            PayloadOf(e1) | (PayloadOf(e2) << 8),
+            0u,
+            BitsOf(e1) + BitsOf(e2)
+        );
+    }
+}
+
+struct FixedTables
+{
+    uint32_t LitLen[1u << LITLEN_BITS] = {};
+    uint32_t Dist[1u << DIST_BITS]     = {};
+};
+
+constexpr FixedTables
+MakeFixedTables()
+{
+    FixedTables t{};
+
+    uint8_t lens[288] = {};
+    for (size_t s = 0; s < 288u; ++s)
+    {
+        lens[s] = s < 144u ? 8u : s < 256u ? 9u : s < 280u ? 7u : 8u;
+    }
+    BuildTable<LITLEN_BITS>(t.LitLen, lens, 288u, LitLenEntry);
+    PairLiterals<LITLEN_BITS>(t.LitLen);
+
+    uint8_t distLens[32] = {};
+    for (size_t s = 0; s < 32u; ++s)
+    {
+        distLens[s] = 5u;
+    }
+    BuildTable<DIST_BITS>(t.Dist, distLens, 32u, DistEntry);
+
+    return t;
+}
+
+inline constexpr FixedTables FIXED = MakeFixedTables();
+
+inline uint64_t
+LoadLE64(const unsigned char* P)
+{
+    uint64_t v;
+    std::memcpy(&v, P, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    v = __builtin_bswap64(v);
+#endif
+    return v;
+}
+
+class BitReader
+{
+public:
+    explicit BitReader(
+        utils::RdBuf_t Src
+    )
+      : m_Beg(Src.data())
+      , m_In(Src.data())
+      , m_End(Src.data() + Src.size())
+    {
+    }
+
+    //
+    // Starts reading at an arbitrary bit of Src, positions stay relative to
+    // the beginning of Src.
+    //
+    BitReader(
+        utils::RdBuf_t Src,
+        size_t StartBit
+    )
+      : BitReader(Src)
+    {
+        m_In = m_Beg + std::min(StartBit >> 3, Src.size());
+        if (StartBit & 7u)
+        {
+            Refill();
+            Consume(StartBit & 7u);
+        }
+    }
+
+    //
+    // Tops the buffer up to at least 56 bits. Near the end of the input it
+    // falls back to single bytes, and past the end it shifts in zeros and
+    // counts them, so that running off the end is detected by Overrun().
+    //
+    void
+    Refill()
+    {
+        if (m_End - m_In >= 8)
+        {
+            m_Bits |= LoadLE64(m_In) << m_Cnt;
+            m_In += (63u - m_Cnt) >> 3;
+            m_Cnt |= 56u;
+        }
+        else
+        {
+            while (m_Cnt <= 56u)
+            {
+                if (m_In < m_End)
+                {
+                    m_Bits |= uint64_t(*m_In++) << m_Cnt;
+                }
+                else
+                {
+                    m_Zeros += 1u;
+                }
+                m_Cnt += 8u;
+            }
+        }
+    }
+
+    uint64_t
+    Peek() const
+    {
+        return m_Bits;
+    }
+
+    void
+    Consume(unsigned N)
+    {
+        m_Bits >>= N;
+        m_Cnt -= N;
+    }
+
+    uint32_t
+    Take(unsigned N)
+    {
+        uint32_t v = uint32_t(m_Bits & LowBits(N));
+        Consume(N);
+        return v;
+    }
+
+    //
+    // true once bits beyond the end of the input have been consumed
+    //
+    bool
+    Overrun() const
+    {
+        return m_Zeros * 8u > m_Cnt;
+    }
+
+    //
+    // Skips to the next byte boundary and returns the rest of the input from
+    // there on, with the bit buffer emptied (stored blocks are read byte
+    // wise). Continue() resumes bit reading at the given position.
+    //
+    utils::RdBuf_t
+    Detach()
+    {
+        Consume(m_Cnt & 7u);
+
+        size_t buffered = m_Cnt >> 3;
+        if (buffered < m_Zeros)
+        {
+            return {};
+        }
+
+        const unsigned char* pos = m_In - (buffered - m_Zeros);
+
+        m_Bits  = 0u;
+        m_Cnt   = 0u;
+        m_Zeros = 0u;
+        m_In    = pos;
+
+        return { pos, size_t(m_End - pos) };
+    }
+
+    void
+    Continue(const unsigned char* Pos)
+    {
+        m_In = Pos;
+    }
+
+    size_t
+    Consumed() const
+    {
+        return size_t(m_In - m_Beg) - ((m_Cnt >> 3) - m_Zeros);
+    }
+
+    size_t
+    BitPos() const
+    {
+        return (size_t(m_In - m_Beg) + m_Zeros) * 8u - m_Cnt;
+    }
+
+private:
+    const unsigned char* m_Beg;
+    const unsigned char* m_In;
+    const unsigned char* m_End;
+    uint64_t m_Bits = 0u;
+    unsigned m_Cnt  = 0u;
+    size_t m_Zeros  = 0u;
+};
+
+//
+// Copies a match of Len bytes from Dist bytes back. Matches that do not
+// overlap within a word are copied 8 bytes at a time, which may scribble up
+// to 7 bytes past the match - the caller guarantees that room, and the
+// bytes get overwritten by what follows anyway.
+//
+inline unsigned char*
+CopyMatch(
+    unsigned char* Out,
+    unsigned char* OutEnd,
+    size_t Dist,
+    size_t Len
+)
+{
+    const unsigned char* src = Out - Dist;
+    unsigned char* end       = Out + Len;
+
+    if (Dist >= 8u && OutEnd - end >= 8)
+    {
+        do
+        {
+            uint64_t w;
+            std::memcpy(&w, src, sizeof(w));
+            std::memcpy(Out, &w, sizeof(w));
+            src += 8;
+            Out += 8;
+        } while (Out < end);
+    }
+    else if (Dist == 1u)
+    {
+        std::memset(Out, *src, Len);
+    }
+    else
+    {
+        while (Out < end)
+        {
+            *Out++ = *src++;
+        }
+    }
+
+    return end;
+}
+
+//
+// Same for wider output symbols (see Decoder).
+//
+template<class SymT>
+inline SymT*
+CopyMatch(
+    SymT* Out,
+    SymT* OutEnd,
+    size_t Dist,
+    size_t Len
+)
+{
+    constexpr size_t PER_WORD = sizeof(uint64_t) / sizeof(SymT);
+
+    const SymT* src = Out - Dist;
+    SymT* end       = Out + Len;
+
+    if (Dist >= PER_WORD && size_t(OutEnd - end) >= PER_WORD)
+    {
+        do
+        {
+            uint64_t w;
+            std::memcpy(&w, src, sizeof(w));
+            std::memcpy(Out, &w, sizeof(w));
+            src += PER_WORD;
+            Out += PER_WORD;
+        } while (Out < end);
+    }
+    else
+    {
+        while (Out < end)
+        {
+            *Out++ = *src++;
+        }
+    }
+
+    return end;
+}
+
+//
+// Decodes into SymT's: unsigned char for plain output, or a wider type for
+// speculative decoding, where the output is preceded by placeholders for a
+// window that is not known yet (see zip/ParallelInflate.cpp). Everything
+// before the start position counts as window that matches may refer to.
+//
+template<class SymT>
+class Decoder
+{
+    static_assert(std::is_unsigned_v<SymT>);
+
+public:
+    Decoder(
+        utils::RdBuf_t Src,
+        utils::Span<SymT> Dst,
+        bool WithCrc = false
+    )
+      : m_Src(Src)
+      , m_Br(Src)
+      , m_OutBeg(Dst.data())
+      , m_Out(Dst.data())
+      , m_OutEnd(Dst.data() + Dst.size())
+      , m_CrcPos(WithCrc ? Dst.data() : nullptr)
+    {
+        static_assert(std::is_same_v<SymT, unsigned char> || sizeof(SymT) > 1u);
+    }
+
+    Err
+    Run()
+    {
+        bool last = false;
+        while (!last)
+        {
+            Err e = NextBlock(last);
+            if (e != Err::None)
+            {
+                return e;
+            }
+        }
+
+        return Err::None;
+    }
+
+    //
+    // Decodes a single block, Last is set when it was the final one. On
+    // failure the position is left somewhere inside the block.
+    //
+    Err
+    NextBlock(
+        bool& Last
+    )
+    {
+        m_Br.Refill();
+        Last          = m_Br.Take(1u) != 0u;
+        unsigned type = m_Br.Take(2u);
+
+        Err e = Err::BadData;
+        switch (type)
+        {
+            case 0u: e = StoredBlock(); break;
+            case 1u: e = Block(FIXED.LitLen, FIXED.Dist); break;
+            case 2u: e = DynamicBlock(); break;
+        }
+
+        if (e != Err::None)
+        {
+            return e;
+        }
+
+        if (m_Br.Overrun())
+        {
+            return Err::BadData;
+        }
+
+        Checksum(m_Out);
+
+        return Err::None;
+    }
+
+    //
+    // Continues at the given input bit, writing at Pos of Dst - e.g. to
+    // retry a block after growing the output, or to try another position.
+    //
+    void
+    Reposition(
+        size_t Bit,
+        utils::Span<SymT> Dst,
+        size_t Pos
+    )
+    {
+        m_Br     = BitReader{ m_Src, Bit };
+        m_OutBeg = Dst.data();
+        m_Out    = Dst.data() + Pos;
+        m_OutEnd = Dst.data() + Dst.size();
+    }
+
+    size_t
+    BitPos() const
+    {
+        return m_Br.BitPos();
+    }
+
+    size_t
+    Produced() const
+    {
+        return size_t(m_Out - m_OutBeg);
+    }
+
+    size_t
+    Consumed() const
+    {
+        return m_Br.Consumed();
+    }
+
+    uint32_t
+    Crc() const
+    {
+        return m_Crc;
+    }
+
+private:
+    //
+    // The crc trails the output by at most CRC_SLICE bytes (or one block),
+    // so the bytes it reads were written recently enough to still be cached.
+    //
+    static constexpr size_t CRC_SLICE = 256u * 1024u;
+
+    void
+    Checksum(
+        SymT* Upto
+    )
+    {
+        if constexpr (std::is_same_v<SymT, unsigned char>)
+        {
+            if (m_CrcPos)
+            {
+                m_Crc    = utils::Crc32(m_Crc, { m_CrcPos, size_t(Upto - m_CrcPos) });
+                m_CrcPos = Upto;
+            }
+        }
+    }
+
+    Err
+    StoredBlock()
+    {
+        utils::RdBuf_t in = m_Br.Detach();
+        if (in.size() < 4u)
+        {
+            return Err::BadData;
+        }
+
+        size_t len  = size_t(in[0]) | size_t(in[1]) << 8;
+        size_t nlen = size_t(in[2]) | size_t(in[3]) << 8;
+        if (len != (~nlen & 0xFFFFu) || len > in.size() - 4u)
+        {
+            return Err::BadData;
+        }
+
+        if (len > size_t(m_OutEnd - m_Out))
+        {
+            return Err::SizeMismatch;
+        }
+
+        m_Out = std::copy_n(in.data() + 4u, len, m_Out);
+
+        m_Br.Continue(in.data() + 4u + len);
+
+        return Err::None;
+    }
+
+    Err
+    DynamicBlock()
+    {
+        m_Br.Refill();
+
+        size_t numLitLen = m_Br.Take(5u) + 257u;
+        size_t numDist   = m_Br.Take(5u) + 1u;
+        size_t numPre    = m_Br.Take(4u) + 4u;
+        if (numLitLen > 286u || numDist > 30u)
+        {
+            return Err::BadData;
+        }
+
+        uint8_t preLens[19] = {};
+        for (size_t i = 0; i < numPre; ++i)
+        {
+            m_Br.Refill();
+            preLens[PRECODE_ORDER[i]] = uint8_t(m_Br.Take(3u));
+        }
+
+        uint32_t pre[PRECODE_SIZE];
+        if (!BuildTable<PRECODE_BITS>(pre, preLens, 19u, PrecodeEntry, false))
+        {
+            return Err::BadData;
+        }
+
+        uint8_t lens[286 + 30] = {};
+        for (size_t i = 0, n = numLitLen + numDist; i < n;)
+        {
+            m_Br.Refill();
+
+            uint32_t e = pre[m_Br.Peek() & LowBits(PRECODE_BITS)];
+            if (KindOf(e) != Kind::Symbol)
+            {
+                return Err::BadData;
+            }
+            m_Br.Consume(BitsOf(e));
+
+            uint32_t sym = PayloadOf(e);
+            if (sym < 16u)
+            {
+                lens[i++] = uint8_t(sym);
+                continue;
+            }
+
+            uint8_t val = 0u;
+            size_t rep  = 0u;
+            if (sym == 16u)
+            {
+                if (i == 0u)
+                {
+                    return Err::BadData;
+                }
+                val = lens[i - 1u];
+                rep = 3u + m_Br.Take(2u);
+            }
+            else if (sym == 17u)
+            {
+                rep = 3u + m_Br.Take(3u);
+            }
+            else
+            {
+                rep = 11u + m_Br.Take(7u);
+            }
+
+            if (rep > n - i)
+            {
+                return Err::BadData;
+            }
+
+            std::memset(lens + i, val, rep);
+            i += rep;
+        }
+
+        if (lens[256] == 0u)
+        {
+            return Err::BadData;
+        }
+
+        if (!BuildTable<LITLEN_BITS>(m_LitLen, lens, numLitLen, LitLenEntry)
+            || !BuildTable<DIST_BITS>(m_Dist, lens + numLitLen, numDist, DistEntry))
+        {
+            return Err::BadData;
+        }
+
+        PairLiterals<LITLEN_BITS>(m_LitLen);
+
+        return Block(m_LitLen, m_Dist);
+    }
+
+    Err
+    Block(
+        const uint32_t* LitLen,
+        const uint32_t* Dist
+    )
+    {
+        //
+        // work on locals, so that the compiler can keep them in registers
+        //
+        BitReader br   = m_Br;
+        SymT* outBeg   = m_OutBeg;
+        SymT* out      = m_Out;
+        SymT* outEnd   = m_OutEnd;
+        size_t crcNext = m_CrcPos ? size_t(m_CrcPos - outBeg) + CRC_SLICE : SIZE_MAX;
+
+        Err ret = Err::None;
+
+        while (true)
+        {
+            //
+            // one refill covers the worst case of a length code, its extra
+            // bits, a distance code and its extra bits: 15 + 5 + 15 + 13
+            //
+            br.Refill();
+
+            uint32_t e = LitLen[br.Peek() & LowBits(LITLEN_BITS)];
+            if (KindOf(e) == Kind::SubTable)
+            {
+                br.Consume(LITLEN_BITS);
+                e = LitLen[PayloadOf(e) + (br.Peek() & LowBits(ExtraOf(e)))];
+            }
+            br.Consume(BitsOf(e));
+
+            Kind kind = KindOf(e);
+            if (kind == Kind::Literal)
+            {
+                if (out == outEnd)
+                {
+                    ret = Err::SizeMismatch;
+                    break;
+                }
+                *out++ = SymT(PayloadOf(e));
+                continue;
+            }
+
+            if (kind == Kind::Literal2)
+            {
+                if (outEnd - out < 2)
+                {
+                    ret = Err::SizeMismatch;
+                    break;
+                }
+                out[0] = SymT(PayloadOf(e) & 0xFFu);
+                out[1] = SymT(PayloadOf(e) >> 8);
+                out += 2;
+                continue;
+            }
+
+            if (kind != Kind::Length)
+            {
+                ret = kind == Kind::EndOfBlock ? Err::None : Err::BadData;
+                break;
+            }
+
+            size_t len = PayloadOf(e) + br.Take(ExtraOf(e));
+
+            uint32_t d = Dist[br.Peek() & LowBits(DIST_BITS)];
+            if (KindOf(d) == Kind::SubTable)
+            {
+                br.Consume(DIST_BITS);
+                d = Dist[PayloadOf(d) + (br.Peek() & LowBits(ExtraOf(d)))];
+            }
+            br.Consume(BitsOf(d));
+
+            if (KindOf(d) != Kind::Distance)
+            {
+                ret = Err::BadData;
+                break;
+            }
+
+            size_t dist = PayloadOf(d) + br.Take(ExtraOf(d));
+            if (dist > size_t(out - outBeg))
+            {
+                ret = Err::BadData;
+                break;
+            }
+
+            if (len > size_t(outEnd - out))
+            {
+                ret = Err::SizeMismatch;
+                break;
+            }
+
+            out = CopyMatch(out, outEnd, dist, len);
+
+            //
+            // only checked after matches - literal runs are bounded by the
+            // block size anyway, and Run() catches up at each block end
+            //
+            if (size_t(out - outBeg) >= crcNext)
+            {
+                Checksum(out);
+                crcNext = size_t(out - outBeg) + CRC_SLICE;
+            }
+        }
+
+        m_Br  = br;
+        m_Out = out;
+
+        return ret;
+    }
+
+    utils::RdBuf_t m_Src;
+    BitReader m_Br;
+    SymT* m_OutBeg;
+    SymT* m_Out;
+    SymT* m_OutEnd;
+    SymT* m_CrcPos;
+    uint32_t m_Crc = 0u;
+
+    uint32_t m_LitLen[LITLEN_SIZE];
+    uint32_t m_Dist[DIST_SIZE];
+};
+
+}
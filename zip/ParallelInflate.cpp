@@ -0,0 +1,455 @@
+#include "zip/ParallelInflate.hpp"
+#include "zip/NativeInflate.hpp"
+#include "zip/NativeInflateImpl.hpp"
+#include "utils/Crc32.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace zip::Impl
+{
+
+constexpr size_t WINDOW = 32768u;
+
+//
+// Speculative output: literals as themselves, MARKER + i for byte i of the
+// unknown window in front of the chunk.
+//
+using Sym = uint16_t;
+
+constexpr Sym MARKER = 256u;
+
+constexpr size_t NO_BIT = SIZE_MAX;
+
+struct SpeculativeChunk
+{
+    size_t SearchBit = 0u;     // where to start looking for a block
+    size_t StartBit  = NO_BIT; // the block start that was found
+    size_t EndBit    = NO_BIT; // the block boundary decoding stopped at
+    bool Final       = false;  // decoding ended with the final block
+    Err E            = Err::None;
+
+    std::vector<Sym> Out; // WINDOW markers, followed by the output
+    size_t Produced = 0u; // including the markers
+
+    size_t Off = 0u;                // where the output goes in Dst
+    std::vector<unsigned char> Lut; // Sym -> byte, once the window is known
+    uint32_t Crc = 0u;
+
+    std::promise<size_t> Found; // StartBit, as soon as it is known
+    std::shared_future<size_t> FoundF;
+};
+
+//
+// Cheap pre-check before trying to decode at a position: a dynamic block
+// whose literal/length and distance counts are in range, and whose code
+// length code is complete. Nearly all positions fail one of these.
+//
+// W holds the input from the position on, the check needs its first 74 bits.
+//
+inline bool
+MaybeDynamicHeader(
+    unsigned __int128 W
+)
+{
+    uint32_t v = uint32_t(W);
+    if ((v & 6u) != 4u || ((v >> 3) & 31u) > 29u || ((v >> 8) & 31u) > 29u)
+    {
+        return false;
+    }
+
+    size_t numPre = ((v >> 13) & 15u) + 4u;
+    uint64_t lens = uint64_t(W >> 17);
+
+    unsigned kraft = 0u;
+    for (size_t i = 0; i < numPre && kraft <= 1u << PRECODE_BITS; ++i, lens >>= 3)
+    {
+        unsigned len = unsigned(lens) & 7u;
+        kraft += (1u << PRECODE_BITS) >> len & -unsigned(len != 0u);
+    }
+
+    return kraft == 1u << PRECODE_BITS;
+}
+
+//
+// 16 bytes of Src from Pos on, zero padded past the end
+//
+inline unsigned __int128
+Load128(
+    utils::RdBuf_t Src,
+    size_t Pos
+)
+{
+    unsigned char bytes[16] = {};
+    std::memcpy(bytes, Src.data() + Pos, std::min<size_t>(16u, Src.size() - Pos));
+
+    return LoadLE64(bytes) | (unsigned __int128)LoadLE64(bytes + 8) << 64;
+}
+
+//
+// One block, growing Out (if it is ours to grow) when the block does not fit.
+//
+template<class SymT>
+Err
+DecodeBlock(
+    Decoder<SymT>& Dec,
+    std::vector<SymT>* Out,
+    size_t MaxOut,
+    bool& Last
+)
+{
+    const size_t bit = Dec.BitPos();
+    const size_t pos = Dec.Produced();
+
+    while (true)
+    {
+        Err e = Dec.NextBlock(Last);
+        if (e != Err::SizeMismatch || !Out || Out->size() >= MaxOut)
+        {
+            return e;
+        }
+
+        Out->resize(std::min(MaxOut, Out->size() * 2u));
+        Dec.Reposition(bit, { Out->data(), Out->size() }, pos);
+    }
+}
+
+//
+// Decodes block by block until reaching the block start found by the next
+// chunk (or a later one, if the next found none), or the end of the stream.
+//
+template<class SymT>
+void
+DecodeChunk(
+    Decoder<SymT>& Dec,
+    std::vector<SymT>* Out,
+    size_t MaxOut,
+    std::vector<SpeculativeChunk>& Chunks,
+    size_t K,
+    bool Last
+)
+{
+    SpeculativeChunk& c = Chunks[K];
+
+    const size_t nominalEnd = K + 1u < Chunks.size() ? Chunks[K + 1u].SearchBit : NO_BIT;
+
+    size_t target    = NO_BIT;
+    bool targetKnown = nominalEnd == NO_BIT;
+
+    while (!Last)
+    {
+        size_t pos = Dec.BitPos();
+        if (!targetKnown && pos >= nominalEnd)
+        {
+            for (size_t j = K + 1u; j < Chunks.size() && target == NO_BIT; ++j)
+            {
+                target = Chunks[j].FoundF.get();
+            }
+            targetKnown = true;
+        }
+
+        if (pos >= target)
+        {
+            break;
+        }
+
+        Err e = DecodeBlock(Dec, Out, MaxOut, Last);
+        if (e != Err::None)
+        {
+            c.E = e;
+            return;
+        }
+    }
+
+    c.EndBit   = Dec.BitPos();
+    c.Final    = Last;
+    c.Produced = Dec.Produced();
+}
+
+void
+Speculate(
+    utils::RdBuf_t Src,
+    std::vector<SpeculativeChunk>& Chunks,
+    size_t K,
+    size_t MaxOut
+)
+{
+    SpeculativeChunk& c = Chunks[K];
+
+    const size_t limitBit = K + 1u < Chunks.size() ? Chunks[K + 1u].SearchBit : Src.size() * 8u;
+
+    c.Out.resize(std::min(MaxOut, 4u * WINDOW));
+    for (size_t i = 0; i < WINDOW; ++i)
+    {
+        c.Out[i] = Sym(MARKER + i);
+    }
+
+    Decoder<Sym> dec{ Src, { c.Out.data(), c.Out.size() } };
+
+    //
+    // the first position that decodes as a complete dynamic block is taken
+    // as the start - if that is wrong, the chunk before will not end there
+    //
+    bool last = false;
+    for (size_t pos = c.SearchBit >> 3; pos < limitBit >> 3 && c.StartBit == NO_BIT; ++pos)
+    {
+        const unsigned __int128 w = Load128(Src, pos);
+
+        for (unsigned shift = 0; shift < 8u; ++shift)
+        {
+            if (!MaybeDynamicHeader(w >> shift))
+            {
+                continue;
+            }
+
+            size_t bit = pos * 8u + shift;
+            dec.Reposition(bit, { c.Out.data(), c.Out.size() }, WINDOW);
+            if (DecodeBlock(dec, &c.Out, MaxOut, last) == Err::None)
+            {
+                c.StartBit = bit;
+                break;
+            }
+        }
+    }
+
+    c.Found.set_value(c.StartBit);
+
+    if (c.StartBit != NO_BIT)
+    {
+        DecodeChunk(dec, &c.Out, MaxOut, Chunks, K, last);
+    }
+}
+
+//
+// Sym -> byte for a chunk at Off: literals map to themselves, markers to the
+// bytes of the window, which have to be final in Dst by now.
+//
+inline void
+MakeLut(
+    SpeculativeChunk& C,
+    utils::RdBuf_t Dst
+)
+{
+    C.Lut.resize(MARKER + WINDOW);
+    for (size_t i = 0; i < MARKER; ++i)
+    {
+        C.Lut[i] = uint8_t(i);
+    }
+    std::memcpy(C.Lut.data() + MARKER, Dst.data() + C.Off - WINDOW, WINDOW);
+}
+
+//
+// Writes output symbols [From, To) of C to Dst, markers replaced.
+//
+inline void
+ResolveMarkers(
+    const SpeculativeChunk& C,
+    utils::WrBuf_t Dst,
+    size_t From,
+    size_t To
+)
+{
+    const Sym* in            = C.Out.data() + WINDOW;
+    const unsigned char* lut = C.Lut.data();
+    unsigned char* out       = Dst.data() + C.Off;
+
+    for (size_t i = From; i < To; ++i)
+    {
+        out[i] = lut[in[i]];
+    }
+}
+
+}
+
+namespace zip
+{
+
+Err
+ParallelInflateInto(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst,
+    uint32_t* Crc,
+    const ParallelInflateConfig& Config,
+    ParallelInflateStats* Stats
+)
+{
+    using namespace Impl;
+
+    ParallelInflateStats stats;
+
+    auto serial = [&]()
+    {
+        stats.Chunks = 1u;
+        if (Stats)
+        {
+            *Stats = stats;
+        }
+        return NativeInflateInto(Src, Dst, Crc);
+    };
+
+    size_t threads = Config.Threads ? Config.Threads : std::max(1u, std::thread::hardware_concurrency());
+    threads        = std::min(threads, Src.size() / std::max<size_t>(Config.MinChunk, 1u));
+    if (threads <= 1u)
+    {
+        return serial();
+    }
+
+    std::vector<SpeculativeChunk> chunks(threads);
+    for (size_t k = 0; k < threads; ++k)
+    {
+        chunks[k].SearchBit = Src.size() * k / threads * 8u;
+        chunks[k].FoundF    = chunks[k].Found.get_future().share();
+    }
+    chunks[0].StartBit = 0u;
+
+    //
+    // a worker holds two bytes per output byte, so no chunk may grow past
+    // twice its share: one that does is taken as failed speculation, and
+    // the serial decoder gets the stream
+    //
+    const size_t maxOut = WINDOW + 2u * (Dst.size() / threads);
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1u);
+    for (size_t k = 1; k < threads; ++k)
+    {
+        workers.emplace_back(Speculate, Src, std::ref(chunks), k, maxOut);
+    }
+
+    //
+    // the first chunk knows its window (none), so it goes straight to Dst
+    //
+    Decoder<unsigned char> first{ Src, Dst, Crc != nullptr };
+    DecodeChunk<unsigned char>(first, nullptr, 0u, chunks, 0u, false);
+
+    for (auto& w : workers)
+    {
+        w.join();
+    }
+
+    stats.Fallback = true;
+
+    if (chunks[0].E != Err::None)
+    {
+        return serial();
+    }
+
+    //
+    // the chunks that found a block start have to line up: each has to start
+    // exactly where the decoding of the one before stopped
+    //
+    std::vector<size_t> used{ 0u };
+    for (size_t k = 1; k < threads; ++k)
+    {
+        const SpeculativeChunk& c = chunks[k];
+        if (c.StartBit == NO_BIT)
+        {
+            continue;
+        }
+
+        const SpeculativeChunk& p = chunks[used.back()];
+        if (p.Final || p.EndBit != c.StartBit || c.E != Err::None)
+        {
+            return serial();
+        }
+
+        used.push_back(k);
+    }
+
+    if (!chunks[used.back()].Final)
+    {
+        return serial();
+    }
+
+    //
+    // a window reaching before the start of the stream would be corrupt data
+    // (or a tiny first chunk), left for the serial decoder to sort out
+    //
+    size_t off = chunks[0].Produced;
+    for (size_t i = 1; i < used.size(); ++i)
+    {
+        SpeculativeChunk& c = chunks[used[i]];
+
+        size_t n = c.Produced - WINDOW;
+        if (off < WINDOW || n > Dst.size() - off)
+        {
+            return serial();
+        }
+
+        c.Off = off;
+        off += n;
+    }
+
+    if (off != Dst.size())
+    {
+        return serial();
+    }
+
+    //
+    // Only the last WINDOW bytes of a chunk make up the window of the next
+    // one, so those are resolved in order first, the rest in parallel.
+    //
+    for (size_t i = 1; i < used.size(); ++i)
+    {
+        SpeculativeChunk& c = chunks[used[i]];
+
+        size_t n = c.Produced - WINDOW;
+        MakeLut(c, Dst);
+        ResolveMarkers(c, Dst, n - std::min(n, WINDOW), n);
+    }
+
+    auto finish = [&chunks, Dst, Crc](size_t K)
+    {
+        SpeculativeChunk& c = chunks[K];
+
+        size_t n = c.Produced - WINDOW;
+        ResolveMarkers(c, Dst, 0u, n - std::min(n, WINDOW));
+        if (Crc)
+        {
+            c.Crc = utils::Crc32(0u, { Dst.data() + c.Off, n });
+        }
+
+        std::vector<Sym>().swap(c.Out);
+    };
+
+    workers.clear();
+    for (size_t i = 2; i < used.size(); ++i)
+    {
+        workers.emplace_back(finish, used[i]);
+    }
+
+    if (used.size() > 1u)
+    {
+        finish(used[1]);
+    }
+
+    for (auto& w : workers)
+    {
+        w.join();
+    }
+
+    uint32_t crc = first.Crc();
+    for (size_t i = 1; i < used.size(); ++i)
+    {
+        crc = utils::Crc32Combine(crc, chunks[used[i]].Crc, chunks[used[i]].Produced - WINDOW);
+    }
+
+    stats.Chunks   = used.size();
+    stats.Fallback = false;
+    if (Stats)
+    {
+        *Stats = stats;
+    }
+
+    if (Crc)
+    {
+        *Crc = crc;
+    }
+
+    return Err::None;
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "zip/Err.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/WrBuf.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace zip
+{
+
+struct ParallelInflateConfig
+{
+    //
+    // number of threads to split across (the caller included), 0 for
+    // std::thread::hardware_concurrency()
+    //
+    unsigned Threads = 0u;
+
+    //
+    // compressed bytes per thread, streams shorter than two of these are
+    // inflated serially
+    //
+    size_t MinChunk = 4u * 1024u * 1024u;
+};
+
+struct ParallelInflateStats
+{
+    size_t Chunks = 0u;    // pieces that were decoded concurrently
+    bool Fallback = false; // speculation failed, the stream was decoded serially
+};
+
+//
+// Inflates a single raw deflate stream on several threads, in the style of
+// pugz and rapidgzip. The compressed data is cut into chunks; every worker
+// but the first looks for something that decodes as a dynamic block header
+// near the start of its chunk and decodes from there with the preceding
+// 32 KB window still unknown, recording back-references into it as markers.
+// The first chunk is decoded normally. Once a chunk is known to end exactly
+// where the next one started, the markers of the next one are resolved from
+// the now known output before it.
+//
+// The result is byte-identical to NativeInflateInto, which is also what it
+// falls back to when the speculation does not work out (no block starts
+// found, a false positive, corrupt data). Dst and Crc as for InflateInto.
+//
+Err
+ParallelInflateInto(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst,
+    uint32_t* Crc = nullptr,
+    const ParallelInflateConfig& Config = {},
+    ParallelInflateStats* Stats = nullptr
+);
+
+}
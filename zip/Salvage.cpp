@@ -0,0 +1,255 @@
+#include "zip/Salvage.hpp"
+#include "zip/CDScan.hpp"
+#include "zip/DataDescriptor.hpp"
+#include "zip/InflateContext.hpp"
+#include "utils/Crc32.hpp"
+#include "utils/SigScan.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <thread>
+
+namespace zip::Impl
+{
+
+//
+// A candidate that passed, and where the bytes that belong to it end: its
+// data, and the data descriptor after it if there is one.
+//
+struct Salvaged
+{
+    SalvagedEntry entry;
+    uint64_t end = 0u;
+};
+
+//
+// Where the deflate stream at the start of Data ends, with its inflated
+// size and crc, or nullopt when it does not end inside Data.
+//
+std::optional<DataDescriptor>
+DeflateEnd(
+    utils::RdBuf_t Data
+)
+{
+    auto ctx = InflateContextPool::ThreadLocal().Acquire();
+    if (ctx->Begin() != Err::None)
+    {
+        return std::nullopt;
+    }
+
+    unsigned char out[16384];
+
+    utils::RdBuf_t src = Data;
+    DataDescriptor dd{ 0u, 0u, 0u };
+    bool end = false;
+    while (!end)
+    {
+        size_t produced = 0u;
+        if (ctx->Step(src, { out, sizeof out }, produced, end) != Err::None)
+        {
+            return std::nullopt;
+        }
+
+        dd.crc32 = utils::Crc32(dd.crc32, { out, produced });
+        dd.originalSz += produced;
+    }
+
+    dd.compressedSz = Data.size() - src.size();
+    return dd;
+}
+
+//
+// The first data descriptor after the start of Data (with its signature)
+// whose compressed size is the distance to it. Where it starts is
+// Data.data() + its compressedSz.
+//
+std::optional<DataDescriptor>
+DescriptorAfter(
+    utils::RdBuf_t Data,
+    bool Zip64
+)
+{
+    std::optional<DataDescriptor> found;
+    utils::ForEachSig(
+        Data,
+        DataDescriptor::SIG,
+        utils::SigScanDir::Forward,
+        [&](size_t At)
+        {
+            auto [dd, rem] = DataDescriptor::read(Data.subspan(At), Zip64);
+            if (dd && dd->compressedSz == At)
+            {
+                found = dd;
+            }
+            return !found;
+        }
+    );
+
+    return found;
+}
+
+std::optional<Salvaged>
+SalvageAt(
+    utils::RdBuf_t ZipBuf,
+    size_t Offset
+)
+{
+    auto [lfh, dataBuf] = LFHeader::read(
+        ZipBuf.subspan(Offset, std::min(LFHeader::MaxBytes(), ZipBuf.size() - Offset))
+    );
+    if (!lfh || !Validate(*lfh, ZipBuf.size()))
+    {
+        return std::nullopt;
+    }
+
+    const size_t dataAt        = size_t(dataBuf.data() - ZipBuf.data());
+    const utils::RdBuf_t rest  = ZipBuf.subspan(dataAt);
+
+    Salvaged s{ { *lfh, Offset, rest, true }, dataAt };
+
+    if ((lfh->flags & DataDescriptor::FLAG) == 0u)
+    {
+        if (lfh->compressedSz <= rest.size())
+        {
+            s.entry.fileBuf   = rest.first(lfh->compressedSz);
+            s.entry.truncated = false;
+            s.end             = dataAt + lfh->compressedSz;
+        }
+        else
+        {
+            s.end = ZipBuf.size();
+        }
+
+        return s;
+    }
+
+    //
+    // the sizes are in a descriptor after the data, which can only be
+    // found by its length: the end of the deflate stream, or a descriptor
+    // that agrees with its own distance from the data
+    //
+    const bool zip64 = DataDescriptor::IsZip64(*lfh);
+
+    std::optional<DataDescriptor> dd;
+    if (lfh->compression == 8u)
+    {
+        dd = DeflateEnd(rest);
+        if (dd)
+        {
+            //
+            // a damaged stream may well end early: the descriptor has to
+            // agree, unless the file ends before it does
+            //
+            auto [written, rem] = DataDescriptor::read(rest.subspan(dd->compressedSz), zip64);
+            if (written && written->compressedSz == dd->compressedSz && written->originalSz == dd->originalSz)
+            {
+                //
+                // the recorded crc, so that the data is still checked
+                //
+                dd->crc32 = written->crc32;
+                s.end     = uint64_t(rem.data() - ZipBuf.data());
+            }
+            else if (!written && rem.size() < DataDescriptor::SIG.size() + DataDescriptor::Format64::MinBytes())
+            {
+                s.end = ZipBuf.size();
+            }
+            else
+            {
+                dd.reset();
+            }
+        }
+    }
+    else
+    {
+        dd = DescriptorAfter(rest, zip64);
+        if (dd)
+        {
+            s.end = uint64_t(DataDescriptor::read(rest.subspan(dd->compressedSz), zip64).second.data() - ZipBuf.data());
+        }
+    }
+
+    if (dd)
+    {
+        s.entry.lfh.crc32        = dd->crc32;
+        s.entry.lfh.compressedSz = dd->compressedSz;
+        s.entry.lfh.originalSz   = dd->originalSz;
+        s.entry.fileBuf          = rest.first(dd->compressedSz);
+        s.entry.truncated        = false;
+    }
+
+    return s;
+}
+
+}
+
+namespace zip
+{
+
+std::vector<SalvagedEntry>
+Salvage(
+    utils::RdBuf_t ZipBuf,
+    const SalvageConfig& Config
+)
+{
+    size_t threads = Config.Threads ? Config.Threads : std::max(1u, std::thread::hardware_concurrency());
+    threads        = std::min(threads, std::max<size_t>(1u, ZipBuf.size() / std::max<size_t>(1u, Config.MinChunk)));
+    threads        = ZipBuf.size() < Config.Threshold ? 1u : threads;
+
+    //
+    // each chunk: the candidates that start in it, the signature allowed to
+    // run past its end
+    //
+    const size_t chunk = ZipBuf.size() / threads;
+
+    std::vector<std::vector<Impl::Salvaged>> found(threads);
+    Impl::ForEachPart(
+        threads,
+        [&](size_t P)
+        {
+            const size_t begin = P * chunk;
+            const size_t end   = P + 1u < threads ? begin + chunk : ZipBuf.size();
+
+            const utils::RdBuf_t part = ZipBuf.first(std::min(ZipBuf.size(), end + LFHeader::SIG.size() - 1u));
+            for (size_t sig = utils::FindSig(part, LFHeader::SIG, begin); sig < end; sig = utils::FindSig(part, LFHeader::SIG, sig + 1u))
+            {
+                if (auto s = Impl::SalvageAt(ZipBuf, sig))
+                {
+                    found[P].push_back(std::move(*s));
+                }
+            }
+        }
+    );
+
+    //
+    // front to back, each entry swallowing the candidates inside its data;
+    // one whose end is unknown covers just its header, and its data is cut
+    // off at the next entry
+    //
+    std::vector<SalvagedEntry> entries;
+    uint64_t covered = 0u;
+    for (auto& f : found)
+    {
+        for (auto& s : f)
+        {
+            if (s.entry.lfhOffset < covered)
+            {
+                continue;
+            }
+
+            if (!entries.empty() && entries.back().truncated)
+            {
+                auto& prev = entries.back();
+                prev.fileBuf = prev.fileBuf.first(
+                    std::min<size_t>(prev.fileBuf.size(), s.entry.lfhOffset - uint64_t(prev.fileBuf.data() - ZipBuf.data()))
+                );
+            }
+
+            covered = s.end;
+            entries.push_back(std::move(s.entry));
+        }
+    }
+
+    return entries;
+}
+
+}
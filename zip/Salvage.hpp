@@ -0,0 +1,79 @@
+#pragma once
+
+#include "zip/Archive.hpp"
+#include "zip/LFHeader.hpp"
+#include "utils/RdBuf.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace zip
+{
+
+struct SalvageConfig
+{
+    //
+    // files shorter than this are scanned on the calling thread
+    //
+    size_t Threshold = 64u * 1024u * 1024u;
+
+    //
+    // number of threads to split across (the caller included), 0 for
+    // std::thread::hardware_concurrency()
+    //
+    unsigned Threads = 0u;
+
+    //
+    // the smallest share of the file worth a thread
+    //
+    size_t MinChunk = 16u * 1024u * 1024u;
+};
+
+//
+// An entry recovered from its local header alone.
+//
+struct SalvagedEntry
+{
+    //
+    // with the sizes and crc filled in from the data descriptor, or from
+    // the data itself, where the header defers them to a descriptor
+    //
+    LFHeader lfh;
+    uint64_t lfhOffset = 0u;
+
+    //
+    // the compressed data - only what is left of it when truncated
+    //
+    utils::RdBuf_t fileBuf;
+
+    //
+    // the data runs past the end of the file, or where it ends could not be
+    // told (a broken deflate stream, a descriptor that is not there)
+    //
+    bool truncated = false;
+};
+
+//
+// A best-effort entry list for a zip whose central directory is damaged or
+// missing (a truncated download, say), rebuilt by scanning the whole of
+// ZipBuf for local headers.
+//
+// Above Config.Threshold the file is cut into chunks that are scanned at
+// once, each for LFHeader::SIG with utils::FindSig(). A candidate has to
+// pass Validate(LFHeader...), and its data has to end where the header
+// says - or, for an entry with a data descriptor, where its deflate stream
+// ends or a descriptor matching the length of the data starts. The chunks
+// are then merged front to back, each entry covering its data: signatures
+// inside it (a stored zip in the zip, or chance) are not entries.
+//
+// Only entries with a data descriptor cost more than the scan itself, the
+// deflated ones an inflate each to find the end of their stream.
+//
+std::vector<SalvagedEntry>
+Salvage(
+    utils::RdBuf_t ZipBuf,
+    const SalvageConfig& Config = {}
+);
+
+}
@@ -0,0 +1,439 @@
+#include "zip/SidecarIndex.hpp"
+#include "zip/Archive.hpp"
+#include "utils/Crc32.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+namespace zip::Impl
+{
+
+constexpr uint32_t SIDECAR_MAGIC   = 0x5843535au; // "ZSCX"
+constexpr uint32_t SIDECAR_VERSION = 1u;
+constexpr uint32_t SIDECAR_EMPTY   = ~uint32_t(0u);
+
+static_assert(
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__,
+    "the sidecar format is little endian, and is mapped as is"
+);
+
+bool
+InBounds(
+    uint64_t Off,
+    uint64_t Count,
+    uint64_t ItemSz,
+    uint64_t FileSz
+)
+{
+    return Off % 8u == 0u
+        && Off <= FileSz
+        && Count <= (FileSz - Off) / ItemSz;
+}
+
+void
+Append(
+    std::vector<unsigned char>& Dst,
+    uint64_t Off,
+    const void* Src,
+    size_t Bytes
+)
+{
+    Dst.resize(Off);
+    Dst.insert(Dst.end(), (const unsigned char*)Src, (const unsigned char*)Src + Bytes);
+}
+
+Err
+WriteAll(
+    int Fd,
+    const std::vector<unsigned char>& Buf
+)
+{
+    size_t done = 0u;
+    while (done < Buf.size())
+    {
+        errno     = 0;
+        ssize_t n = write(Fd, Buf.data() + done, Buf.size() - done);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+
+        if (n <= 0)
+        {
+            return Err::Io;
+        }
+
+        done += size_t(n);
+    }
+
+    return Err::None;
+}
+
+Err
+WriteAtomically(
+    const std::vector<unsigned char>& Buf,
+    const char* Path
+)
+{
+    //
+    // a reader never maps a half written file: it sees the old one or the
+    // new one
+    //
+    const std::string tmp = std::string(Path) + ".tmp" + std::to_string(getpid());
+
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd <= -1)
+    {
+        return Err::Io;
+    }
+
+    Err e = WriteAll(fd, Buf);
+    if (close(fd) != 0 && e == Err::None)
+    {
+        e = Err::Io;
+    }
+
+    if (e == Err::None && std::rename(tmp.c_str(), Path) != 0)
+    {
+        e = Err::Io;
+    }
+
+    if (e != Err::None)
+    {
+        unlink(tmp.c_str());
+    }
+
+    return e;
+}
+
+}
+
+namespace zip
+{
+
+uint32_t
+SidecarIndex::Fingerprint(
+    const Archive& A
+)
+{
+    return Fingerprint(A.Buffer(), A.CDirs());
+}
+
+uint32_t
+SidecarIndex::Fingerprint(
+    utils::RdBuf_t ZipBuf,
+    const std::vector<CDir>& CDirs
+)
+{
+    uint32_t crc = 0u;
+    for (const auto& cdir : CDirs)
+    {
+        const EOCDRec& eocd = cdir.eocd;
+
+        const uint64_t fields[] = { eocd.totalEntries, eocd.sizeOfCentralDir, eocd.offsetOfCentralDir };
+        crc = utils::Crc32(crc, { (const unsigned char*)fields, sizeof(fields) });
+        crc = utils::Crc32Parallel(crc, ZipBuf.subspan(eocd.offsetOfCentralDir, eocd.sizeOfCentralDir));
+    }
+
+    return crc;
+}
+
+bool
+SidecarIndex::Matches(
+    const Archive& A
+) const
+{
+    return m_Hdr != nullptr
+        && m_Hdr->ArchiveSz == A.Buffer().size()
+        && m_Hdr->CDirs == A.CDirs().size()
+        && m_Hdr->Fingerprint == Fingerprint(A);
+}
+
+Err
+SidecarIndex::Write(
+    const Archive& A,
+    const char* Path
+)
+{
+    std::vector<uint64_t> cdOffset;
+    std::vector<uint64_t> lfhOffset;
+    std::vector<uint64_t> compressedSz;
+    std::vector<uint64_t> originalSz;
+    std::vector<uint32_t> crc;
+    std::vector<uint16_t> method;
+    std::vector<uint16_t> cdirOf;
+    std::vector<uint32_t> nameOffset{ 0u };
+    std::vector<char> names;
+
+    for (size_t k = 0; k < A.CDirs().size(); ++k)
+    {
+        ForEachCDFHeader(
+            A.CDirs()[k],
+            A.Buffer(),
+            [&, k](const CDFHeader& Cdfh, uint64_t CdOffset)
+            {
+                cdOffset.push_back(CdOffset);
+                lfhOffset.push_back(Cdfh.offsetOfLFHeader);
+                compressedSz.push_back(Cdfh.compressedSz);
+                originalSz.push_back(Cdfh.originalSz);
+                crc.push_back(Cdfh.crc32);
+                method.push_back(Cdfh.compression);
+                cdirOf.push_back(uint16_t(k));
+
+                names.insert(names.end(), Cdfh.name.begin(), Cdfh.name.end());
+                nameOffset.push_back(names.size());
+                return true;
+            }
+        );
+    }
+
+    const size_t n = cdOffset.size();
+    if (n >= Impl::SIDECAR_EMPTY || names.size() > std::numeric_limits<uint32_t>::max())
+    {
+        return Err::Unsupported;
+    }
+
+    //
+    // the same table as NameIndex: linear probing, at most half full, the
+    // first of several equal names wins
+    //
+    size_t slots = 16u;
+    while (slots < n * 2u)
+    {
+        slots *= 2u;
+    }
+
+    std::vector<Impl::SidecarSlot> table(slots, { 0u, Impl::SIDECAR_EMPTY });
+    for (size_t e = 0; e < n; ++e)
+    {
+        const std::string_view name{ names.data() + nameOffset[e], size_t(nameOffset[e + 1u] - nameOffset[e]) };
+        const uint64_t h   = NameIndex::Hash(name);
+        const uint32_t tag = uint32_t(h >> 32);
+
+        for (size_t i = h & (slots - 1u);; i = (i + 1u) & (slots - 1u))
+        {
+            Impl::SidecarSlot& s = table[i];
+            if (s.Entry == Impl::SIDECAR_EMPTY)
+            {
+                s = { tag, uint32_t(e) };
+                break;
+            }
+
+            const size_t other = s.Entry;
+            if (s.Tag == tag
+                && nameOffset[other + 1u] - nameOffset[other] == name.size()
+                && std::memcmp(names.data() + nameOffset[other], name.data(), name.size()) == 0)
+            {
+                break;
+            }
+        }
+    }
+
+    Impl::SidecarHeader hdr{};
+    hdr.Magic        = Impl::SIDECAR_MAGIC;
+    hdr.Version      = Impl::SIDECAR_VERSION;
+    hdr.ArchiveSz    = A.Buffer().size();
+    hdr.Fingerprint  = Fingerprint(A);
+    hdr.CDirs        = uint32_t(A.CDirs().size());
+    hdr.Entries      = n;
+    hdr.Slots        = slots;
+    hdr.NamesBytes   = names.size();
+    hdr.CdOffset     = sizeof(hdr);
+    hdr.LFHOffset    = Impl::Align8(hdr.CdOffset + n * sizeof(uint64_t));
+    hdr.CompressedSz = Impl::Align8(hdr.LFHOffset + n * sizeof(uint64_t));
+    hdr.OriginalSz   = Impl::Align8(hdr.CompressedSz + n * sizeof(uint64_t));
+    hdr.Crc          = Impl::Align8(hdr.OriginalSz + n * sizeof(uint64_t));
+    hdr.Method       = Impl::Align8(hdr.Crc + n * sizeof(uint32_t));
+    hdr.CDir         = Impl::Align8(hdr.Method + n * sizeof(uint16_t));
+    hdr.NameOffset   = Impl::Align8(hdr.CDir + n * sizeof(uint16_t));
+    hdr.Names        = Impl::Align8(hdr.NameOffset + (n + 1u) * sizeof(uint32_t));
+    hdr.Table        = Impl::Align8(hdr.Names + names.size());
+
+    std::vector<unsigned char> buf;
+    buf.reserve(hdr.Table + slots * sizeof(Impl::SidecarSlot));
+    Impl::Append(buf, 0u, &hdr, sizeof(hdr));
+    Impl::Append(buf, hdr.CdOffset, cdOffset.data(), n * sizeof(uint64_t));
+    Impl::Append(buf, hdr.LFHOffset, lfhOffset.data(), n * sizeof(uint64_t));
+    Impl::Append(buf, hdr.CompressedSz, compressedSz.data(), n * sizeof(uint64_t));
+    Impl::Append(buf, hdr.OriginalSz, originalSz.data(), n * sizeof(uint64_t));
+    Impl::Append(buf, hdr.Crc, crc.data(), n * sizeof(uint32_t));
+    Impl::Append(buf, hdr.Method, method.data(), n * sizeof(uint16_t));
+    Impl::Append(buf, hdr.CDir, cdirOf.data(), n * sizeof(uint16_t));
+    Impl::Append(buf, hdr.NameOffset, nameOffset.data(), (n + 1u) * sizeof(uint32_t));
+    Impl::Append(buf, hdr.Names, names.data(), names.size());
+    Impl::Append(buf, hdr.Table, table.data(), slots * sizeof(Impl::SidecarSlot));
+
+    return Impl::WriteAtomically(buf, Path);
+}
+
+utils::Expected<SidecarIndex, Err>
+SidecarIndex::Open(
+    const char* Path
+)
+{
+    SidecarIndex s;
+    s.m_File = utils::MemoryMappedFile{ Path };
+    if (!s.m_File.IsValid())
+    {
+        return utils::UnExpected{ Err::Io };
+    }
+
+    const utils::RdBuf_t buf = s.m_File.Buffer();
+    if (buf.size() < sizeof(Impl::SidecarHeader))
+    {
+        return utils::UnExpected{ Err::BadData };
+    }
+
+    const auto* hdr  = reinterpret_cast<const Impl::SidecarHeader*>(buf.data());
+    const uint64_t n = hdr->Entries;
+    const uint64_t z = buf.size();
+
+    if (hdr->Magic != Impl::SIDECAR_MAGIC || hdr->Version != Impl::SIDECAR_VERSION)
+    {
+        return utils::UnExpected{ Err::BadData };
+    }
+
+    //
+    // the table needs an empty slot for lookups to stop at, and entry
+    // numbers must fit its slots
+    //
+    const bool ok = n < Impl::SIDECAR_EMPTY
+        && hdr->Slots > n
+        && (hdr->Slots & (hdr->Slots - 1u)) == 0u
+        && Impl::InBounds(hdr->CdOffset, n, sizeof(uint64_t), z)
+        && Impl::InBounds(hdr->LFHOffset, n, sizeof(uint64_t), z)
+        && Impl::InBounds(hdr->CompressedSz, n, sizeof(uint64_t), z)
+        && Impl::InBounds(hdr->OriginalSz, n, sizeof(uint64_t), z)
+        && Impl::InBounds(hdr->Crc, n, sizeof(uint32_t), z)
+        && Impl::InBounds(hdr->Method, n, sizeof(uint16_t), z)
+        && Impl::InBounds(hdr->CDir, n, sizeof(uint16_t), z)
+        && Impl::InBounds(hdr->NameOffset, n + 1u, sizeof(uint32_t), z)
+        && Impl::InBounds(hdr->Names, hdr->NamesBytes, 1u, z)
+        && Impl::InBounds(hdr->Table, hdr->Slots, sizeof(Impl::SidecarSlot), z);
+    if (!ok)
+    {
+        return utils::UnExpected{ Err::BadData };
+    }
+
+    auto at = [&buf](uint64_t Off)
+    {
+        return buf.data() + Off;
+    };
+
+    s.m_Hdr          = hdr;
+    s.m_CdOffset     = reinterpret_cast<const uint64_t*>(at(hdr->CdOffset));
+    s.m_LFHOffset    = reinterpret_cast<const uint64_t*>(at(hdr->LFHOffset));
+    s.m_CompressedSz = reinterpret_cast<const uint64_t*>(at(hdr->CompressedSz));
+    s.m_OriginalSz   = reinterpret_cast<const uint64_t*>(at(hdr->OriginalSz));
+    s.m_Crc          = reinterpret_cast<const uint32_t*>(at(hdr->Crc));
+    s.m_Method       = reinterpret_cast<const uint16_t*>(at(hdr->Method));
+    s.m_CDir         = reinterpret_cast<const uint16_t*>(at(hdr->CDir));
+    s.m_NameOffset   = reinterpret_cast<const uint32_t*>(at(hdr->NameOffset));
+    s.m_Names        = reinterpret_cast<const char*>(at(hdr->Names));
+    s.m_Table        = reinterpret_cast<const Impl::SidecarSlot*>(at(hdr->Table));
+
+    return s;
+}
+
+utils::Expected<SidecarIndex, Err>
+SidecarIndex::OpenOrBuild(
+    const Archive& A,
+    const char* Path
+)
+{
+    {
+        auto s = Open(Path);
+        if (s.HasValue() && s.Value().Matches(A))
+        {
+            return s;
+        }
+    }
+
+    if (Err e = Write(A, Path); e != Err::None)
+    {
+        return utils::UnExpected{ e };
+    }
+
+    return Open(Path);
+}
+
+std::string
+SidecarIndex::PathFor(
+    std::string_view ArchivePath,
+    const char* CacheDir
+)
+{
+    if (CacheDir == nullptr)
+    {
+        return std::string(ArchivePath) + ".zidx";
+    }
+
+    //
+    // archives of the same name in different directories get their own file
+    //
+    const size_t slash = ArchivePath.find_last_of('/');
+    const std::string_view base = slash == std::string_view::npos ? ArchivePath : ArchivePath.substr(slash + 1u);
+
+    char hash[17];
+    std::snprintf(hash, sizeof(hash), "%016llx", (unsigned long long)NameIndex::Hash(ArchivePath));
+
+    return std::string(CacheDir) + "/" + std::string(base) + "-" + hash + ".zidx";
+}
+
+std::string_view
+SidecarIndex::Name(
+    size_t I
+) const
+{
+    //
+    // the offsets come from the file - an inconsistent pair reads as an
+    // empty name rather than out of the mapping
+    //
+    const uint32_t b = m_NameOffset[I];
+    const uint32_t e = m_NameOffset[I + 1u];
+    if (b > e || e > m_Hdr->NamesBytes)
+    {
+        return {};
+    }
+
+    return { m_Names + b, size_t(e - b) };
+}
+
+std::optional<NameIndex::Hit>
+SidecarIndex::Find(
+    std::string_view Name
+) const
+{
+    if (m_Hdr == nullptr)
+    {
+        return std::nullopt;
+    }
+
+    const uint64_t h   = NameIndex::Hash(Name);
+    const uint32_t tag = uint32_t(h >> 32);
+    const size_t mask  = size_t(m_Hdr->Slots - 1u);
+
+    for (size_t i = h & mask, probes = 0; probes <= mask; i = (i + 1u) & mask, ++probes)
+    {
+        const Impl::SidecarSlot& s = m_Table[i];
+        if (s.Entry >= m_Hdr->Entries)
+        {
+            return std::nullopt;
+        }
+
+        if (s.Tag == tag && this->Name(s.Entry) == Name)
+        {
+            return NameIndex::Hit{ m_CdOffset[s.Entry], m_CDir[s.Entry] };
+        }
+    }
+
+    return std::nullopt;
+}
+
+}
@@ -0,0 +1,272 @@
+#pragma once
+
+#include "zip/Err.hpp"
+#include "zip/NameIndex.hpp"
+#include "utils/Expected.hpp"
+#include "utils/MemoryMappedFile.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace zip
+{
+
+class Archive;
+struct CDir;
+
+namespace Impl
+{
+
+//
+// The fixed part of a sidecar file. Everything after it is addressed by
+// offsets from the start of the file, so the file can be mapped anywhere.
+//
+struct SidecarHeader
+{
+    uint32_t Magic;
+    uint32_t Version;
+    uint64_t ArchiveSz;
+    uint32_t Fingerprint; // crc32 over the end records and central directories
+    uint32_t CDirs;
+    uint64_t Entries;
+    uint64_t Slots;       // power of two, more than Entries
+    uint64_t NamesBytes;
+
+    //
+    // section offsets, each 8 byte aligned
+    //
+    uint64_t CdOffset;     // u64 x Entries
+    uint64_t LFHOffset;    // u64 x Entries
+    uint64_t CompressedSz; // u64 x Entries
+    uint64_t OriginalSz;   // u64 x Entries
+    uint64_t Crc;          // u32 x Entries
+    uint64_t Method;       // u16 x Entries
+    uint64_t CDir;         // u16 x Entries
+    uint64_t NameOffset;   // u32 x (Entries + 1), into Names
+    uint64_t Names;        // NamesBytes
+    uint64_t Table;        // SidecarSlot x Slots
+};
+
+static_assert(sizeof(SidecarHeader) == 128u);
+
+struct SidecarSlot
+{
+    uint32_t Tag;   // upper half of NameIndex::Hash()
+    uint32_t Entry; // ~0u when empty
+};
+
+//
+// For the index files (this one and GlobalIndex), which are laid out as a
+// header and sections at 8 byte aligned offsets from the start.
+//
+constexpr uint64_t
+Align8(
+    uint64_t Off
+)
+{
+    return (Off + 7u) & ~uint64_t(7u);
+}
+
+//
+// Off and Count from an untrusted header: true if Count items of ItemSz
+// bytes at Off are within FileSz and aligned for the item type.
+//
+bool
+InBounds(
+    uint64_t Off,
+    uint64_t Count,
+    uint64_t ItemSz,
+    uint64_t FileSz
+);
+
+//
+// Src at Off in Dst, which is zero padded up to Off.
+//
+void
+Append(
+    std::vector<unsigned char>& Dst,
+    uint64_t Off,
+    const void* Src,
+    size_t Bytes
+);
+
+//
+// Buf to Path, through a temporary file that is renamed over Path once
+// complete.
+//
+Err
+WriteAtomically(
+    const std::vector<unsigned char>& Buf,
+    const char* Path
+);
+
+}
+
+//
+// The central directory of an archive as a file of its own: the entry
+// columns of CDIndex, the central directory header offsets, and a name hash
+// table over them, laid out so that the file is used straight from its
+// mapping. Opening one is a mmap and a check of the header - no parsing,
+// no allocation, whatever the number of entries.
+//
+// The file records the archive size and a crc32 of its end records and
+// central directories. Matches() recomputes that fingerprint (one crc pass
+// over the central directory bytes, no decoding) and OpenOrBuild() rewrites
+// the file when it no longer agrees with the archive.
+//
+// The columns are stored in host byte order, which is little endian.
+//
+class SidecarIndex
+{
+public:
+    SidecarIndex(
+        void
+    ) = default;
+
+    //
+    // Maps Path and checks that its sections are in bounds. BadData for a
+    // file that is not a sidecar of this version, Io if it cannot be mapped.
+    //
+    static utils::Expected<SidecarIndex, Err>
+    Open(
+        const char* Path
+    );
+
+    //
+    // Writes the sidecar of A to Path, through a temporary file that is
+    // renamed over Path once complete.
+    //
+    static Err
+    Write(
+        const Archive& A,
+        const char* Path
+    );
+
+    //
+    // Open(Path) if it is the sidecar of A, otherwise Write() it first.
+    //
+    static utils::Expected<SidecarIndex, Err>
+    OpenOrBuild(
+        const Archive& A,
+        const char* Path
+    );
+
+    //
+    // "<ArchivePath>.zidx", or, given a cache directory,
+    // "<CacheDir>/<file name>-<hash of ArchivePath>.zidx"
+    //
+    static std::string
+    PathFor(
+        std::string_view ArchivePath,
+        const char* CacheDir = nullptr
+    );
+
+    bool
+    Matches(
+        const Archive& A
+    ) const;
+
+    //
+    // The first entry called Name, as a central directory header offset in
+    // the archive, like NameIndex::Find().
+    //
+    std::optional<NameIndex::Hit>
+    Find(
+        std::string_view Name
+    ) const;
+
+    size_t
+    Size(
+        void
+    ) const
+    {
+        return m_Hdr ? size_t(m_Hdr->Entries) : 0u;
+    }
+
+    std::string_view
+    Name(
+        size_t I
+    ) const;
+
+    uint64_t
+    LFHOffset(
+        size_t I
+    ) const
+    {
+        return m_LFHOffset[I];
+    }
+
+    uint64_t
+    CompressedSz(
+        size_t I
+    ) const
+    {
+        return m_CompressedSz[I];
+    }
+
+    uint64_t
+    OriginalSz(
+        size_t I
+    ) const
+    {
+        return m_OriginalSz[I];
+    }
+
+    uint32_t
+    Crc(
+        size_t I
+    ) const
+    {
+        return m_Crc[I];
+    }
+
+    uint16_t
+    Method(
+        size_t I
+    ) const
+    {
+        return m_Method[I];
+    }
+
+    const utils::MemoryMappedFile&
+    File(
+        void
+    ) const
+    {
+        return m_File;
+    }
+
+    static uint32_t
+    Fingerprint(
+        const Archive& A
+    );
+
+    //
+    // the same, for a zip that is mapped but not opened as an Archive
+    //
+    static uint32_t
+    Fingerprint(
+        utils::RdBuf_t ZipBuf,
+        const std::vector<CDir>& CDirs
+    );
+
+private:
+    utils::MemoryMappedFile m_File;
+    const Impl::SidecarHeader* m_Hdr = nullptr;
+    const uint64_t* m_CdOffset       = nullptr;
+    const uint64_t* m_LFHOffset      = nullptr;
+    const uint64_t* m_CompressedSz   = nullptr;
+    const uint64_t* m_OriginalSz     = nullptr;
+    const uint32_t* m_Crc            = nullptr;
+    const uint16_t* m_Method         = nullptr;
+    const uint16_t* m_CDir           = nullptr;
+    const uint32_t* m_NameOffset     = nullptr;
+    const char* m_Names              = nullptr;
+    const Impl::SidecarSlot* m_Table = nullptr;
+};
+
+}
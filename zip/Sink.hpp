@@ -0,0 +1,96 @@
+#pragma once
+
+#include "utils/Crc32.hpp"
+#include "utils/RdBuf.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace zip
+{
+
+//
+// A sink is anything callable with a `utils::RdBuf_t` chunk of output. The
+// chunk is only valid for the duration of the call, so a sink that wants to
+// keep the bytes around has to copy them.
+//
+template<class SinkT>
+constexpr bool IsSink_v = std::is_invocable_v<SinkT&, utils::RdBuf_t>;
+
+//
+// Non-owning, type-erased reference to a sink. This lets the decoders live
+// in translation units, while still costing only one indirect call per chunk
+// (and no allocation, unlike std::function).
+//
+class SinkRef
+{
+public:
+    template<
+        class SinkT,
+        class = std::enable_if_t<!std::is_same_v<std::decay_t<SinkT>, SinkRef> && IsSink_v<SinkT>>>
+    SinkRef(
+        SinkT&& Sink
+    ) noexcept
+      : m_Obj(const_cast<void*>(static_cast<const void*>(std::addressof(Sink))))
+      , m_Fn(
+            [](void* Obj, utils::RdBuf_t Chunk)
+            {
+                (*static_cast<std::remove_reference_t<SinkT>*>(Obj))(Chunk);
+            }
+        )
+    {
+    }
+
+    void
+    operator()(
+        utils::RdBuf_t Chunk
+    ) const
+    {
+        m_Fn(m_Obj, Chunk);
+    }
+
+private:
+    void* m_Obj = nullptr;
+    void (*m_Fn)(void*, utils::RdBuf_t) = nullptr;
+};
+
+//
+// Checksums every chunk on its way through to the wrapped sink, while the
+// chunk is still hot in cache - so verifying an entry costs no extra pass
+// over its output.
+//
+template<class SinkT>
+class CrcSink
+{
+public:
+    explicit CrcSink(
+        SinkT& Sink
+    )
+      : m_Sink(Sink)
+    {
+    }
+
+    void
+    operator()(
+        utils::RdBuf_t Chunk
+    )
+    {
+        m_Crc = utils::Crc32(m_Crc, Chunk);
+        m_Sink(Chunk);
+    }
+
+    uint32_t
+    Crc(
+        void
+    ) const
+    {
+        return m_Crc;
+    }
+
+private:
+    SinkT& m_Sink;
+    uint32_t m_Crc = 0u;
+};
+
+}
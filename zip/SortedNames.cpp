@@ -0,0 +1,202 @@
+#include "zip/SortedNames.hpp"
+
+#include <numeric>
+
+namespace zip::Impl
+{
+
+//
+// Glob[I] is a '[': the index past the matching ']', or npos when there is
+// none. A ']' right after the '[' (or the negation) is a member of the set.
+//
+size_t
+ClassEnd(
+    std::string_view Glob,
+    size_t I
+)
+{
+    size_t k = I + 1u;
+    if (k < Glob.size() && (Glob[k] == '!' || Glob[k] == '^'))
+    {
+        ++k;
+    }
+
+    if (k < Glob.size() && Glob[k] == ']')
+    {
+        ++k;
+    }
+
+    const size_t end = Glob.find(']', k);
+    return end == std::string_view::npos ? end : end + 1u;
+}
+
+//
+// Set is what is between '[' and ']'
+//
+bool
+InClass(
+    std::string_view Set,
+    unsigned char C
+)
+{
+    bool negate = false;
+    if (!Set.empty() && (Set[0] == '!' || Set[0] == '^'))
+    {
+        negate = true;
+        Set.remove_prefix(1u);
+    }
+
+    bool in = false;
+    for (size_t i = 0; i < Set.size() && !in; ++i)
+    {
+        const unsigned char lo = Set[i];
+        if (i + 2u < Set.size() && Set[i + 1u] == '-')
+        {
+            const unsigned char hi = Set[i + 2u];
+            in = lo <= C && C <= hi;
+            i += 2u;
+        }
+        else
+        {
+            in = lo == C;
+        }
+    }
+
+    return in != negate;
+}
+
+}
+
+namespace zip
+{
+
+SortedNames::SortedNames(
+    const Archive& A
+)
+{
+    for (size_t k = 0; k < A.CDirs().size(); ++k)
+    {
+        ForEachCDFHeader(
+            A.CDirs()[k],
+            A.Buffer(),
+            [this, k](const CDFHeader& Cdfh, uint64_t CdOffset)
+            {
+                m_Names.push_back(Cdfh.name);
+                m_CdOffset.push_back(CdOffset);
+                m_CDir.push_back(uint16_t(k));
+                return true;
+            }
+        );
+    }
+
+    m_Order.resize(m_Names.size());
+    std::iota(m_Order.begin(), m_Order.end(), 0u);
+    std::stable_sort(
+        m_Order.begin(),
+        m_Order.end(),
+        [this](uint32_t L, uint32_t R)
+        {
+            return utils::AsPlainStringView(m_Names[L]) < utils::AsPlainStringView(m_Names[R]);
+        }
+    );
+}
+
+std::pair<size_t, size_t>
+SortedNames::PrefixRange(
+    std::string_view Prefix,
+    size_t First,
+    size_t Last
+) const
+{
+    //
+    // the names that start with Prefix follow right after those that are
+    // less than it
+    //
+    auto begin = m_Order.begin() + First;
+    auto end   = m_Order.begin() + Last;
+
+    auto lo = std::partition_point(
+        begin,
+        end,
+        [this, Prefix](uint32_t E)
+        {
+            return utils::AsPlainStringView(m_Names[E]) < Prefix;
+        }
+    );
+
+    auto hi = std::partition_point(
+        lo,
+        end,
+        [this, Prefix](uint32_t E)
+        {
+            return utils::AsPlainStringView(m_Names[E]).substr(0u, Prefix.size()) == Prefix;
+        }
+    );
+
+    return { size_t(lo - m_Order.begin()), size_t(hi - m_Order.begin()) };
+}
+
+bool
+SortedNames::Match(
+    std::string_view Glob,
+    std::string_view Name
+)
+{
+    //
+    // Iterative, with backtracking to the last '*' only: a later '*' can
+    // match anything an earlier one could, so that is enough, and the cost
+    // stays O(|Glob| * |Name|) at worst.
+    //
+    size_t g     = 0;
+    size_t n     = 0;
+    size_t starG = std::string_view::npos;
+    size_t starN = 0;
+
+    while (n < Name.size())
+    {
+        if (g < Glob.size())
+        {
+            const char c = Glob[g];
+            if (c == '*')
+            {
+                starG = ++g;
+                starN = n;
+                continue;
+            }
+
+            const size_t classEnd = c == '[' ? Impl::ClassEnd(Glob, g) : std::string_view::npos;
+            if (classEnd != std::string_view::npos)
+            {
+                if (Impl::InClass(Glob.substr(g + 1u, classEnd - g - 2u), Name[n]))
+                {
+                    g = classEnd;
+                    ++n;
+                    continue;
+                }
+            }
+            else if (c == '?' || c == Name[n])
+            {
+                ++g;
+                ++n;
+                continue;
+            }
+        }
+
+        if (starG == std::string_view::npos)
+        {
+            return false;
+        }
+
+        g = starG;
+        n = ++starN;
+    }
+
+    while (g < Glob.size() && Glob[g] == '*')
+    {
+        ++g;
+    }
+
+    return g == Glob.size();
+}
+
+}
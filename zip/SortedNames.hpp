@@ -0,0 +1,216 @@
+#pragma once
+
+#include "zip/Archive.hpp"
+#include "zip/NameIndex.hpp"
+#include "utils/AsPlainStringView.hpp"
+#include "utils/RdBuf.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace zip
+{
+
+//
+// The entry names of an archive in lexicographic (byte) order, as a sorted
+// permutation over the central directory: a rank is a position in that
+// order, Entry(rank) the number of the entry in central directory order
+// (the numbering of CDIndex). Names are the RdBuf_t spans of the mapping,
+// nothing is copied.
+//
+// All entries that start with some prefix form one run of ranks, which is
+// what the queries are built on: a prefix is two binary searches, a
+// directory listing jumps over each subdirectory with one more, and a glob
+// only tests the entries that share its literal prefix.
+//
+class SortedNames
+{
+public:
+    SortedNames(
+        void
+    ) = default;
+
+    explicit SortedNames(
+        const Archive& A
+    );
+
+    size_t
+    Size(
+        void
+    ) const
+    {
+        return m_Order.size();
+    }
+
+    std::string_view
+    Name(
+        size_t Rank
+    ) const
+    {
+        return utils::AsPlainStringView(m_Names[m_Order[Rank]]);
+    }
+
+    size_t
+    Entry(
+        size_t Rank
+    ) const
+    {
+        return m_Order[Rank];
+    }
+
+    //
+    // for Archive::At()
+    //
+    NameIndex::Hit
+    Hit(
+        size_t Rank
+    ) const
+    {
+        return { m_CdOffset[m_Order[Rank]], m_CDir[m_Order[Rank]] };
+    }
+
+    //
+    // the ranks [first, last) of the names that start with Prefix
+    //
+    std::pair<size_t, size_t>
+    PrefixRange(
+        std::string_view Prefix
+    ) const
+    {
+        return PrefixRange(Prefix, 0u, Size());
+    }
+
+    //
+    // Calls Func(child, isDir) for what is directly in directory Dir ("" for
+    // the top level, the trailing '/' is optional), in order: files by their
+    // name, subdirectories once each, with a trailing '/', whether or not
+    // the archive has an entry for them. Stops early (and returns false)
+    // when Func does.
+    //
+    template<class FuncT>
+    bool
+    ForEachInDir(
+        std::string_view Dir,
+        FuncT Func
+    ) const
+    {
+        std::string prefix{ Dir };
+        if (!prefix.empty() && prefix.back() != '/')
+        {
+            prefix += '/';
+        }
+
+        auto [rank, last] = PrefixRange(prefix);
+        while (rank < last)
+        {
+            const std::string_view name = Name(rank);
+            const std::string_view rest = name.substr(prefix.size());
+            const size_t slash          = rest.find('/');
+
+            if (rest.empty())
+            {
+                ++rank; // the entry of Dir itself
+            }
+            else if (slash == std::string_view::npos)
+            {
+                if (!Func(rest, false))
+                {
+                    return false;
+                }
+                ++rank;
+            }
+            else
+            {
+                if (!Func(rest.substr(0u, slash + 1u), true))
+                {
+                    return false;
+                }
+                rank = PrefixRange(name.substr(0u, prefix.size() + slash + 1u), rank, last).second;
+            }
+        }
+
+        return true;
+    }
+
+    //
+    // Calls Func(name, hit) in name order for the names matching Glob, see
+    // Match(). Only the run of names that share the literal start of Glob
+    // is tested. Stops early (and returns false) when Func does.
+    //
+    template<class FuncT>
+    bool
+    ForEachMatch(
+        std::string_view Glob,
+        FuncT Func
+    ) const
+    {
+        const std::string_view literal = Glob.substr(0u, std::min(Glob.find_first_of("*?["), Glob.size()));
+        const bool exact               = literal.size() == Glob.size();
+
+        auto [first, last] = PrefixRange(literal);
+        for (size_t rank = first; rank < last; ++rank)
+        {
+            const std::string_view name = Name(rank);
+            if (exact ? name.size() == literal.size() : Match(Glob, name))
+            {
+                if (!Func(name, Hit(rank)))
+                {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    //
+    // Shell style wildcards over the whole name: '*' for any run of
+    // characters ('/' included), '?' for any one, "[a-z0-9_]" for one of a
+    // set and "[!...]" (or "[^...]") for one not in it. There is no escape
+    // character; a '[' without its ']' is an ordinary character.
+    //
+    static bool
+    Match(
+        std::string_view Glob,
+        std::string_view Name
+    );
+
+    size_t
+    Bytes(
+        void
+    ) const
+    {
+        return m_Names.capacity() * sizeof(utils::RdBuf_t)
+             + m_CdOffset.capacity() * sizeof(uint64_t)
+             + m_CDir.capacity() * sizeof(uint16_t)
+             + m_Order.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    //
+    // PrefixRange() within the ranks [First, Last), which hold every name
+    // that starts with Prefix
+    //
+    std::pair<size_t, size_t>
+    PrefixRange(
+        std::string_view Prefix,
+        size_t First,
+        size_t Last
+    ) const;
+
+    //
+    // central directory order
+    //
+    std::vector<utils::RdBuf_t> m_Names;
+    std::vector<uint64_t> m_CdOffset;
+    std::vector<uint16_t> m_CDir;
+
+    std::vector<uint32_t> m_Order; // by name, ties in central directory order
+};
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "zip/Sink.hpp"
+#include "utils/RdBuf.hpp"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace zip
+{
+
+constexpr size_t STORED_SLICE = 256u * 1024u;
+
+//
+// Counterpart of zip::Inflate for stored (method 0) entries: the data is
+// already in its final form, so the mapped range is handed to Sink without
+// copying. It goes out in slices of STORED_SLICE bytes, so that a sink doing
+// more than one thing per chunk (e.g. CrcSink) finds each slice in cache.
+//
+template<class SinkT>
+int
+Stored(
+    utils::RdBuf_t Buf,
+    SinkT&& Sink
+)
+{
+    static_assert(IsSink_v<SinkT>, "Sink requires to be callable with utils::RdBuf_t");
+
+    while (!Buf.empty())
+    {
+        utils::RdBuf_t slice = Buf.first(std::min(Buf.size(), STORED_SLICE));
+        Sink(slice);
+        Buf = Buf.subspan(slice.size());
+    }
+
+    return 0;
+}
+
+}
@@ -0,0 +1,628 @@
+#include "zip/StreamReader.hpp"
+#include "zip/Archive.hpp"
+#include "zip/Codec.hpp"
+#include "zip/DataDescriptor.hpp"
+#include "zip/InflateContext.hpp"
+#include "utils/Crc32.hpp"
+#include "utils/SigScan.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <unistd.h>
+
+namespace zip::Impl
+{
+
+template<size_t N>
+bool
+StartsWith(
+    utils::RdBuf_t Buf,
+    const std::array<unsigned char, N>& Sig
+)
+{
+    return Buf.size() >= N && std::memcmp(Buf.data(), Sig.data(), N) == 0;
+}
+
+size_t
+Le16(
+    utils::RdBuf_t Buf,
+    size_t At
+)
+{
+    return size_t(Buf[At]) | size_t(Buf[At + 1u]) << 8;
+}
+
+}
+
+namespace zip
+{
+
+StreamSource
+FdSource(
+    int Fd
+)
+{
+    return [Fd](utils::WrBuf_t Dst) -> ssize_t
+    {
+        while (true)
+        {
+            const ssize_t n = ::read(Fd, Dst.data(), Dst.size());
+            if (n >= 0 || errno != EINTR)
+            {
+                return n;
+            }
+        }
+    };
+}
+
+StreamReader::StreamReader(
+    StreamSource Source,
+    const StreamReaderConfig& Config
+)
+  : m_Source(std::move(Source))
+  , m_Buf(std::max(Config.BufferSize, CDFHeader::MaxBytes()))
+  , m_Out(64u * 1024u)
+{
+}
+
+bool
+StreamReader::Fill(
+    size_t Need
+)
+{
+    if (Need > m_Buf.size())
+    {
+        return false;
+    }
+
+    while (m_End - m_Pos < Need && !m_Eof)
+    {
+        if (m_Buf.size() - m_Pos < Need || m_End == m_Buf.size())
+        {
+            std::memmove(m_Buf.data(), m_Buf.data() + m_Pos, m_End - m_Pos);
+            m_End -= m_Pos;
+            m_Pos = 0u;
+        }
+
+        const ssize_t n = m_Source({ m_Buf.data() + m_End, m_Buf.size() - m_End });
+        if (n <= 0)
+        {
+            m_Eof = true;
+            m_Err = n < 0 ? Err::Io : m_Err;
+            break;
+        }
+
+        m_End += size_t(n);
+    }
+
+    return m_End - m_Pos >= Need;
+}
+
+void
+StreamReader::Consume(
+    size_t N
+)
+{
+    m_Pos += N;
+    m_Consumed += N;
+}
+
+bool
+StreamReader::FillRecord(
+    size_t FixedSz,
+    std::initializer_list<size_t> LenAt
+)
+{
+    if (!Fill(FixedSz))
+    {
+        return false;
+    }
+
+    size_t sz = FixedSz;
+    for (size_t at : LenAt)
+    {
+        sz += Impl::Le16(Window(), at);
+    }
+
+    return Fill(sz);
+}
+
+bool
+StreamReader::Skip(
+    uint64_t N
+)
+{
+    while (N > 0u)
+    {
+        if (m_Pos == m_End && !Fill(1u))
+        {
+            return false;
+        }
+
+        const size_t n = std::min<uint64_t>(N, m_End - m_Pos);
+        Consume(n);
+        N -= n;
+    }
+
+    return true;
+}
+
+Err
+StreamReader::Fail(
+    Err E
+)
+{
+    //
+    // a read error is what caused whatever comes after it
+    //
+    if (m_Err == Err::None)
+    {
+        m_Err = E;
+    }
+
+    m_State = State::Done;
+    return m_Err;
+}
+
+bool
+StreamReader::Next(
+    void
+)
+{
+    if (m_State == State::Data)
+    {
+        Data([](utils::RdBuf_t) {});
+    }
+
+    if (m_State != State::Header)
+    {
+        return false;
+    }
+
+    if (!Fill(4u))
+    {
+        Fail(Err::BadData);
+        return false;
+    }
+
+    //
+    // the marker a split archive starts with, also found in front of some
+    // streamed ones
+    //
+    if (m_Consumed == 0u && Impl::StartsWith(Window(), DataDescriptor::SIG))
+    {
+        Consume(DataDescriptor::SIG.size());
+        return Next();
+    }
+
+    if (Impl::StartsWith(Window(), CDFHeader::SIG)
+        || Impl::StartsWith(Window(), EOCD64Rec::SIG)
+        || Impl::StartsWith(Window(), EOCDRec::SIG))
+    {
+        m_State = State::CDir;
+        return false;
+    }
+
+    if (!Impl::StartsWith(Window(), LFHeader::SIG) || !FillRecord(LFHeader::MinBytes(), { 26u, 28u }))
+    {
+        Fail(Err::BadData);
+        return false;
+    }
+
+    auto [lfh, dataBuf] = LFHeader::read(Window());
+    if (!lfh || !Validate(*lfh, std::numeric_limits<size_t>::max()))
+    {
+        Fail(Err::BadData);
+        return false;
+    }
+
+    m_Entry = {
+        std::string(utils::AsPlainStringView(lfh->name)),
+        m_Consumed,
+        lfh->flags,
+        lfh->compression,
+        lfh->crc32,
+        lfh->compressedSz,
+        lfh->originalSz,
+    };
+    m_Zip64 = DataDescriptor::IsZip64(*lfh);
+
+    Consume(size_t(dataBuf.data() - Window().data()));
+    m_State = State::Data;
+    return true;
+}
+
+Err
+StreamReader::Inflate(
+    SinkRef Sink,
+    uint64_t Limit,
+    uint32_t& Crc,
+    uint64_t& Consumed,
+    uint64_t& Produced
+)
+{
+    auto ctx = InflateContextPool::ThreadLocal().Acquire();
+    if (ctx->Begin() != Err::None)
+    {
+        return Err::BadInit;
+    }
+
+    bool end = false;
+    while (!end)
+    {
+        if (m_Pos == m_End && !Fill(1u))
+        {
+            return Err::BadData;
+        }
+
+        utils::RdBuf_t src = Window().first(std::min<uint64_t>(m_End - m_Pos, Limit - Consumed));
+        if (src.empty())
+        {
+            return Err::BadData;
+        }
+
+        const size_t before = src.size();
+        size_t produced     = 0u;
+        if (ctx->Step(src, { m_Out.data(), m_Out.size() }, produced, end) != Err::None)
+        {
+            return Err::BadData;
+        }
+
+        Consume(before - src.size());
+        Consumed += before - src.size();
+
+        if (produced > 0u)
+        {
+            utils::RdBuf_t out{ m_Out.data(), produced };
+            Crc = utils::Crc32(Crc, out);
+            Sink(out);
+            Produced += produced;
+        }
+    }
+
+    return Err::None;
+}
+
+Err
+StreamReader::CopyStored(
+    SinkRef Sink,
+    uint64_t Sz,
+    uint32_t& Crc
+)
+{
+    while (Sz > 0u)
+    {
+        if (m_Pos == m_End && !Fill(1u))
+        {
+            return Err::BadData;
+        }
+
+        const utils::RdBuf_t chunk = Window().first(std::min<uint64_t>(Sz, m_End - m_Pos));
+        Crc = utils::Crc32(Crc, chunk);
+        Sink(chunk);
+
+        Consume(chunk.size());
+        Sz -= chunk.size();
+    }
+
+    return Err::None;
+}
+
+Err
+StreamReader::CopyUntilDescriptor(
+    SinkRef Sink,
+    uint32_t& Crc,
+    uint64_t& Produced
+)
+{
+    const size_t descSz = DataDescriptor::SIG.size() + (m_Zip64 ? DataDescriptor::Format64::MinBytes() : DataDescriptor::Format::MinBytes());
+
+    auto emit = [&](size_t N)
+    {
+        const utils::RdBuf_t chunk = Window().first(N);
+        Crc = utils::Crc32(Crc, chunk);
+        Sink(chunk);
+
+        Consume(N);
+        Produced += N;
+    };
+
+    while (true)
+    {
+        Fill(descSz);
+
+        const utils::RdBuf_t w = Window();
+        if (w.size() < DataDescriptor::SIG.size())
+        {
+            return Err::BadData;
+        }
+
+        const size_t at = utils::FindSig(w, DataDescriptor::SIG);
+        if (at == w.size())
+        {
+            //
+            // all but the last bytes, which may be the start of a signature
+            //
+            emit(w.size() - (DataDescriptor::SIG.size() - 1u));
+            continue;
+        }
+
+        emit(at);
+        if (!Fill(descSz))
+        {
+            return Err::BadData;
+        }
+
+        //
+        // the data ends at the first descriptor that agrees with it, which
+        // is left for ReadDescriptor()
+        //
+        auto [dd, rem] = DataDescriptor::read(Window(), m_Zip64);
+        if (dd && dd->compressedSz == Produced && dd->originalSz == Produced && dd->crc32 == Crc)
+        {
+            return Err::None;
+        }
+
+        emit(1u);
+    }
+}
+
+std::optional<DataDescriptor>
+StreamReader::ReadDescriptor(
+    void
+)
+{
+    Fill(DataDescriptor::SIG.size() + DataDescriptor::Format64::MinBytes());
+
+    auto [dd, rem] = DataDescriptor::read(Window(), m_Zip64);
+    if (dd)
+    {
+        Consume(size_t(rem.data() - Window().data()));
+    }
+
+    return dd;
+}
+
+Err
+StreamReader::Data(
+    SinkRef Sink
+)
+{
+    if (m_State != State::Data)
+    {
+        return m_Err != Err::None ? m_Err : Err::BadData;
+    }
+
+    const bool deferred = (m_Entry.flags & DataDescriptor::FLAG) != 0u;
+    const uint64_t size = deferred ? std::numeric_limits<uint64_t>::max() : m_Entry.compressedSz;
+
+    uint32_t crc      = 0u;
+    uint64_t consumed = 0u;
+    uint64_t produced = 0u;
+    Err err           = Err::None;
+
+    const Codec* codec = m_Entry.compression == 0u || m_Entry.compression == 8u
+        ? nullptr
+        : CodecRegistry::Default().Find(m_Entry.compression);
+
+    if (m_Entry.compression == 8u)
+    {
+        err = Inflate(Sink, size, crc, consumed, produced);
+        if (err != Err::None)
+        {
+            //
+            // without a size, there is no telling where the next entry is
+            //
+            if (deferred || !Skip(size - consumed))
+            {
+                return Fail(err);
+            }
+
+            consumed = size;
+        }
+        else if (!deferred && consumed < size)
+        {
+            //
+            // the stream ended early: on to where the header says the next
+            // entry is, consumed stays short for the size check below
+            //
+            if (!Skip(size - consumed))
+            {
+                return Fail(Err::BadData);
+            }
+        }
+    }
+    else if (m_Entry.compression == 0u && !deferred)
+    {
+        err = CopyStored(Sink, size, crc);
+        if (err != Err::None)
+        {
+            return Fail(err);
+        }
+
+        consumed = produced = size;
+    }
+    else if (m_Entry.compression == 0u)
+    {
+        err = CopyUntilDescriptor(Sink, crc, produced);
+        if (err != Err::None)
+        {
+            return Fail(err);
+        }
+
+        consumed = produced;
+    }
+    else if (!deferred && codec && size <= m_Buf.size() && Fill(size))
+    {
+        //
+        // the whole entry is in the buffer: any codec will do
+        //
+        const utils::RdBuf_t src = Window().first(size);
+
+        auto crcSink = [&](utils::RdBuf_t Chunk)
+        {
+            crc = utils::Crc32(crc, Chunk);
+            Sink(Chunk);
+            produced += Chunk.size();
+        };
+
+        if (Has(codec->Caps, CodecCaps::Streaming))
+        {
+            err = codec->Stream(src, crcSink);
+        }
+        else if (m_Entry.originalSz > m_Buf.size())
+        {
+            //
+            // the output would have to be held whole, and the header says
+            // how large it is: no more than the buffer
+            //
+            err = Err::Unsupported;
+        }
+        else
+        {
+            std::vector<unsigned char> data(m_Entry.originalSz);
+            err = codec->Decode(src, { data.data(), data.size() }, nullptr);
+            if (err == Err::None)
+            {
+                crcSink(data);
+            }
+        }
+
+        Consume(size);
+        consumed = size;
+    }
+    else if (!deferred)
+    {
+        if (!Skip(size))
+        {
+            return Fail(Err::BadData);
+        }
+
+        err      = Err::Unsupported;
+        consumed = size;
+    }
+    else
+    {
+        return Fail(Err::Unsupported);
+    }
+
+    if (deferred)
+    {
+        auto dd = ReadDescriptor();
+        if (!dd)
+        {
+            return Fail(Err::BadData);
+        }
+
+        m_Entry.crc32        = dd->crc32;
+        m_Entry.compressedSz = dd->compressedSz;
+        m_Entry.originalSz   = dd->originalSz;
+    }
+
+    if (err == Err::None && (consumed != m_Entry.compressedSz || produced != m_Entry.originalSz))
+    {
+        err = Err::SizeMismatch;
+    }
+
+    if (err == Err::None && crc != m_Entry.crc32)
+    {
+        err = Err::BadCrc;
+    }
+
+    m_Seen.push_back({ m_Entry.lfhOffset, m_Entry.compressedSz, m_Entry.originalSz, m_Entry.crc32 });
+    m_State = State::Header;
+    return err;
+}
+
+Err
+StreamReader::Finish(
+    void
+)
+{
+    while (Next())
+    {
+    }
+
+    if (m_State != State::CDir)
+    {
+        return m_Err != Err::None ? m_Err : Err::BadData;
+    }
+
+    m_State = State::Done;
+
+    //
+    // one header per entry seen, in the same order and agreeing with it
+    //
+    const uint64_t cdOffset = m_Consumed;
+
+    size_t n = 0u;
+    while (Fill(4u) && Impl::StartsWith(Window(), CDFHeader::SIG))
+    {
+        if (!FillRecord(CDFHeader::MinBytes(), { 28u, 30u, 32u }))
+        {
+            return Fail(Err::BadData);
+        }
+
+        auto [cdfh, rem] = CDFHeader::read(Window());
+        if (!cdfh || n >= m_Seen.size())
+        {
+            return Fail(Err::BadData);
+        }
+
+        const Seen& s = m_Seen[n];
+        if (cdfh->offsetOfLFHeader != s.lfhOffset
+            || cdfh->compressedSz != s.compressedSz
+            || cdfh->originalSz != s.originalSz
+            || cdfh->crc32 != s.crc32)
+        {
+            return Fail(Err::BadData);
+        }
+
+        Consume(size_t(rem.data() - Window().data()));
+        n += 1u;
+    }
+
+    const uint64_t cdSize = m_Consumed - cdOffset;
+
+    std::optional<EOCD64Rec> eocd64;
+    if (Fill(4u) && Impl::StartsWith(Window(), EOCD64Rec::SIG))
+    {
+        eocd64 = Fill(EOCD64Rec::MinBytes()) ? EOCD64Rec::read(Window()) : std::nullopt;
+        if (!eocd64 || !Skip(12u + eocd64->sizeOfRecord))
+        {
+            return Fail(Err::BadData);
+        }
+
+        if (Fill(4u) && Impl::StartsWith(Window(), EOCD64Locator::SIG) && !Skip(EOCD64Locator::MinBytes()))
+        {
+            return Fail(Err::BadData);
+        }
+    }
+
+    std::optional<EOCDRec> eocd;
+    if (Fill(4u) && Impl::StartsWith(Window(), EOCDRec::SIG) && FillRecord(EOCDRec::MinBytes(), { 20u }))
+    {
+        eocd = EOCDRec::read(Window());
+    }
+
+    if (!eocd)
+    {
+        return Fail(Err::BadData);
+    }
+
+    const uint64_t entries = eocd64 ? eocd64->totalEntries : eocd->totalEntries;
+    const uint64_t offset  = eocd64 ? eocd64->offsetOfCentralDir : eocd->offsetOfCentralDir;
+    const uint64_t size    = eocd64 ? eocd64->sizeOfCentralDir : eocd->sizeOfCentralDir;
+
+    if (n != m_Seen.size() || entries != n || offset != cdOffset || size != cdSize)
+    {
+        return Fail(Err::BadData);
+    }
+
+    return m_Err;
+}
+
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "zip/DataDescriptor.hpp"
+#include "zip/Err.hpp"
+#include "zip/Sink.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/WrBuf.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+namespace zip
+{
+
+//
+// Where a StreamReader gets its bytes: fills the front of Dst with what is
+// available (blocking until there is at least one byte), and returns how
+// many that was - 0 at the end of the input, -1 on an error.
+//
+using StreamSource = std::function<ssize_t(utils::WrBuf_t Dst)>;
+
+//
+// ::read() on Fd, e.g. 0 for stdin.
+//
+StreamSource
+FdSource(
+    int Fd
+);
+
+struct StreamReaderConfig
+{
+    //
+    // the input buffer, the only memory the reader holds besides the inflate
+    // state and a few words per entry - raised to what the largest possible
+    // header needs
+    //
+    size_t BufferSize = 256u * 1024u;
+};
+
+//
+// An entry as its local header has it, and once its data is read, with the
+// sizes and crc from its data descriptor if it has one.
+//
+struct StreamedEntry
+{
+    std::string name;
+    uint64_t lfhOffset    = 0u;
+    uint16_t flags        = 0u;
+    uint16_t compression  = 0u;
+    uint32_t crc32        = 0u;
+    uint64_t compressedSz = 0u;
+    uint64_t originalSz   = 0u;
+};
+
+//
+// A zip read front to back, from a source that cannot seek (a pipe, stdin):
+// local header after local header, each entry decoded as its data comes in,
+// through a fixed buffer - so that extraction overlaps with the download.
+//
+//     zip::StreamReader reader{ zip::FdSource(0) };
+//     while (reader.Next())
+//     {
+//         reader.Data(sink);
+//     }
+//     zip::Err err = reader.Finish();
+//
+// Where an entry ends is not known up front when its local header defers
+// the sizes to a data descriptor (general purpose flag bit 3). A deflated
+// entry ends with its deflate stream; a stored one at the first descriptor
+// signature that is followed by the size and crc of the bytes before it.
+// Other methods are decoded with the default codec registry, when their
+// size is known and the entry fits in the buffer - and for a codec that
+// cannot stream, its output as well.
+//
+// The central directory comes last, and Finish() checks it against the
+// entries seen.
+//
+class StreamReader
+{
+public:
+    explicit StreamReader(
+        StreamSource Source,
+        const StreamReaderConfig& Config = {}
+    );
+
+    //
+    // Moves on to the next entry, skipping what is left of the data of the
+    // current one. False at the end of the entries (the central directory),
+    // or on an error that leaves the rest of the input unreadable, see
+    // Error().
+    //
+    bool
+    Next(
+        void
+    );
+
+    const StreamedEntry&
+    Entry(
+        void
+    ) const
+    {
+        return m_Entry;
+    }
+
+    //
+    // Decodes the data of the current entry into Sink, and checks it
+    // against its sizes and crc. Afterwards Entry() has them all, the ones
+    // from the data descriptor included.
+    //
+    Err
+    Data(
+        SinkRef Sink
+    );
+
+    //
+    // Once Next() is false: reads the central directory and the end
+    // records, and checks them against the entries that were seen.
+    //
+    Err
+    Finish(
+        void
+    );
+
+    //
+    // the error that ended the entries early, if any
+    //
+    Err
+    Error(
+        void
+    ) const
+    {
+        return m_Err;
+    }
+
+private:
+    enum class State
+    {
+        Header,  // before a local header
+        Data,    // before the data of m_Entry
+        CDir,    // at the central directory
+        Done,    // Finish() was called, or a fatal error
+    };
+
+    //
+    // what Finish() checks the central directory against
+    //
+    struct Seen
+    {
+        uint64_t lfhOffset;
+        uint64_t compressedSz;
+        uint64_t originalSz;
+        uint32_t crc32;
+    };
+
+    utils::RdBuf_t
+    Window(
+        void
+    ) const
+    {
+        return { m_Buf.data() + m_Pos, m_End - m_Pos };
+    }
+
+    //
+    // reads until at least Need bytes are in the window, false at the end
+    // of the input
+    //
+    bool
+    Fill(
+        size_t Need
+    );
+
+    void
+    Consume(
+        size_t N
+    );
+
+    //
+    // Need bytes of a record whose variable part has the 16 bit lengths at
+    // LenAt in its fixed part of FixedSz bytes, false if the input ends
+    // before the whole record is in the window
+    //
+    bool
+    FillRecord(
+        size_t FixedSz,
+        std::initializer_list<size_t> LenAt
+    );
+
+    //
+    // drops the next N bytes of the input, false if it ends before that
+    //
+    bool
+    Skip(
+        uint64_t N
+    );
+
+    //
+    // the deflate stream at the window, reading no more than Limit bytes
+    //
+    Err
+    Inflate(
+        SinkRef Sink,
+        uint64_t Limit,
+        uint32_t& Crc,
+        uint64_t& Consumed,
+        uint64_t& Produced
+    );
+
+    Err
+    CopyStored(
+        SinkRef Sink,
+        uint64_t Sz,
+        uint32_t& Crc
+    );
+
+    //
+    // stored data of unknown size, up to the descriptor that agrees with it
+    //
+    Err
+    CopyUntilDescriptor(
+        SinkRef Sink,
+        uint32_t& Crc,
+        uint64_t& Produced
+    );
+
+    std::optional<DataDescriptor>
+    ReadDescriptor(
+        void
+    );
+
+    Err
+    Fail(
+        Err E
+    );
+
+    StreamSource m_Source;
+    std::vector<unsigned char> m_Buf;
+    std::vector<unsigned char> m_Out;
+    size_t m_Pos        = 0u;
+    size_t m_End        = 0u;
+    uint64_t m_Consumed = 0u; // stream offset of the window
+    bool m_Eof          = false;
+    bool m_Zip64        = false; // the current entry has a zip64 extra field
+    State m_State       = State::Header;
+    Err m_Err           = Err::None;
+    StreamedEntry m_Entry;
+    std::vector<Seen> m_Seen;
+};
+
+}
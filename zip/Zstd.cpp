@@ -0,0 +1,218 @@
+#include "zip/Zstd.hpp"
+#include "utils/Crc32.hpp"
+#include "utils/ScopeExit.hpp"
+
+#include "zip/thirdparty/zstd/zstd.h"
+#include "zip/thirdparty/zstd/zstd_errors.h"
+
+#include <memory>
+#include <vector>
+
+namespace zip::Impl
+{
+
+//
+// A decoding context and the output buffer for streaming. Both are sizeable
+// (the context alone is ~160 KB), so they are kept on a per-thread free list
+// like the InflateContext's - a list rather than a single one, since a sink
+// may well decode another entry from within its callback.
+//
+struct ZstdContext
+{
+    struct Deleter
+    {
+        void
+        operator()(
+            ZSTD_DCtx* Ctx
+        ) const
+        {
+            ZSTD_freeDCtx(Ctx);
+        }
+    };
+
+    std::unique_ptr<ZSTD_DCtx, Deleter> DCtx{ ZSTD_createDCtx() };
+    std::vector<unsigned char> Out;
+};
+
+std::vector<std::unique_ptr<ZstdContext>>&
+ZstdFreeList(
+    void
+)
+{
+    thread_local std::vector<std::unique_ptr<ZstdContext>> list;
+    return list;
+}
+
+std::unique_ptr<ZstdContext>
+ZstdAcquire(
+    void
+)
+{
+    auto& list = ZstdFreeList();
+    if (list.empty())
+    {
+        return std::make_unique<ZstdContext>();
+    }
+
+    std::unique_ptr<ZstdContext> ctx = std::move(list.back());
+    list.pop_back();
+
+    ZSTD_DCtx_reset(ctx->DCtx.get(), ZSTD_reset_session_only);
+    return ctx;
+}
+
+void
+ZstdRelease(
+    std::unique_ptr<ZstdContext> Ctx
+)
+{
+    ZstdFreeList().push_back(std::move(Ctx));
+}
+
+}
+
+namespace zip
+{
+
+Err
+ZstdDecompress(
+    utils::RdBuf_t Buf,
+    SinkRef Sink
+)
+{
+    if (Buf.empty())
+    {
+        return Err::None;
+    }
+
+    auto ctx = Impl::ZstdAcquire();
+    if (!ctx->DCtx)
+    {
+        return Err::BadInit;
+    }
+
+    ZSTD_DCtx* dctx = ctx->DCtx.get();
+    auto& out       = ctx->Out;
+    out.resize(ZSTD_DStreamOutSize());
+
+    utils::ScopeExit release{ [&ctx]()
+                              { Impl::ZstdRelease(std::move(ctx)); } };
+
+    ZSTD_inBuffer in{ Buf.data(), Buf.size(), 0u };
+    size_t ret = 0u;
+
+    while (true)
+    {
+        ZSTD_outBuffer o{ out.data(), out.size(), 0u };
+
+        ret = ZSTD_decompressStream(dctx, &o, &in);
+        if (ZSTD_isError(ret))
+        {
+            return Err::BadData;
+        }
+
+        if (o.pos != 0u)
+        {
+            Sink({ out.data(), o.pos });
+        }
+
+        //
+        // with all the input taken and room left in the output, everything
+        // that can be decoded has been flushed
+        //
+        if (in.pos == in.size && o.pos < o.size)
+        {
+            break;
+        }
+    }
+
+    //
+    // non-zero means the last frame is incomplete
+    //
+    return ret == 0u ? Err::None : Err::BadData;
+}
+
+Err
+ZstdDecompressInto(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst,
+    uint32_t* Crc
+)
+{
+    auto ctx = Impl::ZstdAcquire();
+    if (!ctx->DCtx)
+    {
+        return Err::BadInit;
+    }
+
+    utils::ScopeExit release{ [&ctx]()
+                              { Impl::ZstdRelease(std::move(ctx)); } };
+
+    size_t ret = ZSTD_decompressDCtx(ctx->DCtx.get(), Dst.data(), Dst.size(), Src.data(), Src.size());
+    if (ZSTD_isError(ret))
+    {
+        return ZSTD_getErrorCode(ret) == ZSTD_error_dstSize_tooSmall ? Err::SizeMismatch : Err::BadData;
+    }
+
+    if (ret != Dst.size())
+    {
+        return Err::SizeMismatch;
+    }
+
+    if (Crc)
+    {
+        *Crc = utils::Crc32(0u, { Dst.data(), Dst.size() });
+    }
+
+    return Err::None;
+}
+
+utils::Expected<size_t, Err>
+ZstdDecompressHead(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst
+)
+{
+    auto ctx = Impl::ZstdAcquire();
+    if (!ctx->DCtx)
+    {
+        return utils::UnExpected{ Err::BadInit };
+    }
+
+    utils::ScopeExit release{ [&ctx]()
+                              { Impl::ZstdRelease(std::move(ctx)); } };
+
+    ZSTD_inBuffer in{ Src.data(), Src.size(), 0u };
+    ZSTD_outBuffer out{ Dst.data(), Dst.size(), 0u };
+
+    while (out.pos < out.size)
+    {
+        size_t before = in.pos + out.pos;
+
+        size_t ret = ZSTD_decompressStream(ctx->DCtx.get(), &out, &in);
+        if (ZSTD_isError(ret))
+        {
+            return utils::UnExpected{ Err::BadData };
+        }
+
+        //
+        // the last frame is over, yet Dst is not full
+        //
+        if (ret == 0u && in.pos == in.size && out.pos < out.size)
+        {
+            return utils::UnExpected{ Err::SizeMismatch };
+        }
+
+        //
+        // no progress means the frame is truncated
+        //
+        if (in.pos + out.pos == before)
+        {
+            return utils::UnExpected{ Err::BadData };
+        }
+    }
+
+    return out.pos;
+}
+
+}
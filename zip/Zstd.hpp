@@ -0,0 +1,65 @@
+#pragma once
+
+#include "zip/Err.hpp"
+#include "zip/Sink.hpp"
+#include "utils/RdBuf.hpp"
+#include "utils/WrBuf.hpp"
+#include "utils/Expected.hpp"
+
+#include <cstdint>
+#include <type_traits>
+
+namespace zip
+{
+
+//
+// Compression method 93, Zstandard - decoded with the vendored zstd in
+// zip/thirdparty/zstd. The entry data is one or more zstd frames.
+//
+constexpr uint16_t ZSTD_METHOD = 93u;
+
+//
+// Decodes the frames in Buf, handing the output to Sink in chunks as it is
+// produced. Truncated or corrupt input is reported as Err::BadData.
+//
+Err
+ZstdDecompress(
+    utils::RdBuf_t Buf,
+    SinkRef Sink
+);
+
+template<
+    class SinkT,
+    class = std::enable_if_t<!std::is_same_v<std::decay_t<SinkT>, SinkRef> && IsSink_v<SinkT>>>
+Err
+ZstdDecompress(
+    utils::RdBuf_t Buf,
+    SinkT&& Sink
+)
+{
+    return ZstdDecompress(Buf, SinkRef{ Sink });
+}
+
+//
+// Same contract as zip::InflateInto: Dst has to be exactly the decoded size.
+// The frames are decoded straight into Dst in a single pass (no window copy),
+// so unlike for deflate the Crc is taken in a second pass over Dst.
+//
+Err
+ZstdDecompressInto(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst,
+    uint32_t* Crc = nullptr
+);
+
+//
+// Decodes no more than Dst.size() bytes and stops, see zip::ExtractHead. The
+// input is consumed a block at a time, up to 128 KB.
+//
+utils::Expected<size_t, Err>
+ZstdDecompressHead(
+    utils::RdBuf_t Src,
+    utils::WrBuf_t Dst
+);
+
+}